@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+/*
+ * 代码生成基准：同一份定义（bench_codegen.fsm）分别以
+ *   table  - flux_fsm_process_event（已封存的转移表 + 函数指针回调）
+ *   switch - flux_fsm_codegen 生成的 bench_dispatch（回调直接调用并内联）
+ * 处理相同的随机事件序列，比较每事件耗时并核对两者结果一致。
+ *
+ * 用法: bench_codegen [轮数]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "flux_fsm_codegen.h"
+
+#define EVENTS  (1 << 16)
+
+typedef struct {
+    unsigned long guards;
+    unsigned long actions;
+    unsigned long handled;
+} bench_ctx_t;
+
+int bench_guard(void* ctx) {
+    bench_ctx_t* c = ctx;
+    return (++c->guards & 7) != 7;
+}
+
+void bench_action(void* ctx) {
+    ((bench_ctx_t*)ctx)->actions++;
+}
+
+void bench_handler(void* ctx, flux_fsm_event_t event) {
+    ((bench_ctx_t*)ctx)->handled += (unsigned long)event + 1;
+}
+
+#define BENCH_DISPATCH_LINKAGE static inline
+#include "bench_codegen_dispatch.c"
+
+static const flux_fsm_symbol_t bench_symbols[] = {
+    {"bench_guard", bench_guard, NULL, NULL},
+    {"bench_action", NULL, bench_action, NULL},
+    {"bench_handler", NULL, NULL, bench_handler},
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+    long rounds = argc > 1 ? atol(argv[1]) : 200;
+    static flux_fsm_event_t events[EVENTS];
+
+    srand(12345);
+    for (int i = 0; i < EVENTS; i++) {
+        /* 事件 3 回到状态 0，降低其比例以遍历整个环 */
+        int r = rand() % 16;
+        events[i] = r < 5 ? 0 : r < 10 ? 1 : r < 15 ? 2 : 3;
+    }
+
+    size_t line = 0;
+    flux_fsm_codegen_t* gen = flux_fsm_codegen_load(BENCH_CODEGEN_DEF, &line);
+    if (!gen) {
+        fprintf(stderr, "%s:%zu: cannot load definition\n", BENCH_CODEGEN_DEF, line);
+        return 1;
+    }
+
+    bench_ctx_t table_ctx = {0, 0, 0};
+    flux_fsm_t* fsm = flux_fsm_codegen_instantiate(gen, bench_symbols,
+        sizeof(bench_symbols) / sizeof(bench_symbols[0]), &table_ctx);
+    flux_fsm_codegen_destroy(gen);
+    if (!fsm || flux_fsm_seal(fsm) != FLUX_FSM_OK) {
+        fprintf(stderr, "cannot instantiate definition\n");
+        return 1;
+    }
+
+    unsigned long table_ok = 0;
+    double t0 = now_sec();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < EVENTS; i++) {
+            table_ok += flux_fsm_process_event(fsm, events[i]) == FLUX_FSM_OK;
+        }
+    }
+    double table_sec = now_sec() - t0;
+
+    bench_ctx_t switch_ctx = {0, 0, 0};
+    int state = BENCH_INITIAL_STATE;
+    unsigned long switch_ok = 0;
+    t0 = now_sec();
+    for (long r = 0; r < rounds; r++) {
+        for (int i = 0; i < EVENTS; i++) {
+            switch_ok += bench_dispatch(&state, &switch_ctx, events[i]) == FLUX_FSM_OK;
+        }
+    }
+    double switch_sec = now_sec() - t0;
+
+    double total = (double)rounds * EVENTS;
+    printf("%-8s %10.2f ns/event\n", "table", table_sec * 1e9 / total);
+    printf("%-8s %10.2f ns/event\n", "switch", switch_sec * 1e9 / total);
+
+    int same = table_ok == switch_ok
+            && flux_fsm_get_state(fsm) == state
+            && table_ctx.guards == switch_ctx.guards
+            && table_ctx.actions == switch_ctx.actions
+            && table_ctx.handled == switch_ctx.handled;
+    printf("results %s (%lu transitions)\n", same ? "match" : "DIFFER", switch_ok);
+
+    flux_fsm_destroy(fsm);
+    return same ? 0 : 1;
+}
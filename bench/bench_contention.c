@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+/*
+ * 竞争基准：多个线程向同一台状态机投递事件，对比
+ *   cas   - flux_fsm_ts_process_event（CAS 提交源状态）
+ *   mutex - 全局互斥锁保护的 flux_fsm_inst_process_event
+ * 状态机为 STATES 个状态组成的环，所有线程发送同一事件。
+ *
+ * 用法: bench_contention [每线程事件数] [最大线程数]
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "flux_fsm_core.h"
+
+#define STATES      16
+#define EVENT_NEXT  0
+
+typedef enum {
+    BENCH_CAS,
+    BENCH_MUTEX
+} bench_mode_t;
+
+static flux_fsm_ts_t ts_machine;
+static flux_fsm_inst_t inst_machine;
+static pthread_mutex_t inst_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bench_mode_t mode;
+static long per_thread;
+static atomic_int start_flag;
+static atomic_long total_attempts;
+
+/* 守卫在每次提交尝试前求值一次，用于统计 CAS 重试 */
+static _Thread_local long attempts;
+
+static int count_guard(void* ctx) {
+    (void)ctx;
+    attempts++;
+    return 1;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* bench_worker(void* arg) {
+    (void)arg;
+    attempts = 0;
+
+    while (!atomic_load_explicit(&start_flag, memory_order_acquire)) {
+    }
+
+    if (mode == BENCH_CAS) {
+        for (long i = 0; i < per_thread; i++) {
+            flux_fsm_ts_process_event(&ts_machine, EVENT_NEXT);
+        }
+    } else {
+        for (long i = 0; i < per_thread; i++) {
+            pthread_mutex_lock(&inst_lock);
+            flux_fsm_inst_process_event(&inst_machine, EVENT_NEXT);
+            pthread_mutex_unlock(&inst_lock);
+        }
+    }
+
+    atomic_fetch_add(&total_attempts, attempts);
+    return NULL;
+}
+
+static void bench_run(bench_mode_t m, int threads) {
+    pthread_t tids[threads];
+
+    mode = m;
+    atomic_store(&start_flag, 0);
+    atomic_store(&total_attempts, 0);
+
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&tids[i], NULL, bench_worker, NULL);
+    }
+
+    double t0 = now_sec();
+    atomic_store_explicit(&start_flag, 1, memory_order_release);
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double elapsed = now_sec() - t0;
+
+    long ops = per_thread * threads;
+    printf("%-6s %7d %12.1f %12.2f %10.3f\n",
+           m == BENCH_CAS ? "cas" : "mutex", threads,
+           ops / elapsed / 1e6, elapsed * 1e9 / ops,
+           (double)atomic_load(&total_attempts) / ops);
+}
+
+int main(int argc, char** argv) {
+    per_thread = argc > 1 ? atol(argv[1]) : 1000000;
+    int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    for (int s = 0; s < STATES; s++) {
+        flux_fsm_transition_t next = { s, EVENT_NEXT, (s + 1) % STATES, count_guard, NULL };
+        flux_fsm_def_add_transition(def, &next);
+    }
+    flux_fsm_def_seal(def);
+
+    if (flux_fsm_ts_init(&ts_machine, def, 0, NULL) != FLUX_FSM_OK ||
+        flux_fsm_inst_init(&inst_machine, def, 0, NULL) != FLUX_FSM_OK) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+    flux_fsm_def_release(def);
+
+    printf("%-6s %7s %12s %12s %10s\n", "mode", "threads", "Mops/s", "ns/op", "tries/op");
+    for (int t = 1; t <= max_threads; t *= 2) {
+        bench_run(BENCH_CAS, t);
+        bench_run(BENCH_MUTEX, t);
+    }
+
+    flux_fsm_ts_fini(&ts_machine);
+    flux_fsm_inst_fini(&inst_machine);
+    return 0;
+}
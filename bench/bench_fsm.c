@@ -0,0 +1,785 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+/*
+ * 微基准套件：flux_fsm_process_event 的吞吐与延迟，以及状态机创建/销毁与
+ * 转移表加载。参数（状态数、每状态扇出、守卫/动作、命中率、是否封存、线程数）
+ * 编码在基准名中，每个线程驱动各自的状态机。
+ *
+ * 迭代次数自动增长至单次运行不短于 min_time；结果以 Google Benchmark 的
+ * JSON 格式输出，可直接用其 tools/compare.py 对比不同版本。
+ *
+ * 用法: bench_fsm [--benchmark_filter=<正则>] [--benchmark_min_time=<秒>]
+ *                 [--benchmark_repetitions=<n>] [--benchmark_format=console|json]
+ *                 [--benchmark_out=<文件>] [--benchmark_list_tests]
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <regex.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "flux_fsm_core.h"
+#include "flux_fsm_perf.h"
+
+#define BENCH_EVENTS        4096        /* 循环使用的事件序列长度，2 的幂 */
+#define BENCH_MAX_COUNTERS  8
+#define BENCH_MAX_ITERS     1000000000ull
+
+typedef struct bench_case_s bench_case_t;
+typedef struct bench_state_s bench_state_t;
+typedef void (*bench_fn_t)(bench_state_t* st);
+
+/**
+ * @struct bench_case_s
+ * @brief 一个基准实例：函数与参数，name 由参数生成
+ *
+ * @var hit 事件命中转移的百分比，其余事件没有匹配的转移
+ * @var transitions 加载类基准的转移总数
+ */
+struct bench_case_s {
+    const char* family;
+    bench_fn_t fn;
+    int states;
+    int fanout;
+    int guard;
+    int action;
+    int hit;
+    int sealed;
+    int threads;
+    int transitions;
+    int family_index;
+    int instance_index;
+    char name[160];
+};
+
+/**
+ * @struct bench_state_s
+ * @brief 单个线程的一次运行
+ *
+ * @var iterations 本线程须完成的迭代数
+ * @var items 完成的项数，用于 items_per_second，缺省等于 iterations
+ * @var start/stop 计时区间的墙钟时间（秒）
+ * @var cpu 计时区间内的线程 CPU 时间（秒）
+ */
+struct bench_state_s {
+    const bench_case_t* bc;
+    int thread_index;
+    uint64_t iterations;
+    uint64_t items;
+    double start;
+    double stop;
+    double cpu;
+    int counter_count;
+    const char* counter_names[BENCH_MAX_COUNTERS];
+    double counters[BENCH_MAX_COUNTERS];
+};
+
+typedef struct {
+    const bench_case_t* bc;
+    const char* aggregate;
+    int repetition;
+    uint64_t iterations;
+    double real_ns;
+    double cpu_ns;
+    double items_per_second;
+    int counter_count;
+    const char* counter_names[BENCH_MAX_COUNTERS];
+    double counters[BENCH_MAX_COUNTERS];
+} bench_result_t;
+
+static atomic_int bench_ready;
+static atomic_int bench_go;
+static volatile uint64_t bench_sink;
+
+static double bench_now(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* 所有线程完成准备后同时开始计时 */
+static void bench_start(bench_state_t* st) {
+    atomic_fetch_add(&bench_ready, 1);
+    while (!atomic_load_explicit(&bench_go, memory_order_acquire)) {
+    }
+    st->cpu = bench_now(CLOCK_THREAD_CPUTIME_ID);
+    st->start = bench_now(CLOCK_MONOTONIC);
+}
+
+static void bench_stop(bench_state_t* st) {
+    st->stop = bench_now(CLOCK_MONOTONIC);
+    st->cpu = bench_now(CLOCK_THREAD_CPUTIME_ID) - st->cpu;
+}
+
+static void bench_counter(bench_state_t* st, const char* name, double value) {
+    if (st->counter_count < BENCH_MAX_COUNTERS) {
+        st->counter_names[st->counter_count] = name;
+        st->counters[st->counter_count++] = value;
+    }
+}
+
+static int bench_guard(void* ctx) {
+    return ctx != NULL;
+}
+
+static void bench_action(void* ctx) {
+    ++*(unsigned long*)ctx;
+}
+
+/* 每个状态 fanout 条转移：(s, e) -> (s * 7 + e + 1) % states，事件 0 .. fanout-1 */
+static flux_fsm_transition_t* bench_table(const bench_case_t* bc, int states, size_t* n) {
+    *n = (size_t)states * (size_t)bc->fanout;
+    flux_fsm_transition_t* t = malloc(*n * sizeof(flux_fsm_transition_t));
+    if (!t) {
+        return NULL;
+    }
+
+    for (int s = 0, i = 0; s < states; s++) {
+        for (int e = 0; e < bc->fanout; e++, i++) {
+            t[i].from = s;
+            t[i].event = e;
+            t[i].to = (int)(((long)s * 7 + e + 1) % states);
+            t[i].guard = bc->guard ? bench_guard : NULL;
+            t[i].action = bc->action ? bench_action : NULL;
+        }
+    }
+    return t;
+}
+
+/* 各状态均有事件 0 .. fanout-1 的转移，命中与否与当前状态无关 */
+static void bench_events(const bench_case_t* bc, uint32_t seed, flux_fsm_event_t* ev) {
+    uint32_t x = seed * 2654435761u + 1;
+
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        ev[i] = (int)(x % 100) < bc->hit ? (int)((x >> 8) % (uint32_t)bc->fanout)
+                                         : bc->fanout + (int)((x >> 8) & 3);
+    }
+}
+
+static flux_fsm_t* bench_machine(const bench_case_t* bc, unsigned long* ctx) {
+    size_t n;
+    flux_fsm_transition_t* table = bench_table(bc, bc->states, &n);
+    flux_fsm_t* fsm = flux_fsm_create(0, ctx);
+
+    if (!table || !fsm || flux_fsm_add_transitions(fsm, table, n) != FLUX_FSM_OK ||
+        (bc->sealed && flux_fsm_seal(fsm) != FLUX_FSM_OK)) {
+        fprintf(stderr, "%s: cannot build machine\n", bc->name);
+        exit(1);
+    }
+    free(table);
+    return fsm;
+}
+
+static void bm_process_event(bench_state_t* st) {
+    static _Thread_local flux_fsm_event_t ev[BENCH_EVENTS];
+    unsigned long actions = 0;
+    uint64_t ok = 0;
+    flux_fsm_t* fsm = bench_machine(st->bc, &actions);
+
+    bench_events(st->bc, (uint32_t)st->thread_index + 1, ev);
+
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        ok += flux_fsm_process_event(fsm, ev[i & (BENCH_EVENTS - 1)]) == FLUX_FSM_OK;
+    }
+    bench_stop(st);
+
+    bench_sink = ok + actions;
+    bench_counter(st, "hit_ratio", st->iterations ? (double)ok / (double)st->iterations : 0.0);
+    flux_fsm_destroy(fsm);
+}
+
+/* 逐事件计时，分位数包含一次时钟读取的开销 */
+static void bm_process_event_latency(bench_state_t* st) {
+    static _Thread_local flux_fsm_event_t ev[BENCH_EVENTS];
+    static _Thread_local flux_fsm_hist_t hist;
+    static _Thread_local flux_fsm_hist_snapshot_t snap;
+    unsigned long actions = 0;
+    struct timespec t0, t1;
+    flux_fsm_t* fsm = bench_machine(st->bc, &actions);
+
+    bench_events(st->bc, (uint32_t)st->thread_index + 1, ev);
+    flux_fsm_hist_init(&hist);
+
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        flux_fsm_process_event(fsm, ev[i & (BENCH_EVENTS - 1)]);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        flux_fsm_hist_record(&hist, (uint64_t)((t1.tv_sec - t0.tv_sec) * 1000000000L
+                                               + (t1.tv_nsec - t0.tv_nsec)));
+    }
+    bench_stop(st);
+
+    flux_fsm_hist_snapshot(&hist, &snap);
+    bench_counter(st, "p50_ns", (double)flux_fsm_hist_percentile(&snap, 50.0));
+    bench_counter(st, "p90_ns", (double)flux_fsm_hist_percentile(&snap, 90.0));
+    bench_counter(st, "p99_ns", (double)flux_fsm_hist_percentile(&snap, 99.0));
+    bench_counter(st, "p999_ns", (double)flux_fsm_hist_percentile(&snap, 99.9));
+    bench_counter(st, "max_ns", (double)snap.max);
+    bench_sink = actions;
+    flux_fsm_destroy(fsm);
+}
+
+static void bm_create_destroy(bench_state_t* st) {
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        flux_fsm_t* fsm = flux_fsm_create(0, NULL);
+        bench_sink += (uintptr_t)fsm;
+        flux_fsm_destroy(fsm);
+    }
+    bench_stop(st);
+}
+
+static void bm_create_destroy_pool(bench_state_t* st) {
+    flux_fsm_pool_t* pool = flux_fsm_pool_create(4096);
+
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        flux_fsm_t* fsm = flux_fsm_create_from_pool(pool, 0, NULL);
+        bench_sink += (uintptr_t)fsm;
+        flux_fsm_pool_reset(pool);
+    }
+    bench_stop(st);
+
+    flux_fsm_pool_destroy(pool);
+}
+
+/* 一次迭代：创建状态机、批量加载整张表（可选封存）并销毁 */
+static void bm_load_table(bench_state_t* st) {
+    size_t n;
+    flux_fsm_transition_t* table = bench_table(st->bc, st->bc->transitions / st->bc->fanout, &n);
+
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        flux_fsm_t* fsm = flux_fsm_create(0, NULL);
+        flux_fsm_add_transitions(fsm, table, n);
+        if (st->bc->sealed) {
+            flux_fsm_seal(fsm);
+        }
+        bench_sink += fsm->transition_count;
+        flux_fsm_destroy(fsm);
+    }
+    bench_stop(st);
+
+    st->items = st->iterations * n;
+    free(table);
+}
+
+/* 逐条 flux_fsm_add_transition 加载，对比批量接口 */
+static void bm_load_table_incremental(bench_state_t* st) {
+    size_t n;
+    flux_fsm_transition_t* table = bench_table(st->bc, st->bc->transitions / st->bc->fanout, &n);
+
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        flux_fsm_t* fsm = flux_fsm_create(0, NULL);
+        for (size_t j = 0; j < n; j++) {
+            flux_fsm_add_transition(fsm, &table[j]);
+        }
+        if (st->bc->sealed) {
+            flux_fsm_seal(fsm);
+        }
+        bench_sink += fsm->transition_count;
+        flux_fsm_destroy(fsm);
+    }
+    bench_stop(st);
+
+    st->items = st->iterations * n;
+    free(table);
+}
+
+/* 一次迭代：映射预先保存的定义映像并释放 */
+static void bm_def_map(bench_state_t* st) {
+    char path[256];
+    size_t n;
+    flux_fsm_transition_t* table = bench_table(st->bc, st->bc->transitions / st->bc->fanout, &n);
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    const char* dir = getenv("TMPDIR");
+
+    snprintf(path, sizeof(path), "%s/bench_fsm.%ld.%d.img",
+             dir ? dir : "/tmp", (long)getpid(), st->thread_index);
+    if (!table || !def || flux_fsm_def_add_transitions(def, table, n) != FLUX_FSM_OK ||
+        flux_fsm_def_seal(def) != FLUX_FSM_OK ||
+        flux_fsm_def_save(def, path, NULL, 0) != FLUX_FSM_OK) {
+        fprintf(stderr, "%s: cannot save %s\n", st->bc->name, path);
+        exit(1);
+    }
+    flux_fsm_def_release(def);
+    free(table);
+
+    bench_start(st);
+    for (uint64_t i = 0; i < st->iterations; i++) {
+        flux_fsm_def_t* mapped = flux_fsm_def_map(path, NULL, 0);
+        bench_sink += (uintptr_t)mapped;
+        flux_fsm_def_release(mapped);
+    }
+    bench_stop(st);
+
+    st->items = st->iterations * n;
+    unlink(path);
+}
+
+static void* bench_thread(void* arg) {
+    bench_state_t* st = arg;
+    st->bc->fn(st);
+    return NULL;
+}
+
+/* 以每线程 iterations 次迭代运行一次，汇总各线程 */
+static void bench_run_once(const bench_case_t* bc, uint64_t iterations, bench_result_t* r) {
+    int threads = bc->threads;
+    bench_state_t* st = calloc((size_t)threads, sizeof(bench_state_t));
+    pthread_t* tids = calloc((size_t)threads, sizeof(pthread_t));
+
+    if (!st || !tids) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < threads; i++) {
+        st[i].bc = bc;
+        st[i].thread_index = i;
+        st[i].iterations = iterations;
+    }
+
+    atomic_store(&bench_ready, 0);
+    if (threads == 1) {
+        atomic_store(&bench_go, 1);
+        bench_thread(&st[0]);
+    } else {
+        atomic_store(&bench_go, 0);
+        for (int i = 0; i < threads; i++) {
+            pthread_create(&tids[i], NULL, bench_thread, &st[i]);
+        }
+        while (atomic_load(&bench_ready) < threads) {
+            sched_yield();
+        }
+        atomic_store_explicit(&bench_go, 1, memory_order_release);
+        for (int i = 0; i < threads; i++) {
+            pthread_join(tids[i], NULL);
+        }
+    }
+
+    double start = st[0].start;
+    double stop = st[0].stop;
+    double cpu = 0.0;
+    uint64_t items = 0;
+
+    for (int i = 0; i < threads; i++) {
+        start = st[i].start < start ? st[i].start : start;
+        stop = st[i].stop > stop ? st[i].stop : stop;
+        cpu += st[i].cpu;
+        items += st[i].items ? st[i].items : st[i].iterations;
+    }
+
+    memset(r, 0, sizeof(*r));
+    r->bc = bc;
+    r->iterations = iterations;
+    r->real_ns = (stop - start) * 1e9 / (double)iterations;
+    r->cpu_ns = cpu / threads * 1e9 / (double)iterations;
+    r->items_per_second = stop > start ? (double)items / (stop - start) : 0.0;
+
+    /* 自定义计数取各线程平均 */
+    r->counter_count = st[0].counter_count;
+    for (int c = 0; c < r->counter_count; c++) {
+        r->counter_names[c] = st[0].counter_names[c];
+        for (int i = 0; i < threads; i++) {
+            r->counters[c] += st[i].counters[c] / threads;
+        }
+    }
+
+    free(st);
+    free(tids);
+}
+
+/* 迭代次数按上次耗时外推，直到一次运行不短于 min_time，与 Google Benchmark 相同 */
+static void bench_run(const bench_case_t* bc, double min_time, bench_result_t* r) {
+    uint64_t iterations = 1;
+
+    for (;;) {
+        bench_run_once(bc, iterations, r);
+
+        double seconds = r->real_ns * (double)iterations / 1e9;
+        if (seconds >= min_time || iterations >= BENCH_MAX_ITERS) {
+            return;
+        }
+
+        double multiplier = seconds / min_time > 0.1 ? min_time * 1.4 / seconds : 10.0;
+        uint64_t next = (uint64_t)((double)iterations * multiplier);
+        iterations = next > iterations ? (next < BENCH_MAX_ITERS ? next : BENCH_MAX_ITERS)
+                                       : iterations + 1;
+    }
+}
+
+static bench_case_t* bench_cases;
+static size_t bench_case_count;
+static size_t bench_case_capacity;
+
+static bench_case_t* bench_add(const char* family, bench_fn_t fn) {
+    if (bench_case_count == bench_case_capacity) {
+        bench_case_capacity = bench_case_capacity ? bench_case_capacity * 2 : 64;
+        bench_cases = realloc(bench_cases, bench_case_capacity * sizeof(bench_case_t));
+        if (!bench_cases) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+
+    bench_case_t* bc = &bench_cases[bench_case_count++];
+    memset(bc, 0, sizeof(*bc));
+    bc->family = family;
+    bc->fn = fn;
+    bc->fanout = 4;
+    bc->hit = 100;
+    bc->sealed = 1;
+    bc->threads = 1;
+    return bc;
+}
+
+static void bench_add_dispatch(const char* family, bench_fn_t fn, int states, int fanout,
+    int guard, int action, int hit, int sealed, int threads)
+{
+    bench_case_t* bc = bench_add(family, fn);
+
+    bc->states = states;
+    bc->fanout = fanout;
+    bc->guard = guard;
+    bc->action = action;
+    bc->hit = hit;
+    bc->sealed = sealed;
+    bc->threads = threads;
+    snprintf(bc->name, sizeof(bc->name),
+             "%s/states:%d/fanout:%d/guard:%d/action:%d/hit:%d/sealed:%d/threads:%d",
+             family, states, fanout, guard, action, hit, sealed, threads);
+}
+
+static void bench_add_load(const char* family, bench_fn_t fn, int transitions, int sealed) {
+    bench_case_t* bc = bench_add(family, fn);
+
+    bc->transitions = transitions;
+    bc->sealed = sealed;
+    snprintf(bc->name, sizeof(bc->name), "%s/transitions:%d/sealed:%d", family, transitions, sealed);
+}
+
+static void bench_register(void) {
+    static const int states[] = { 8, 64, 1024, 16384 };
+    static const int fanouts[] = { 1, 16, 64 };
+    static const int hits[] = { 90, 50, 0 };
+    static const int threads[] = { 2, 4, 8 };
+    static const int loads[] = { 64, 1024, 16384 };
+
+    /* 状态数与转移数 */
+    for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); i++) {
+        bench_add_dispatch("BM_ProcessEvent", bm_process_event, states[i], 4, 0, 0, 100, 1, 1);
+    }
+    /* 每状态扇出 */
+    for (size_t i = 0; i < sizeof(fanouts) / sizeof(fanouts[0]); i++) {
+        bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, fanouts[i], 0, 0, 100, 1, 1);
+    }
+    /* 守卫与动作 */
+    bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, 4, 1, 0, 100, 1, 1);
+    bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, 4, 0, 1, 100, 1, 1);
+    bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, 4, 1, 1, 100, 1, 1);
+    /* 命中率 */
+    for (size_t i = 0; i < sizeof(hits) / sizeof(hits[0]); i++) {
+        bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, 4, 0, 0, hits[i], 1, 1);
+    }
+    /* 未封存：线性查找 */
+    bench_add_dispatch("BM_ProcessEvent", bm_process_event, 8, 4, 0, 0, 100, 0, 1);
+    bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, 4, 0, 0, 100, 0, 1);
+    /* 线程数，每个线程各自的状态机 */
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        bench_add_dispatch("BM_ProcessEvent", bm_process_event, 64, 4, 0, 0, 100, 1, threads[i]);
+    }
+
+    bench_add_dispatch("BM_ProcessEventLatency", bm_process_event_latency, 64, 4, 0, 0, 100, 1, 1);
+    bench_add_dispatch("BM_ProcessEventLatency", bm_process_event_latency, 64, 4, 1, 1, 50, 1, 1);
+    bench_add_dispatch("BM_ProcessEventLatency", bm_process_event_latency, 16384, 4, 1, 1, 100, 1, 1);
+
+    snprintf(bench_add("BM_CreateDestroy", bm_create_destroy)->name, sizeof(bench_cases[0].name),
+             "BM_CreateDestroy");
+    snprintf(bench_add("BM_CreateDestroyPool", bm_create_destroy_pool)->name,
+             sizeof(bench_cases[0].name), "BM_CreateDestroyPool");
+
+    for (size_t i = 0; i < sizeof(loads) / sizeof(loads[0]); i++) {
+        bench_add_load("BM_LoadTable", bm_load_table, loads[i], 1);
+    }
+    bench_add_load("BM_LoadTable", bm_load_table, 1024, 0);
+    bench_add_load("BM_LoadTableIncremental", bm_load_table_incremental, 1024, 0);
+    bench_add_load("BM_DefMap", bm_def_map, 1024, 1);
+    bench_add_load("BM_DefMap", bm_def_map, 16384, 1);
+
+    /* compare.py 按 family_index / per_family_instance_index 配对 */
+    int family = -1;
+    int instance = 0;
+    for (size_t i = 0; i < bench_case_count; i++) {
+        if (i == 0 || strcmp(bench_cases[i].family, bench_cases[i - 1].family) != 0) {
+            family++;
+            instance = 0;
+        }
+        bench_cases[i].family_index = family;
+        bench_cases[i].instance_index = instance++;
+    }
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+/* 由 reps 次运行生成 mean / median / stddev 汇总项 */
+static void bench_aggregate(const bench_result_t* runs, int reps, bench_result_t* out) {
+    static const char* const names[] = { "mean", "median", "stddev" };
+    double* v = malloc((size_t)reps * sizeof(double));
+
+    if (!v) {
+        return;
+    }
+
+    for (int a = 0; a < 3; a++) {
+        bench_result_t* r = &out[a];
+        *r = runs[0];
+        r->aggregate = names[a];
+        r->iterations = (uint64_t)reps;
+
+        for (int field = -3; field < runs[0].counter_count; field++) {
+            for (int i = 0; i < reps; i++) {
+                v[i] = field == -3 ? runs[i].real_ns
+                     : field == -2 ? runs[i].cpu_ns
+                     : field == -1 ? runs[i].items_per_second
+                     : runs[i].counters[field];
+            }
+
+            double mean = 0.0;
+            for (int i = 0; i < reps; i++) {
+                mean += v[i] / reps;
+            }
+
+            double value = mean;
+            if (a == 1) {
+                qsort(v, (size_t)reps, sizeof(double), bench_compare_double);
+                value = reps % 2 ? v[reps / 2] : (v[reps / 2 - 1] + v[reps / 2]) / 2;
+            } else if (a == 2) {
+                double sq = 0.0;
+                for (int i = 0; i < reps; i++) {
+                    sq += (v[i] - mean) * (v[i] - mean);
+                }
+                value = reps > 1 ? sqrt(sq / (reps - 1)) : 0.0;
+            }
+
+            if (field == -3) {
+                r->real_ns = value;
+            } else if (field == -2) {
+                r->cpu_ns = value;
+            } else if (field == -1) {
+                r->items_per_second = value;
+            } else {
+                r->counters[field] = value;
+            }
+        }
+    }
+
+    free(v);
+}
+
+static void bench_json_string(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(out, "\\%c", *s);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*s);
+        } else {
+            fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void bench_write_json(FILE* out, const char* executable, int reps,
+    const bench_result_t* results, size_t n)
+{
+    char date[64];
+    char host[256] = "";
+    time_t now = time(NULL);
+
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+    gethostname(host, sizeof(host) - 1);
+
+    fprintf(out, "{\n  \"context\": {\n    \"date\": ");
+    bench_json_string(out, date);
+    fprintf(out, ",\n    \"host_name\": ");
+    bench_json_string(out, host);
+    fprintf(out, ",\n    \"executable\": ");
+    bench_json_string(out, executable);
+    fprintf(out, ",\n    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#if defined(NDEBUG)
+    fprintf(out, "    \"library_build_type\": \"release\"\n  },\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\"\n  },\n");
+#endif
+    fprintf(out, "  \"benchmarks\": [");
+
+    for (size_t i = 0; i < n; i++) {
+        const bench_result_t* r = &results[i];
+
+        fprintf(out, "%s\n    {\n      \"name\": \"%s%s%s\",\n", i ? "," : "",
+                r->bc->name, r->aggregate ? "_" : "", r->aggregate ? r->aggregate : "");
+        fprintf(out, "      \"family_index\": %d,\n      \"per_family_instance_index\": %d,\n",
+                r->bc->family_index, r->bc->instance_index);
+        fprintf(out, "      \"run_name\": \"%s\",\n", r->bc->name);
+        if (r->aggregate) {
+            fprintf(out, "      \"run_type\": \"aggregate\",\n      \"repetitions\": %d,\n"
+                         "      \"threads\": %d,\n      \"aggregate_name\": \"%s\",\n"
+                         "      \"aggregate_unit\": \"time\",\n",
+                    reps, r->bc->threads, r->aggregate);
+        } else {
+            fprintf(out, "      \"run_type\": \"iteration\",\n      \"repetitions\": %d,\n"
+                         "      \"repetition_index\": %d,\n      \"threads\": %d,\n",
+                    reps, r->repetition, r->bc->threads);
+        }
+        fprintf(out, "      \"iterations\": %llu,\n      \"real_time\": %.6e,\n"
+                     "      \"cpu_time\": %.6e,\n      \"time_unit\": \"ns\",\n"
+                     "      \"items_per_second\": %.6e",
+                (unsigned long long)r->iterations, r->real_ns, r->cpu_ns, r->items_per_second);
+        for (int c = 0; c < r->counter_count; c++) {
+            fprintf(out, ",\n      \"%s\": %.6e", r->counter_names[c], r->counters[c]);
+        }
+        fprintf(out, "\n    }");
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void bench_print(const bench_result_t* r) {
+    char name[200];
+
+    snprintf(name, sizeof(name), "%s%s%s", r->bc->name,
+             r->aggregate ? "_" : "", r->aggregate ? r->aggregate : "");
+    printf("%-90s %10.1f ns %10.1f ns %12llu items_per_second=%.4gM/s",
+           name, r->real_ns, r->cpu_ns, (unsigned long long)r->iterations,
+           r->items_per_second / 1e6);
+    for (int c = 0; c < r->counter_count; c++) {
+        printf(" %s=%.4g", r->counter_names[c], r->counters[c]);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static const char* bench_option(const char* arg, const char* name) {
+    size_t len = strlen(name);
+    return strncmp(arg, name, len) == 0 && arg[len] == '=' ? arg + len + 1 : NULL;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = ".";
+    const char* out_file = NULL;
+    double min_time = 0.5;
+    int reps = 1;
+    int json = 0;
+    int list = 0;
+    const char* v;
+
+    for (int i = 1; i < argc; i++) {
+        if ((v = bench_option(argv[i], "--benchmark_filter"))) {
+            filter = v;
+        } else if ((v = bench_option(argv[i], "--benchmark_min_time"))) {
+            min_time = atof(v);
+        } else if ((v = bench_option(argv[i], "--benchmark_repetitions"))) {
+            reps = atoi(v) > 0 ? atoi(v) : 1;
+        } else if ((v = bench_option(argv[i], "--benchmark_format"))) {
+            json = strcmp(v, "json") == 0;
+        } else if ((v = bench_option(argv[i], "--benchmark_out"))) {
+            out_file = v;
+        } else if (bench_option(argv[i], "--benchmark_out_format")) {
+            /* 输出文件总是 JSON */
+        } else if (strcmp(argv[i], "--benchmark_list_tests") == 0) {
+            list = 1;
+        } else {
+            fprintf(stderr, "usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<s>]\n"
+                            "       [--benchmark_repetitions=<n>] [--benchmark_format=console|json]\n"
+                            "       [--benchmark_out=<file>] [--benchmark_list_tests]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    regex_t re;
+    if (regcomp(&re, filter, REG_EXTENDED | REG_NOSUB) != 0) {
+        fprintf(stderr, "invalid filter: %s\n", filter);
+        return 1;
+    }
+
+    bench_register();
+
+    size_t per_case = (size_t)reps + (reps > 1 ? 3 : 0);
+    bench_result_t* results = calloc(bench_case_count * per_case, sizeof(bench_result_t));
+    size_t n = 0;
+    if (!results) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (!json && !list) {
+        printf("%-90s %13s %13s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    }
+
+    for (size_t i = 0; i < bench_case_count; i++) {
+        const bench_case_t* bc = &bench_cases[i];
+
+        if (regexec(&re, bc->name, 0, NULL, 0) != 0) {
+            continue;
+        }
+        if (list) {
+            printf("%s\n", bc->name);
+            continue;
+        }
+
+        size_t first = n;
+        for (int r = 0; r < reps; r++) {
+            bench_run(bc, min_time, &results[n]);
+            results[n].repetition = r;
+            if (!json) {
+                bench_print(&results[n]);
+            }
+            n++;
+        }
+
+        if (reps > 1) {
+            bench_aggregate(&results[first], reps, &results[n]);
+            for (int a = 0; a < 3; a++, n++) {
+                if (!json) {
+                    bench_print(&results[n]);
+                }
+            }
+        }
+    }
+
+    if (json) {
+        bench_write_json(stdout, argv[0], reps, results, n);
+    }
+    if (out_file) {
+        FILE* out = fopen(out_file, "w");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", out_file);
+            return 1;
+        }
+        bench_write_json(out, argv[0], reps, results, n);
+        fclose(out);
+    }
+
+    regfree(&re);
+    free(results);
+    free(bench_cases);
+    return 0;
+}
@@ -8,7 +8,12 @@
 #include "flux_fsm_config.h"
 #include "flux_fsm_core.h"
 #include "flux_fsm_event.h"
+#include "flux_fsm_executor.h"
+#include "flux_fsm_hierarchical.h"
 #include "flux_fsm_log.h"
+#include "flux_fsm_parallel.h"
 #include "flux_fsm_perf.h"
+#include "flux_fsm_queue.h"
+#include "flux_fsm_trace.h"
 
 #endif /* _FLUX_FSM_H_INCLUDED_ */
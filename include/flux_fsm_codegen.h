@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_CODEGEN_H_INCLUDED_
+#define _FLUX_FSM_CODEGEN_H_INCLUDED_
+
+#include <stdio.h>
+#include "flux_fsm_core.h"
+
+/*
+ * 代码生成器的中间表示：以名称描述回调的状态机定义，
+ * 可由 flux_fsm_t 加符号表得到，也可由定义文件解析得到。
+ *
+ * 定义文件为行格式，# 起始为注释：
+ *     initial <state>
+ *     transition <from> <event> <to> [guard|-] [action|-]
+ *     handler <state> <name>
+ */
+typedef struct flux_fsm_codegen_s flux_fsm_codegen_t;
+
+flux_fsm_codegen_t* flux_fsm_codegen_from_fsm(const flux_fsm_t* fsm,
+    const flux_fsm_symbol_t* symbols, size_t n);
+flux_fsm_codegen_t* flux_fsm_codegen_parse(const char* text, size_t* error_line);
+flux_fsm_codegen_t* flux_fsm_codegen_load(const char* filename, size_t* error_line);
+void flux_fsm_codegen_destroy(flux_fsm_codegen_t* gen);
+
+flux_fsm_t* flux_fsm_codegen_instantiate(const flux_fsm_codegen_t* gen,
+    const flux_fsm_symbol_t* symbols, size_t n, void* context);
+
+/* 生成 switch 分派源码 */
+flux_fsm_rc_t flux_fsm_codegen_write(const flux_fsm_codegen_t* gen, const char* prefix, FILE* out);
+char* flux_fsm_codegen_generate(const flux_fsm_codegen_t* gen, const char* prefix);
+void flux_fsm_codegen_free(char* source);
+int flux_fsm_codegen_export(const flux_fsm_codegen_t* gen, const char* prefix, const char* filename);
+
+#endif /* _FLUX_FSM_CODEGEN_H_INCLUDED_ */
@@ -13,25 +13,103 @@
 #define FLUX_FSM_POOL_SIZE       4096
 #define FLUX_FSM_MAX_ALLOC_FROM_POOL  (FLUX_FSM_POOL_SIZE - 1)
 
+/* Static pool backing store for bare-metal builds */
+#if !defined(FLUX_FSM_STATIC_POOL_SIZE)
+#define FLUX_FSM_STATIC_POOL_SIZE  (FLUX_FSM_POOL_SIZE * 16)
+#endif
+
 /* FSM limits */
 #define FLUX_FSM_MAX_STATES      32
 #define FLUX_FSM_MAX_TRANSITIONS 64
 #define FLUX_FSM_MAX_HANDLERS    16
 
+/* Per-state event bitmap covers states below this bound */
+#if !defined(FLUX_FSM_EVENT_MASK_STATES)
+#define FLUX_FSM_EVENT_MASK_STATES  4096
+#endif
+
+/* Default slot count of the optional hot-transition cache */
+#if !defined(FLUX_FSM_CACHE_SLOTS)
+#define FLUX_FSM_CACHE_SLOTS  64
+#endif
+
+/* Distinct definitions allowed in one instance snapshot */
+#if !defined(FLUX_FSM_SNAPSHOT_DEFS)
+#define FLUX_FSM_SNAPSHOT_DEFS  256
+#endif
+
 /* Build configuration */
 #if defined(FLUX_FSM_BARE_METAL)
 #define FLUX_FSM_NO_MALLOC
 #define FLUX_FSM_STATIC_POOL
+#define FLUX_FSM_HAVE_POOL
 #else
 #define FLUX_FSM_HAVE_MALLOC
 #define FLUX_FSM_HAVE_POOL
 #endif
 
+/* Lock-free state for concurrently driven instances */
+#if !defined(__STDC_NO_ATOMICS__) && !defined(FLUX_FSM_NO_ATOMIC)
+#define FLUX_FSM_HAVE_ATOMIC
+#endif
+
+/* SIMD lookup kernels for unsealed machines (x86 SSE2/AVX2, chosen at runtime) */
+#if !defined(FLUX_FSM_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define FLUX_FSM_HAVE_SIMD
+#endif
+
+/* Memory-mapped definition images (falls back to reading into memory) */
+#if !defined(FLUX_FSM_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#define FLUX_FSM_HAVE_MMAP
+#endif
+
+/* Binary transition tracing into per-thread mmap'd ring files */
+#if defined(FLUX_FSM_HAVE_MMAP) && defined(FLUX_FSM_HAVE_ATOMIC) && !defined(FLUX_FSM_NO_TRACE)
+#define FLUX_FSM_HAVE_TRACE
+#endif
+
+#if !defined(FLUX_FSM_TRACE_RECORDS)
+#define FLUX_FSM_TRACE_RECORDS  65536
+#endif
+
+/* Per-thread event/transition counters, enabled at runtime */
+#if defined(FLUX_FSM_HAVE_ATOMIC) && !defined(FLUX_FSM_NO_COUNTERS)
+#define FLUX_FSM_HAVE_COUNTERS
+#endif
+
+/* initial-exec TLS for the trace/counter fast paths; define FLUX_FSM_STATIC_TLS
+ * only when the library is linked statically, a dlopen'ed shared build may
+ * fail to load with it */
+#if defined(FLUX_FSM_STATIC_TLS) && (defined(__GNUC__) || defined(__clang__))
+#define FLUX_FSM_HAVE_INITIAL_EXEC_TLS
+#endif
+
+/* Slots in the per-transition phase breakdown of flux_fsm_perf_t (power of two) */
+#if !defined(FLUX_FSM_PERF_TRANSITIONS)
+#define FLUX_FSM_PERF_TRANSITIONS  64
+#endif
+
 /* Logging configuration */
 #if !defined(FLUX_FSM_NO_LOG)
 #define FLUX_FSM_HAVE_LOG
 #endif
 
+/* Async logging: per-thread ring bytes (power of two), max formatted message,
+ * writer batch buffer and idle flush interval */
+#if !defined(FLUX_FSM_LOG_RING_SIZE)
+#define FLUX_FSM_LOG_RING_SIZE     65536
+#endif
+#if !defined(FLUX_FSM_LOG_RECORD_MAX)
+#define FLUX_FSM_LOG_RECORD_MAX    1024
+#endif
+#if !defined(FLUX_FSM_LOG_BATCH_SIZE)
+#define FLUX_FSM_LOG_BATCH_SIZE    65536
+#endif
+#if !defined(FLUX_FSM_LOG_FLUSH_MS)
+#define FLUX_FSM_LOG_FLUSH_MS      10
+#endif
+
 /* Module configuration */
 #if !defined(FLUX_FSM_NO_MODULES)
 #define FLUX_FSM_HAVE_HIERARCHICAL
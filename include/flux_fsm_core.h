@@ -8,6 +8,11 @@
 #include "flux_fsm_config.h"
 #include "flux_fsm_event.h"
 #include <stddef.h>
+#include <stdint.h>
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+#include <stdatomic.h>
+#endif
 
 typedef void (*flux_fsm_state_handler_t)(void* ctx, flux_fsm_event_t event);
 
@@ -21,6 +26,55 @@ typedef struct {
     void (*action)(void*);
 } flux_fsm_transition_t;
 
+/**
+ * @struct flux_fsm_compact_t
+ * @brief 紧凑存储模式下的转移行，8 字节
+ *
+ * @var from 源状态
+ * @var event 触发事件
+ * @var to 目标状态
+ * @var cb 回调编号：0 表示无守卫与动作，否则为 callbacks[cb - 1]
+ */
+typedef struct {
+    uint16_t from;
+    uint16_t event;
+    uint16_t to;
+    uint16_t cb;
+} flux_fsm_compact_t;
+
+/* 紧凑模式的回调旁表项，相同的 (守卫, 动作) 组合只存一份 */
+typedef struct {
+    int (*guard)(void*);
+    void (*action)(void*);
+} flux_fsm_callbacks_t;
+
+/**
+ * @struct flux_fsm_symbol_t
+ * @brief 回调函数与名称的对应关系
+ *
+ * 转移表中只保存函数指针，导出为源码或文件时需要由符号表给出名称，
+ * 从文件加载时再由名称找回函数指针。一项只描述一个函数，
+ * guard、action、handler 中仅一个非空。
+ */
+typedef struct {
+    const char* name;
+    int (*guard)(void*);
+    void (*action)(void*);
+    flux_fsm_handler_pt handler;
+} flux_fsm_symbol_t;
+
+/* 编译后的 (状态, 事件) 分派索引，由 flux_fsm_seal 生成 */
+typedef struct flux_fsm_index_s flux_fsm_index_t;
+
+/* 可选的热点转移缓存，由 flux_fsm_cache_enable 创建 */
+typedef struct flux_fsm_cache_s flux_fsm_cache_t;
+
+/* 可选的转移命中与状态停留剖析，由 flux_fsm_profile_enable 创建 */
+typedef struct flux_fsm_profile_s flux_fsm_profile_t;
+
+/* 跨线程事件队列，见 flux_fsm_queue.h */
+typedef struct flux_fsm_queue_s flux_fsm_queue_t;
+
 /**
  * @struct flux_fsm
  * @brief 有限状态机核心结构体
@@ -30,9 +84,26 @@ typedef struct {
  * @var context 状态上下文指针
  * @var transitions 状态转移表指针
  * @var transition_count 转移规则数量
+ * @var transition_capacity 转移表容量
  * @var handlers 状态处理器数组
  * @var handler_count 处理器数量
+ * @var handler_capacity 处理器表容量
  * @var state_count 状态数量
+ * @var index 分派索引，NULL 时线性查找
+ * @var sealed 是否已封存，封存后修改转移表会在下次查找时重建索引
+ * @var pool 所属内存池，非 NULL 时所有表均从池中分配
+ * @var queue 跨线程事件队列，由 flux_fsm_queue_init 创建
+ * @var compact 紧凑转移表，非 NULL 时取代 transitions
+ * @var callbacks 紧凑模式的回调旁表
+ * @var callback_count 回调旁表项数
+ * @var callback_capacity 回调旁表容量
+ * @var scan_keys (from, event) 压缩键列，与转移表逐行对应，供线性查找使用
+ * @var event_masks 每个状态的有效事件位图，位 (event & 63) 表示可能存在转移
+ * @var event_mask_capacity 位图数组容量，超出部分的状态不做过滤
+ * @var version 转移表版本号，每次添加转移递增，使缓存项整体失效
+ * @var cache 热点转移缓存，NULL 表示未启用
+ * @var trace_id 追踪记录中的状态机标识，0 表示使用结构体地址
+ * @var profile 转移命中与状态停留剖析，NULL 表示未启用
  */
 typedef struct flux_fsm {
     int initial_state;
@@ -40,29 +111,221 @@ typedef struct flux_fsm {
     void* context;
     flux_fsm_transition_t* transitions;
     size_t transition_count;
+    size_t transition_capacity;
     flux_fsm_state_handler_t* handlers;
     size_t handler_count;
+    size_t handler_capacity;
     size_t state_count; // 新增的状态数量属性
+    flux_fsm_index_t* index;
+    int sealed;
+    struct flux_fsm_pool_s* pool;
+    flux_fsm_queue_t* queue;
+    flux_fsm_compact_t* compact;
+    flux_fsm_callbacks_t* callbacks;
+    size_t callback_count;
+    size_t callback_capacity;
+    uint32_t* scan_keys;
+    uint64_t* event_masks;
+    size_t event_mask_capacity;
+    uint32_t version;
+    uint32_t trace_id;
+    flux_fsm_cache_t* cache;
+    flux_fsm_profile_t* profile;
 } flux_fsm_t;
 
+/* 共享的只读状态机定义，引用计数 */
+typedef struct flux_fsm_def_s flux_fsm_def_t;
+
+/**
+ * @struct flux_fsm_inst_t
+ * @brief 基于共享定义的轻量状态机实例
+ *
+ * @var def 所引用的定义（已封存）
+ * @var context 状态上下文指针
+ * @var current_state 当前状态
+ * @var trace_id 追踪记录中的实例标识，0 表示使用结构体地址
+ */
+typedef struct {
+    flux_fsm_def_t* def;
+    void* context;
+    int current_state;
+    uint32_t trace_id;
+} flux_fsm_inst_t;
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+/**
+ * @struct flux_fsm_ts_t
+ * @brief 可被多个线程同时驱动的实例，状态以原子变量保存
+ *
+ * @var def 所引用的定义（已封存）
+ * @var context 状态上下文指针，由调用方保证其线程安全
+ * @var current_state 当前状态，读取无需加锁，转移通过 CAS 提交
+ * @var trace_id 追踪记录中的实例标识，0 表示使用结构体地址
+ */
+typedef struct {
+    flux_fsm_def_t* def;
+    void* context;
+    atomic_int current_state;
+    uint32_t trace_id;
+} flux_fsm_ts_t;
+#endif
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+/**
+ * @struct flux_fsm_counters_t
+ * @brief 全部线程合并后的事件计数
+ *
+ * @var events 处理的事件数
+ * @var transitions 成功完成的转移数
+ * @var guard_failures 守卫失败数
+ * @var invalid_events 无匹配转移或参数无效的事件数
+ * @var invalid_states 状态无效的事件数
+ * @var total_ns 处理事件的累计耗时（纳秒）
+ * @var max_ns 单个事件的最大耗时（纳秒）
+ */
+typedef struct {
+    uint64_t events;
+    uint64_t transitions;
+    uint64_t guard_failures;
+    uint64_t invalid_events;
+    uint64_t invalid_states;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} flux_fsm_counters_t;
+
+/**
+ * @struct flux_fsm_phase_t
+ * @brief 一次转移中守卫、动作与源状态处理器各自的耗时
+ *
+ * @var machine 状态机标识，与追踪记录相同
+ * @var rc FLUX_FSM_OK 或 FLUX_FSM_GUARD_FAIL，守卫失败时后两项为 0
+ */
+typedef struct {
+    uint64_t machine;
+    int from;
+    int event;
+    int to;
+    flux_fsm_rc_t rc;
+    uint64_t guard_ns;
+    uint64_t action_ns;
+    uint64_t handler_ns;
+} flux_fsm_phase_t;
+
+typedef void (*flux_fsm_phase_pt)(void* data, const flux_fsm_phase_t* phase);
+
+/**
+ * @struct flux_fsm_phase_sink_t
+ * @brief 阶段计时的接收者，在执行转移的线程上被同步调用
+ */
+typedef struct {
+    flux_fsm_phase_pt handler;
+    void* data;
+} flux_fsm_phase_sink_t;
+#endif
+
 /* 状态机内存池接口 */
 #if defined(FLUX_FSM_HAVE_POOL)
 typedef struct flux_fsm_pool_s flux_fsm_pool_t;
 
+typedef void (*flux_fsm_pool_cleanup_pt)(void* data);
+
 flux_fsm_pool_t* flux_fsm_pool_create(size_t size);
 void flux_fsm_pool_destroy(flux_fsm_pool_t* pool);
+void flux_fsm_pool_reset(flux_fsm_pool_t* pool);
 void* flux_fsm_palloc(flux_fsm_pool_t* pool, size_t size);
+void* flux_fsm_pcalloc(flux_fsm_pool_t* pool, size_t size);
+flux_fsm_rc_t flux_fsm_pool_cleanup_add(flux_fsm_pool_t* pool,
+    flux_fsm_pool_cleanup_pt handler, void* data);
+
+flux_fsm_t* flux_fsm_create_from_pool(flux_fsm_pool_t* pool, int initial_state, void* context);
+flux_fsm_inst_t* flux_fsm_inst_create_from_pool(flux_fsm_pool_t* pool, flux_fsm_def_t* def,
+    int init_state, void* context);
 #endif
 
 /* 状态机核心接口 */
 flux_fsm_t* flux_fsm_create(int initial_state, void* context);
 void flux_fsm_destroy(flux_fsm_t* fsm);
 flux_fsm_rc_t flux_fsm_add_transition(flux_fsm_t* fsm, const flux_fsm_transition_t* trans);
+flux_fsm_rc_t flux_fsm_add_transitions(flux_fsm_t* fsm, const flux_fsm_transition_t* trans, size_t n);
+uint32_t flux_fsm_generation(void);
+flux_fsm_rc_t flux_fsm_reserve(flux_fsm_t* fsm, size_t transitions, size_t states);
 flux_fsm_rc_t flux_fsm_add_handler(flux_fsm_t* fsm, int state, flux_fsm_handler_pt handler);
+flux_fsm_rc_t flux_fsm_seal(flux_fsm_t* fsm);
+flux_fsm_rc_t flux_fsm_compact(flux_fsm_t* fsm);
 flux_fsm_rc_t flux_fsm_process_event(flux_fsm_t* fsm, flux_fsm_event_t event);
+flux_fsm_rc_t flux_fsm_process_events(flux_fsm_t* fsm, const flux_fsm_event_t* events,
+    size_t n, flux_fsm_rc_t* results);
+flux_fsm_rc_t flux_fsm_process_events_multi(flux_fsm_t* const* fsms, const flux_fsm_event_t* events,
+    size_t n, flux_fsm_rc_t* results);
 flux_fsm_rc_t flux_fsm_exec_transition(flux_fsm_t* fsm, int trans_idx);
 int flux_fsm_find_transition(flux_fsm_t* fsm, int event);
 int flux_fsm_get_state(const flux_fsm_t* fsm);
+flux_fsm_rc_t flux_fsm_set_state(flux_fsm_t* fsm, int state);
+flux_fsm_rc_t flux_fsm_get_transition(const flux_fsm_t* fsm, size_t i, flux_fsm_transition_t* out);
+
+/* 热点转移缓存接口 */
+flux_fsm_rc_t flux_fsm_cache_enable(flux_fsm_t* fsm, size_t slots);
+void flux_fsm_cache_disable(flux_fsm_t* fsm);
+flux_fsm_rc_t flux_fsm_cache_stats(const flux_fsm_t* fsm, uint64_t* hits, uint64_t* misses);
+flux_fsm_rc_t flux_fsm_profile_enable(flux_fsm_t* fsm);
+void flux_fsm_profile_disable(flux_fsm_t* fsm);
+void flux_fsm_profile_reset(flux_fsm_t* fsm);
+uint64_t flux_fsm_profile_hits(const flux_fsm_t* fsm, size_t trans_idx);
+uint64_t flux_fsm_profile_dwell_ns(const flux_fsm_t* fsm, int state);
+
+/* 共享定义接口 */
+flux_fsm_def_t* flux_fsm_def_create(void);
+flux_fsm_def_t* flux_fsm_def_retain(flux_fsm_def_t* def);
+void flux_fsm_def_release(flux_fsm_def_t* def);
+flux_fsm_rc_t flux_fsm_def_add_transition(flux_fsm_def_t* def, const flux_fsm_transition_t* trans);
+flux_fsm_rc_t flux_fsm_def_add_transitions(flux_fsm_def_t* def, const flux_fsm_transition_t* trans, size_t n);
+flux_fsm_rc_t flux_fsm_def_add_handler(flux_fsm_def_t* def, int state, flux_fsm_handler_pt handler);
+flux_fsm_rc_t flux_fsm_def_seal(flux_fsm_def_t* def);
+flux_fsm_rc_t flux_fsm_def_compact(flux_fsm_def_t* def);
+const flux_fsm_t* flux_fsm_def_table(const flux_fsm_def_t* def);
+uint64_t flux_fsm_def_hash(const flux_fsm_def_t* def);
+
+/* 定义映像接口 */
+flux_fsm_rc_t flux_fsm_def_save(const flux_fsm_def_t* def, const char* filename,
+    const flux_fsm_symbol_t* symbols, size_t n);
+flux_fsm_def_t* flux_fsm_def_map(const char* filename, const flux_fsm_symbol_t* symbols, size_t n);
+
+/* 轻量实例接口 */
+flux_fsm_rc_t flux_fsm_inst_init(flux_fsm_inst_t* inst, flux_fsm_def_t* def, int init_state, void* context);
+void flux_fsm_inst_fini(flux_fsm_inst_t* inst);
+flux_fsm_inst_t* flux_fsm_inst_create(flux_fsm_def_t* def, int init_state, void* context);
+void flux_fsm_inst_destroy(flux_fsm_inst_t* inst);
+flux_fsm_rc_t flux_fsm_inst_process_event(flux_fsm_inst_t* inst, flux_fsm_event_t event);
+int flux_fsm_inst_get_state(const flux_fsm_inst_t* inst);
+
+/* 实例状态快照接口 */
+size_t flux_fsm_snapshot_size(const flux_fsm_inst_t* insts, size_t n, const uint64_t* ids);
+flux_fsm_rc_t flux_fsm_snapshot_encode(void* buf, size_t size, const flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids);
+flux_fsm_rc_t flux_fsm_snapshot_decode(const void* buf, size_t size, flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids);
+flux_fsm_rc_t flux_fsm_snapshot_save(const char* filename, const flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids);
+flux_fsm_rc_t flux_fsm_snapshot_restore(const char* filename, flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids);
+
+/* 线程安全实例接口 */
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+flux_fsm_rc_t flux_fsm_ts_init(flux_fsm_ts_t* ts, flux_fsm_def_t* def, int init_state, void* context);
+void flux_fsm_ts_fini(flux_fsm_ts_t* ts);
+flux_fsm_rc_t flux_fsm_ts_process_event(flux_fsm_ts_t* ts, flux_fsm_event_t event);
+flux_fsm_rc_t flux_fsm_ts_try_event(flux_fsm_ts_t* ts, int expected, flux_fsm_event_t event);
+int flux_fsm_ts_get_state(const flux_fsm_ts_t* ts);
+#endif
+
+/* 运行期计数接口 */
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+void flux_fsm_counters_enable(int enable);
+int flux_fsm_counters_enabled(void);
+void flux_fsm_counters_read(flux_fsm_counters_t* out);
+void flux_fsm_counters_reset(void);
+void flux_fsm_phases_attach(const flux_fsm_phase_sink_t* sink);
+#endif
 
 /* 特殊状态定义 */
 #define FLUX_FSM_ANY_STATE    -1
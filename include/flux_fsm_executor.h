@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_EXECUTOR_H_INCLUDED_
+#define _FLUX_FSM_EXECUTOR_H_INCLUDED_
+
+#include "flux_fsm_core.h"
+#include "flux_fsm_queue.h"
+
+#if defined(FLUX_FSM_HAVE_PARALLEL)
+
+/*
+ * 多核执行器：状态机按地址分片到工作线程，每个工作线程维护一个
+ * 待处理状态机的运行队列，空闲线程从其他线程的队列尾部窃取。
+ * 同一状态机同一时刻只被一个线程排空，其事件严格按投递顺序生效。
+ */
+typedef struct flux_fsm_executor_s flux_fsm_executor_t;
+
+flux_fsm_executor_t* flux_fsm_executor_create(size_t workers, size_t budget);
+void flux_fsm_executor_destroy(flux_fsm_executor_t* ex);
+flux_fsm_rc_t flux_fsm_executor_post(flux_fsm_executor_t* ex, flux_fsm_t* fsm, flux_fsm_event_t event);
+void flux_fsm_executor_wait_idle(flux_fsm_executor_t* ex);
+size_t flux_fsm_executor_workers(const flux_fsm_executor_t* ex);
+
+#endif /* FLUX_FSM_HAVE_PARALLEL */
+
+#endif /* _FLUX_FSM_EXECUTOR_H_INCLUDED_ */
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_HIERARCHICAL_H_INCLUDED_
+#define _FLUX_FSM_HIERARCHICAL_H_INCLUDED_
+
+#include "flux_fsm_core.h"
+
+#if defined(FLUX_FSM_HAVE_HIERARCHICAL)
+
+/* 顶层状态的父状态 */
+#define FLUX_FSM_HSM_ROOT  -1
+
+/*
+ * 层次状态机：状态可嵌套，当前状态无法处理的事件交由其超状态处理。
+ * flux_fsm_hsm_build 将层次结构展开为每个叶状态的等效转移表（一台已封存
+ * 的核心状态机），并预先计算每条转移的退出/进入序列，运行期分派不沿
+ * 父链查找，耗时与嵌套深度无关。
+ */
+typedef struct flux_fsm_hsm_s flux_fsm_hsm_t;
+
+/* 进入/退出处理器 */
+typedef void (*flux_fsm_hsm_state_pt)(void* ctx, int state);
+
+flux_fsm_hsm_t* flux_fsm_hsm_create(int initial_state, void* context);
+void flux_fsm_hsm_destroy(flux_fsm_hsm_t* hsm);
+flux_fsm_rc_t flux_fsm_hsm_add_state(flux_fsm_hsm_t* hsm, int state, int parent);
+flux_fsm_rc_t flux_fsm_hsm_set_initial(flux_fsm_hsm_t* hsm, int state, int child);
+flux_fsm_rc_t flux_fsm_hsm_set_entry(flux_fsm_hsm_t* hsm, int state, flux_fsm_hsm_state_pt entry);
+flux_fsm_rc_t flux_fsm_hsm_set_exit(flux_fsm_hsm_t* hsm, int state, flux_fsm_hsm_state_pt exit);
+flux_fsm_rc_t flux_fsm_hsm_add_transition(flux_fsm_hsm_t* hsm, const flux_fsm_transition_t* trans);
+flux_fsm_rc_t flux_fsm_hsm_build(flux_fsm_hsm_t* hsm);
+flux_fsm_rc_t flux_fsm_hsm_start(flux_fsm_hsm_t* hsm);
+flux_fsm_rc_t flux_fsm_hsm_process_event(flux_fsm_hsm_t* hsm, flux_fsm_event_t event);
+int flux_fsm_hsm_get_state(const flux_fsm_hsm_t* hsm);
+int flux_fsm_hsm_in_state(const flux_fsm_hsm_t* hsm, int state);
+const flux_fsm_t* flux_fsm_hsm_table(const flux_fsm_hsm_t* hsm);
+
+#endif /* FLUX_FSM_HAVE_HIERARCHICAL */
+
+#endif /* _FLUX_FSM_HIERARCHICAL_H_INCLUDED_ */
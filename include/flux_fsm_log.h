@@ -6,6 +6,7 @@
  #define _FLUX_FSM_LOG_H_INCLUDED_
  
  #include <stdarg.h>
+ #include <stdint.h>
  #include <stdio.h>
  
  /* Log levels */
@@ -18,31 +19,67 @@
  #define FLUX_FSM_LOG_INFO    6
  #define FLUX_FSM_LOG_DEBUG   7
  
+ /* Async overflow policy: what a caller does when its ring buffer is full */
+ #define FLUX_FSM_LOG_DROP    0
+ #define FLUX_FSM_LOG_BLOCK   1
+ 
+ typedef struct flux_fsm_log_async_s flux_fsm_log_async_t;
+ 
  /* Log configuration */
  typedef struct {
      FILE* file;           /* Log file handle */
      int level;            /* Current log level */
      int use_colors;       /* Enable colored output */
+     flux_fsm_log_async_t* async;  /* Background writer, NULL when synchronous */
  } flux_fsm_log_t;
  
  /* Log API */
  flux_fsm_log_t* flux_fsm_log_create(const char* filename, int level);
  void flux_fsm_log_destroy(flux_fsm_log_t* log);
  
+ /*
+  * Asynchronous mode: each calling thread formats into its own lock-free ring,
+  * a background thread batches records into large writes. Records from one
+  * thread keep their order; records from different threads may interleave.
+  * All writers must be done before flux_fsm_log_destroy.
+  */
+ flux_fsm_log_t* flux_fsm_log_create_async(const char* filename, int level, int policy);
+ void flux_fsm_log_flush(flux_fsm_log_t* log);
+ uint64_t flux_fsm_log_dropped(const flux_fsm_log_t* log);
+ 
  void flux_fsm_log_set_level(flux_fsm_log_t* log, int level);
  int flux_fsm_log_get_level(flux_fsm_log_t* log);
  
  void flux_fsm_log_write(flux_fsm_log_t* log, int level, const char* fmt, ...);
  void flux_fsm_log_write_va(flux_fsm_log_t* log, int level, const char* fmt, va_list args);
  
+ /*
+  * Compile-time threshold: calls less severe than FLUX_FSM_LOG_MIN_LEVEL
+  * (numerically greater) are constant-false and compile to nothing, e.g.
+  * -DFLUX_FSM_LOG_MIN_LEVEL=FLUX_FSM_LOG_INFO removes all debug logging.
+  */
+ #if !defined(FLUX_FSM_LOG_MIN_LEVEL)
+ #define FLUX_FSM_LOG_MIN_LEVEL  FLUX_FSM_LOG_DEBUG
+ #endif
+ 
+ /*
+  * The runtime level is checked inline, so filtered calls neither call
+  * flux_fsm_log_write nor evaluate their arguments. log is evaluated twice.
+  */
+ #define flux_fsm_log_at(log, lvl, ...)                                        \
+     do {                                                                      \
+         if ((lvl) <= FLUX_FSM_LOG_MIN_LEVEL && (log) && (lvl) <= (log)->level) \
+             flux_fsm_log_write((log), (lvl), __VA_ARGS__);                    \
+     } while (0)
+ 
  /* Helper macros */
- #define flux_fsm_log_emergency(log, ...) flux_fsm_log_write(log, FLUX_FSM_LOG_EMERG, __VA_ARGS__)
- #define flux_fsm_log_alert(log, ...)     flux_fsm_log_write(log, FLUX_FSM_LOG_ALERT, __VA_ARGS__)
- #define flux_fsm_log_critical(log, ...)  flux_fsm_log_write(log, FLUX_FSM_LOG_CRIT, __VA_ARGS__)
- #define flux_fsm_log_error(log, ...)     flux_fsm_log_write(log, FLUX_FSM_LOG_ERR, __VA_ARGS__)
- #define flux_fsm_log_warning(log, ...)   flux_fsm_log_write(log, FLUX_FSM_LOG_WARN, __VA_ARGS__)
- #define flux_fsm_log_notice(log, ...)    flux_fsm_log_write(log, FLUX_FSM_LOG_NOTICE, __VA_ARGS__)
- #define flux_fsm_log_info(log, ...)      flux_fsm_log_write(log, FLUX_FSM_LOG_INFO, __VA_ARGS__)
- #define flux_fsm_log_debug(log, ...)     flux_fsm_log_write(log, FLUX_FSM_LOG_DEBUG, __VA_ARGS__)
+ #define flux_fsm_log_emergency(log, ...) flux_fsm_log_at(log, FLUX_FSM_LOG_EMERG, __VA_ARGS__)
+ #define flux_fsm_log_alert(log, ...)     flux_fsm_log_at(log, FLUX_FSM_LOG_ALERT, __VA_ARGS__)
+ #define flux_fsm_log_critical(log, ...)  flux_fsm_log_at(log, FLUX_FSM_LOG_CRIT, __VA_ARGS__)
+ #define flux_fsm_log_error(log, ...)     flux_fsm_log_at(log, FLUX_FSM_LOG_ERR, __VA_ARGS__)
+ #define flux_fsm_log_warning(log, ...)   flux_fsm_log_at(log, FLUX_FSM_LOG_WARN, __VA_ARGS__)
+ #define flux_fsm_log_notice(log, ...)    flux_fsm_log_at(log, FLUX_FSM_LOG_NOTICE, __VA_ARGS__)
+ #define flux_fsm_log_info(log, ...)      flux_fsm_log_at(log, FLUX_FSM_LOG_INFO, __VA_ARGS__)
+ #define flux_fsm_log_debug(log, ...)     flux_fsm_log_at(log, FLUX_FSM_LOG_DEBUG, __VA_ARGS__)
  
  #endif /* _FLUX_FSM_LOG_H_INCLUDED_ */
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_PARALLEL_H_INCLUDED_
+#define _FLUX_FSM_PARALLEL_H_INCLUDED_
+
+#include "flux_fsm_core.h"
+
+#if defined(FLUX_FSM_HAVE_PARALLEL)
+
+/*
+ * 并行状态机：一组正交区域（各自独立的核心状态机）共同响应同一事件。
+ * 内部维护 事件 -> 可响应区域 的合并索引，一次调用只访问定义了该事件
+ * 转移的区域，其余区域不被触及。
+ */
+typedef struct flux_fsm_parallel_s flux_fsm_parallel_t;
+
+/*
+ * 冲突解决器：当前状态下有多个区域可响应 event 时调用。
+ * regions 为候选区域序号，按序号升序排列，可原地重排或筛选；
+ * 返回值 n 表示按 regions 中的顺序执行前 n 个区域的转移。
+ */
+typedef size_t (*flux_fsm_resolver_pt)(void* data, flux_fsm_event_t event,
+    size_t* regions, size_t n);
+
+flux_fsm_parallel_t* flux_fsm_parallel_create(flux_fsm_t* const* regions, size_t count);
+void flux_fsm_parallel_destroy(flux_fsm_parallel_t* par);
+flux_fsm_rc_t flux_fsm_parallel_rebuild(flux_fsm_parallel_t* par);
+void flux_fsm_parallel_set_resolver(flux_fsm_parallel_t* par, flux_fsm_resolver_pt resolver, void* data);
+flux_fsm_rc_t flux_fsm_parallel_process_event(flux_fsm_parallel_t* par, flux_fsm_event_t event,
+    size_t* fired);
+size_t flux_fsm_parallel_count(const flux_fsm_parallel_t* par);
+flux_fsm_t* flux_fsm_parallel_region(const flux_fsm_parallel_t* par, size_t i);
+
+#endif /* FLUX_FSM_HAVE_PARALLEL */
+
+#endif /* _FLUX_FSM_PARALLEL_H_INCLUDED_ */
@@ -7,6 +7,75 @@
 
 #include "flux_fsm_core.h"
 
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+#include <stdatomic.h>
+typedef atomic_uint_fast64_t flux_fsm_hist_count_t;
+#else
+typedef uint64_t flux_fsm_hist_count_t;
+#endif
+
+/*
+ * Log-linear latency histogram (nanoseconds): values below 2^(SUB_BITS+1)
+ * are exact, above that every power of two is split into 2^SUB_BITS
+ * buckets (relative error < 1/32); values from 2^MAX_BITS are clamped
+ */
+#define FLUX_FSM_HIST_SUB_BITS  5
+#define FLUX_FSM_HIST_MAX_BITS  36
+#define FLUX_FSM_HIST_BUCKETS   \
+    ((FLUX_FSM_HIST_MAX_BITS - FLUX_FSM_HIST_SUB_BITS + 1) << FLUX_FSM_HIST_SUB_BITS)
+
+/* Live histogram, recorded lock-free from any thread */
+typedef struct {
+    flux_fsm_hist_count_t sum;
+    flux_fsm_hist_count_t max;
+    flux_fsm_hist_count_t buckets[FLUX_FSM_HIST_BUCKETS];
+} flux_fsm_hist_t;
+
+/* Plain copy of a histogram; snapshots can be merged and queried */
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[FLUX_FSM_HIST_BUCKETS];
+} flux_fsm_hist_snapshot_t;
+
+/* Per-transition phase times, keyed by (from, event) */
+typedef struct {
+    flux_fsm_hist_count_t key;
+    flux_fsm_hist_count_t count;
+    flux_fsm_hist_count_t guard_failures;
+    flux_fsm_hist_count_t guard_ns;
+    flux_fsm_hist_count_t action_ns;
+    flux_fsm_hist_count_t handler_ns;
+} flux_fsm_perf_trans_t;
+
+typedef struct {
+    int from;
+    int event;
+    uint64_t count;
+    uint64_t guard_failures;
+    uint64_t guard_ns;
+    uint64_t action_ns;
+    uint64_t handler_ns;
+} flux_fsm_perf_breakdown_t;
+
+/*
+ * Streaming text writer over a caller-supplied buffer: when the buffer
+ * fills, write() drains it; without write() output is truncated and
+ * total keeps the full length
+ */
+typedef size_t (*flux_fsm_write_pt)(void* data, const char* buf, size_t len);
+
+typedef struct {
+    char* buf;
+    size_t size;
+    size_t len;
+    size_t total;
+    int error;
+    flux_fsm_write_pt write;
+    void* data;
+} flux_fsm_writer_t;
+
 /* Performance metrics */
 typedef struct {
     unsigned long transitions;
@@ -17,13 +86,56 @@ typedef struct {
     double total_time;
     double avg_transition_time;
     double max_transition_time;
+    unsigned long cache_hits;
+    unsigned long cache_misses;
+    flux_fsm_hist_t latency;
+    flux_fsm_hist_t guard_time;
+    flux_fsm_hist_t action_time;
+    flux_fsm_hist_t handler_time;
+    flux_fsm_perf_trans_t trans[FLUX_FSM_PERF_TRANSITIONS];
+    flux_fsm_hist_count_t trans_dropped;
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+    flux_fsm_phase_sink_t sink;
+#endif
 } flux_fsm_perf_t;
 
+/* Writer API */
+void flux_fsm_writer_init(flux_fsm_writer_t* w, char* buf, size_t size,
+    flux_fsm_write_pt write, void* data);
+void flux_fsm_writer_printf(flux_fsm_writer_t* w, const char* fmt, ...);
+flux_fsm_rc_t flux_fsm_writer_flush(flux_fsm_writer_t* w);
+
+/* Histogram API */
+void flux_fsm_hist_init(flux_fsm_hist_t* hist);
+void flux_fsm_hist_record(flux_fsm_hist_t* hist, uint64_t ns);
+void flux_fsm_hist_snapshot(const flux_fsm_hist_t* hist, flux_fsm_hist_snapshot_t* out);
+void flux_fsm_hist_merge(flux_fsm_hist_snapshot_t* dst, const flux_fsm_hist_snapshot_t* src);
+uint64_t flux_fsm_hist_percentile(const flux_fsm_hist_snapshot_t* snap, double percentile);
+
 /* Performance monitoring API */
 void flux_fsm_perf_init(flux_fsm_perf_t* perf);
 void flux_fsm_perf_reset(flux_fsm_perf_t* perf);
 void flux_fsm_perf_update(flux_fsm_perf_t* perf, double transition_time);
+void flux_fsm_perf_collect(flux_fsm_perf_t* perf, const flux_fsm_t* fsm);
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+void flux_fsm_perf_collect_counters(flux_fsm_perf_t* perf);
+void flux_fsm_perf_attach(flux_fsm_perf_t* perf);
+void flux_fsm_perf_detach(flux_fsm_perf_t* perf);
+#endif
+void flux_fsm_perf_record_phases(flux_fsm_perf_t* perf, int from, int event, flux_fsm_rc_t rc,
+    uint64_t guard_ns, uint64_t action_ns, uint64_t handler_ns);
+flux_fsm_rc_t flux_fsm_perf_transition(const flux_fsm_perf_t* perf, int from, int event,
+    flux_fsm_perf_breakdown_t* out);
 const char* flux_fsm_perf_to_json(const flux_fsm_perf_t* perf);
+size_t flux_fsm_perf_format_json(const flux_fsm_perf_t* perf, char* buf, size_t size);
+flux_fsm_rc_t flux_fsm_perf_write_json(const flux_fsm_perf_t* perf, flux_fsm_writer_t* w);
+flux_fsm_rc_t flux_fsm_perf_write_prometheus(const flux_fsm_perf_t* perf, flux_fsm_writer_t* w);
+flux_fsm_rc_t flux_fsm_perf_write_machines(const flux_fsm_t* const* fsms, size_t n,
+    flux_fsm_writer_t* w);
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+flux_fsm_rc_t flux_fsm_perf_write_ts(const flux_fsm_ts_t* const* ts, size_t n,
+    flux_fsm_writer_t* w);
+#endif
 void flux_fsm_perf_output(const flux_fsm_perf_t* perf);
 
 #endif /* FLUX_FSM_PERF_H_INCLUDED_ */
@@ -0,0 +1,25 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_QUEUE_H_INCLUDED_
+#define _FLUX_FSM_QUEUE_H_INCLUDED_
+
+#include "flux_fsm_core.h"
+
+/*
+ * 每台状态机可选的有界多生产者/单消费者事件队列。
+ * 任意线程可通过 flux_fsm_post_event 投递事件（无等待），
+ * 拥有状态机的线程调用 flux_fsm_drain 按投递顺序执行。
+ */
+
+flux_fsm_rc_t flux_fsm_queue_init(flux_fsm_t* fsm, size_t capacity);
+flux_fsm_rc_t flux_fsm_post_event(flux_fsm_t* fsm, flux_fsm_event_t event);
+size_t flux_fsm_drain(flux_fsm_t* fsm, size_t max);
+size_t flux_fsm_pending(const flux_fsm_t* fsm);
+
+/* 消费者所有权，供调度器在线程间移交状态机 */
+int flux_fsm_queue_acquire(flux_fsm_t* fsm);
+void flux_fsm_queue_release(flux_fsm_t* fsm);
+
+#endif /* _FLUX_FSM_QUEUE_H_INCLUDED_ */
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_TRACE_H_INCLUDED_
+#define _FLUX_FSM_TRACE_H_INCLUDED_
+
+#include <stdint.h>
+#include <stdio.h>
+#include "flux_fsm_core.h"
+
+/*
+ * 二进制转移追踪：每次执行转移（守卫、动作、处理器之后）向调用线程
+ * 自己的环形文件追加一条定长记录。文件以 MAP_SHARED 映射，进程崩溃后
+ * 已写入的记录仍保留在文件中，可由 flux_fsm_trace_decode 离线还原。
+ *
+ * 文件名为 <prefix>.<pid>.<n>.trace，n 为线程在本进程中的编号。
+ * 文件布局：flux_fsm_trace_header_t 之后紧接 capacity 条记录，
+ * 第 i 条记录（i 从 0 计）位于槽位 i % capacity，head 为已写入的总条数。
+ */
+
+#define FLUX_FSM_TRACE_MAGIC    "FLUXTRC"
+#define FLUX_FSM_TRACE_VERSION  1
+
+/* 解码输出格式 */
+#define FLUX_FSM_TRACE_TEXT  0
+#define FLUX_FSM_TRACE_JSON  1
+
+/**
+ * @struct flux_fsm_trace_record_t
+ * @brief 一次转移的追踪记录，32 字节
+ *
+ * @var ticks 时间戳，时钟周期数（x86 上为 TSC，否则为单调时钟纳秒）
+ * @var machine 状态机标识：trace_id，未设置时为结构体地址
+ * @var from 源状态
+ * @var event 事件
+ * @var to 目标状态
+ * @var rc 执行结果 flux_fsm_rc_t
+ */
+typedef struct {
+    uint64_t ticks;
+    uint64_t machine;
+    int32_t from;
+    int32_t event;
+    int32_t to;
+    int32_t rc;
+} flux_fsm_trace_record_t;
+
+/**
+ * @struct flux_fsm_trace_header_t
+ * @brief 追踪文件头，64 字节
+ *
+ * @var capacity 记录槽位数，2 的幂
+ * @var head 已写入的记录总数，超过 capacity 时最早的记录已被覆盖
+ * @var tick_base 打开文件时的时间戳
+ * @var ns_base tick_base 对应的墙钟时间（纪元起的纳秒）
+ * @var ns_per_tick 每个时钟周期的纳秒数
+ * @var thread 线程在本进程中的编号
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    uint64_t head;
+    uint64_t tick_base;
+    int64_t ns_base;
+    double ns_per_tick;
+    uint32_t pid;
+    uint32_t thread;
+} flux_fsm_trace_header_t;
+
+#if defined(FLUX_FSM_HAVE_TRACE)
+flux_fsm_rc_t flux_fsm_trace_start(const char* prefix, size_t records);
+void flux_fsm_trace_stop(void);
+int flux_fsm_trace_enabled(void);
+#endif
+
+/* 解码器，由 fsm_tools_trace 提供：按时间合并多个线程的文件并输出 */
+flux_fsm_rc_t flux_fsm_trace_decode(const char* const* files, size_t n, int format, FILE* out);
+
+#endif /* _FLUX_FSM_TRACE_H_INCLUDED_ */
@@ -21,6 +21,7 @@ typedef struct {
     const char* node_shape;    /* 节点形状 */
     const char* edge_style;    /* 边线样式 */
     const char* bgcolor;       /* 背景颜色 */
+    int heatmap;               /* 按剖析数据着色：边为转移命中，节点为停留时间 */
 } flux_fsm_viz_config_t;
 
 /* 验证结果结构体 */
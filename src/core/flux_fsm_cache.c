@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+void flux_fsm_cache_clear(flux_fsm_cache_t* cache) {
+    for (size_t i = 0; i <= cache->mask; i++) {
+        cache->entries[i].idx = -1;
+    }
+}
+
+/**
+ * @brief 启用热点转移缓存
+ * @param fsm 状态机实例指针
+ * @param slots 槽位数，向上取整为 2 的幂，0 表示 FLUX_FSM_CACHE_SLOTS
+ * @return 成功返回 FLUX_FSM_OK
+ * @note 直接映射：每个 (状态, 事件) 只对应一个槽位，命中时跳过索引与
+ *       线性查找；添加转移会递增版本号，使全部缓存项以 O(1) 失效。
+ *       重复调用按新的槽位数重建缓存，计数清零
+ */
+flux_fsm_rc_t flux_fsm_cache_enable(flux_fsm_t* fsm, size_t slots) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    if (slots == 0) {
+        slots = FLUX_FSM_CACHE_SLOTS;
+    }
+    if (slots > ((size_t)1 << 31)) {
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t n = 1;
+    while (n < slots) {
+        n <<= 1;
+    }
+
+    flux_fsm_cache_t* cache = flux_fsm_alloc(fsm->pool,
+        sizeof(flux_fsm_cache_t) + n * sizeof(flux_fsm_cache_entry_t));
+    if (!cache) {
+        return FLUX_FSM_ERROR;
+    }
+
+    cache->mask = (uint32_t)(n - 1);
+    atomic_init(&cache->hits, 0);
+    atomic_init(&cache->misses, 0);
+    flux_fsm_cache_clear(cache);
+
+    flux_fsm_cache_disable(fsm);
+    fsm->cache = cache;
+
+    return FLUX_FSM_OK;
+}
+
+void flux_fsm_cache_disable(flux_fsm_t* fsm) {
+    if (!fsm) {
+        return;
+    }
+
+    flux_fsm_free(fsm->pool, fsm->cache);
+    fsm->cache = NULL;
+}
+
+/**
+ * @brief 读取缓存命中与未命中次数
+ * @return 成功返回 FLUX_FSM_OK，未启用缓存返回 FLUX_FSM_ERROR
+ */
+flux_fsm_rc_t flux_fsm_cache_stats(const flux_fsm_t* fsm, uint64_t* hits, uint64_t* misses) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (!fsm->cache) {
+        return FLUX_FSM_ERROR;
+    }
+
+    if (hits) {
+        *hits = atomic_load_explicit(&fsm->cache->hits, memory_order_relaxed);
+    }
+    if (misses) {
+        *misses = atomic_load_explicit(&fsm->cache->misses, memory_order_relaxed);
+    }
+    return FLUX_FSM_OK;
+}
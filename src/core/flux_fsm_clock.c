@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <pthread.h>
+#include "flux_fsm_internal.h"
+
+/* TSC 校准时长（纳秒） */
+#define FLUX_FSM_CALIBRATE_NS  5000000
+
+static pthread_once_t flux_fsm_clock_once = PTHREAD_ONCE_INIT;
+static double flux_fsm_clock_ns_per_tick = 1.0;
+
+static int64_t flux_fsm_clock_ns(void) {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void flux_fsm_clock_calibrate(void) {
+#if defined(FLUX_FSM_HAVE_TSC)
+    int64_t n0 = flux_fsm_clock_ns();
+    uint64_t t0 = flux_fsm_ticks();
+    int64_t n1;
+    while ((n1 = flux_fsm_clock_ns()) - n0 < FLUX_FSM_CALIBRATE_NS) {
+        /* spin */
+    }
+    uint64_t t1 = flux_fsm_ticks();
+
+    if (t1 > t0) {
+        flux_fsm_clock_ns_per_tick = (double)(n1 - n0) / (double)(t1 - t0);
+    }
+#endif
+}
+
+/**
+ * @brief 返回 flux_fsm_ticks 的每周期纳秒数
+ * @note 首次调用时以单调时钟校准 TSC，其后为一次 pthread_once 检查；
+ *       非 TSC 平台上 ticks 即纳秒，恒为 1
+ */
+double flux_fsm_ns_per_tick(void) {
+    pthread_once(&flux_fsm_clock_once, flux_fsm_clock_calibrate);
+    return flux_fsm_clock_ns_per_tick;
+}
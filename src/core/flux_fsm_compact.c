@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+static int flux_fsm_compact_fits(const flux_fsm_transition_t* t) {
+    return (unsigned)t->from <= FLUX_FSM_COMPACT_MAX
+        && (unsigned)t->event <= FLUX_FSM_COMPACT_MAX
+        && (unsigned)t->to <= FLUX_FSM_COMPACT_MAX;
+}
+
+/**
+ * @brief 查找或登记 (守卫, 动作) 组合
+ * @return 回调编号，0 表示两者皆空，-1 表示旁表已满或分配失败
+ * @note 不同组合的数量通常很少，线性查找即可
+ */
+static int flux_fsm_callback_id(flux_fsm_t* fsm, int (*guard)(void*), void (*action)(void*)) {
+    if (!guard && !action) {
+        return 0;
+    }
+
+    for (size_t i = fsm->callback_count; i > 0; i--) {
+        if (fsm->callbacks[i - 1].guard == guard && fsm->callbacks[i - 1].action == action) {
+            return (int)i;
+        }
+    }
+
+    if (fsm->callback_count >= FLUX_FSM_COMPACT_MAX) {
+        return -1;
+    }
+
+    if (fsm->callback_count == fsm->callback_capacity) {
+        size_t cap = fsm->callback_capacity ? fsm->callback_capacity * 2 : 4;
+        flux_fsm_callbacks_t* cbs = flux_fsm_realloc(fsm->pool, fsm->callbacks,
+            fsm->callback_count * sizeof(flux_fsm_callbacks_t),
+            cap * sizeof(flux_fsm_callbacks_t));
+        if (!cbs) {
+            return -1;
+        }
+        fsm->callbacks = cbs;
+        fsm->callback_capacity = cap;
+    }
+
+    fsm->callbacks[fsm->callback_count].guard = guard;
+    fsm->callbacks[fsm->callback_count].action = action;
+    fsm->callback_count++;
+
+    return (int)fsm->callback_count;
+}
+
+/**
+ * @brief 将转移编码为紧凑行
+ * @param fsm 持有回调旁表的状态机
+ * @param rows 输出位置，容量已预留
+ * @param trans 转移数组
+ * @param n 转移数量
+ * @return 成功返回 FLUX_FSM_OK，取值超出 16 位或旁表已满返回 FLUX_FSM_ERROR
+ * @note 不修改 transition_count；失败时旁表中可能多出未被引用的项
+ */
+flux_fsm_rc_t flux_fsm_compact_encode(flux_fsm_t* fsm, flux_fsm_compact_t* rows,
+    const flux_fsm_transition_t* trans, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (!flux_fsm_compact_fits(&trans[i])) {
+            return FLUX_FSM_ERROR;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        int cb = flux_fsm_callback_id(fsm, trans[i].guard, trans[i].action);
+        if (cb < 0) {
+            return FLUX_FSM_ERROR;
+        }
+
+        rows[i].from = (uint16_t)trans[i].from;
+        rows[i].event = (uint16_t)trans[i].event;
+        rows[i].to = (uint16_t)trans[i].to;
+        rows[i].cb = (uint16_t)cb;
+    }
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 将转移表转为紧凑存储
+ * @param fsm 状态机实例指针
+ * @return 成功返回 FLUX_FSM_OK，状态或事件超出 [0, 65535] 返回 FLUX_FSM_ERROR，
+ *         失败时状态机保持不变
+ * @note 每条转移压缩为 8 字节，守卫与动作移入按组合去重的旁表；
+ *       转移顺序与序号不变，已有索引继续有效。转换后仍可添加转移，
+ *       但新转移同样须满足 16 位取值范围
+ */
+flux_fsm_rc_t flux_fsm_compact(flux_fsm_t* fsm) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (fsm->compact) {
+        return FLUX_FSM_OK;
+    }
+
+    size_t cap = fsm->transition_count;
+    flux_fsm_compact_t* rows = flux_fsm_alloc(fsm->pool, (cap ? cap : 1) * sizeof(flux_fsm_compact_t));
+    if (!rows) {
+        return FLUX_FSM_ERROR;
+    }
+
+    if (flux_fsm_compact_encode(fsm, rows, fsm->transitions, fsm->transition_count) != FLUX_FSM_OK) {
+        flux_fsm_free(fsm->pool, rows);
+        flux_fsm_free(fsm->pool, fsm->callbacks);
+        fsm->callbacks = NULL;
+        fsm->callback_count = 0;
+        fsm->callback_capacity = 0;
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_free(fsm->pool, fsm->transitions);
+    fsm->transitions = NULL;
+    fsm->compact = rows;
+    fsm->transition_capacity = cap;
+
+    return FLUX_FSM_OK;
+}
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
 
 /**
  * @brief 创建有限状态机实例
@@ -23,15 +24,35 @@ flux_fsm_t* flux_fsm_create(int init_state, void* ctx) {
     fsm->context = ctx;
     fsm->transitions = NULL;
     fsm->transition_count = 0;
+    fsm->transition_capacity = 0;
     fsm->handlers = NULL;
     fsm->handler_count = 0;
+    fsm->handler_capacity = 0;
     fsm->state_count = 0;
+    fsm->index = NULL;
+    fsm->sealed = 0;
+    fsm->pool = NULL;
+    fsm->queue = NULL;
+    fsm->compact = NULL;
+    fsm->callbacks = NULL;
+    fsm->callback_count = 0;
+    fsm->callback_capacity = 0;
+    fsm->scan_keys = NULL;
+    fsm->event_masks = NULL;
+    fsm->event_mask_capacity = 0;
+    fsm->version = 0;
+    fsm->trace_id = 0;
+    fsm->cache = NULL;
+    fsm->profile = NULL;
 
     return fsm;
 }
 
-void flux_fsm_destroy(flux_fsm_t* fsm) {
-    if (!fsm) {
+/**
+ * @brief 释放状态机持有的转移表、处理器与索引，不释放结构体本身
+ */
+void flux_fsm_fini(flux_fsm_t* fsm) {
+    if (fsm->pool) {
         return;
     }
 
@@ -41,23 +62,118 @@ void flux_fsm_destroy(flux_fsm_t* fsm) {
     if (fsm->handlers) {
         free(fsm->handlers);
     }
+    free(fsm->compact);
+    free(fsm->callbacks);
+    free(fsm->scan_keys);
+    free(fsm->event_masks);
+    free(fsm->cache);
+    flux_fsm_profile_disable(fsm);
+    flux_fsm_index_free(fsm->index, NULL);
+    flux_fsm_queue_free(fsm);
+}
+
+void flux_fsm_destroy(flux_fsm_t* fsm) {
+    if (!fsm || fsm->pool) {
+        return;
+    }
+
+    flux_fsm_fini(fsm);
     free(fsm);
 }
 
+/**
+ * @brief 封存状态机，编译 (状态, 事件) 分派索引
+ * @param fsm 状态机实例指针
+ * @return 成功返回 FLUX_FSM_OK
+ * @note 封存后仍可添加转移，索引会在下一次查找时自动重建；
+ *       从未封存的状态机保持线性查找
+ */
+flux_fsm_rc_t flux_fsm_seal(flux_fsm_t* fsm) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_index_t* index = flux_fsm_index_build(fsm);
+    if (!index) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_index_free(fsm->index, fsm->pool);
+    fsm->index = index;
+    fsm->sealed = 1;
+
+    return FLUX_FSM_OK;
+}
+
 /**
  * @brief 查找匹配的状态转移
  * @param fsm 状态机实例指针
  * @param event 触发事件
  * @return 成功返回转移索引，未找到返回-1
+ * @note 先以事件位图排除当前状态下不可能存在的事件，再查热点缓存；
+ *       已封存的状态机走 O(1) 索引，否则线性扫描
  */
 int flux_fsm_find_transition(flux_fsm_t* fsm, int event) {
-    for (size_t i = 0; i < fsm->transition_count; i++) {
-        if (fsm->transitions[i].from == fsm->current_state &&
-            fsm->transitions[i].event == event) {
-            return i;
+    if (flux_fsm_event_rejected(fsm, fsm->current_state, event)) {
+        return -1;
+    }
+
+    flux_fsm_cache_entry_t* slot = NULL;
+    if (fsm->cache) {
+        slot = flux_fsm_cache_slot(fsm->cache, fsm->current_state, event);
+        if (slot->idx >= 0 && slot->version == fsm->version &&
+            slot->state == fsm->current_state && slot->event == event) {
+            flux_fsm_cache_count(&fsm->cache->hits);
+            return slot->idx;
         }
+        flux_fsm_cache_count(&fsm->cache->misses);
+    }
+
+    if (fsm->sealed && fsm->current_state >= 0 && !fsm->index) {
+        fsm->index = flux_fsm_index_build(fsm);
     }
-    return -1;
+
+    int trans_idx = fsm->sealed && fsm->current_state >= 0 && fsm->index
+        ? flux_fsm_index_lookup(fsm->index, fsm->current_state, event)
+        : flux_fsm_scan(fsm, fsm->current_state, event);
+
+    if (slot && trans_idx >= 0) {
+        slot->state = fsm->current_state;
+        slot->event = event;
+        slot->idx = trans_idx;
+        slot->version = fsm->version;
+    }
+
+    return trans_idx;
+}
+
+/* 执行第 trans_idx 条转移，剖析启用时记录转移命中与源状态停留时间 */
+static inline flux_fsm_rc_t flux_fsm_run(flux_fsm_t* fsm, size_t trans_idx) {
+    int from = fsm->current_state;
+    flux_fsm_rc_t rc = flux_fsm_apply_at(fsm, trans_idx, fsm->context, &fsm->current_state,
+        flux_fsm_trace_machine(fsm));
+
+    if (fsm->profile && rc == FLUX_FSM_OK) {
+        flux_fsm_profile_hit(fsm, trans_idx, from);
+    }
+    return rc;
+}
+
+/* 已校验参数后的单事件分派路径 */
+static inline flux_fsm_rc_t flux_fsm_dispatch_event(flux_fsm_t* fsm, flux_fsm_event_t event) {
+    int trans_idx = flux_fsm_find_transition(fsm, event);
+    if (trans_idx < 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return flux_fsm_run(fsm, (size_t)trans_idx);
+}
+
+static inline flux_fsm_rc_t flux_fsm_dispatch(flux_fsm_t* fsm, flux_fsm_event_t event) {
+    flux_fsm_rc_t rc;
+
+    flux_fsm_count(rc, flux_fsm_dispatch_event(fsm, event));
+    return rc;
 }
 
 /**
@@ -72,52 +188,330 @@ flux_fsm_rc_t flux_fsm_process_event(flux_fsm_t* fsm, flux_fsm_event_t event) {
         return FLUX_FSM_INVALID_EVENT;
     }
 
-    int trans_idx = flux_fsm_find_transition(fsm, event);
-    if (trans_idx < 0) {
-        return FLUX_FSM_ERROR;
+    return flux_fsm_dispatch(fsm, event);
+}
+
+/**
+ * @brief 批量处理同一状态机的事件序列
+ * @param fsm 状态机实例指针
+ * @param events 事件数组
+ * @param n 事件数量
+ * @param results 每个事件的处理结果，可为 NULL
+ * @return 全部成功返回 FLUX_FSM_OK，否则返回第一个失败事件的结果
+ * @note 失败的事件不会中断后续事件的处理，与逐个调用 process_event 等价
+ */
+flux_fsm_rc_t flux_fsm_process_events(flux_fsm_t* fsm, const flux_fsm_event_t* events,
+    size_t n, flux_fsm_rc_t* results)
+{
+    if (!fsm || (!events && n)) {
+        return FLUX_FSM_INVALID_EVENT;
     }
 
-    return flux_fsm_exec_transition(fsm, trans_idx);
+    flux_fsm_rc_t first = FLUX_FSM_OK;
+    for (size_t i = 0; i < n; i++) {
+        flux_fsm_rc_t rc = flux_fsm_dispatch(fsm, events[i]);
+        if (results) {
+            results[i] = rc;
+        }
+        if (rc != FLUX_FSM_OK && first == FLUX_FSM_OK) {
+            first = rc;
+        }
+    }
+
+    return first;
+}
+
+/*
+ * 预取距离：状态机结构体提前 2D 个，事件位图与索引行提前 D 个，
+ * 此时行已在缓存中，再提前 D/2 个预取查找实际读取的槽位或有序段
+ */
+#define FLUX_FSM_PREFETCH_DISTANCE  8
+
+static inline void flux_fsm_prefetch_row(const flux_fsm_t* fsm) {
+    int state = fsm->current_state;
+
+    if ((size_t)(unsigned)state < fsm->event_mask_capacity) {
+        flux_fsm_prefetch(&fsm->event_masks[state]);
+    }
+    if (fsm->index && (uint32_t)state < fsm->index->row_count) {
+        flux_fsm_prefetch(&fsm->index->rows[state]);
+    }
+}
+
+/* 未封存的状态机线性扫描整张表，不做预取 */
+static inline void flux_fsm_prefetch_slot(const flux_fsm_t* fsm, int event) {
+    const flux_fsm_index_t* index = fsm->index;
+    int state = fsm->current_state;
+
+    if (!index || (uint32_t)state >= index->row_count) {
+        return;
+    }
+
+    const flux_fsm_index_row_t* row = &index->rows[state];
+    if (row->span) {
+        uint32_t off = (uint32_t)event - (uint32_t)row->ev_min;
+        if (off < row->span) {
+            flux_fsm_prefetch(&index->slots[row->slot + off]);
+        }
+    } else if (row->count) {
+        flux_fsm_prefetch(&index->keys[row->first]);
+        flux_fsm_prefetch(&index->entries[row->first]);
+    }
+}
+
+/**
+ * @brief 一次推进多台互相独立的状态机
+ * @param fsms 状态机数组，fsms[i] 处理 events[i]
+ * @param events 事件数组
+ * @param n 数量
+ * @param results 每个事件的处理结果，可为 NULL
+ * @return 全部成功返回 FLUX_FSM_OK，否则返回第一个失败事件的结果
+ * @note 同一状态机可多次出现，事件按数组顺序生效；
+ *       处理第 i 个时分级预取后续状态机的结构体、事件位图与索引行，
+ *       以及查找将读取的稠密槽位或有序段
+ */
+flux_fsm_rc_t flux_fsm_process_events_multi(flux_fsm_t* const* fsms, const flux_fsm_event_t* events,
+    size_t n, flux_fsm_rc_t* results)
+{
+    if ((!fsms || !events) && n) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    for (size_t i = 0; i < n && i < FLUX_FSM_PREFETCH_DISTANCE * 2; i++) {
+        if (fsms[i]) {
+            flux_fsm_prefetch(fsms[i]);
+        }
+    }
+
+    flux_fsm_rc_t first = FLUX_FSM_OK;
+    for (size_t i = 0; i < n; i++) {
+        if (i + FLUX_FSM_PREFETCH_DISTANCE * 2 < n && fsms[i + FLUX_FSM_PREFETCH_DISTANCE * 2]) {
+            flux_fsm_prefetch(fsms[i + FLUX_FSM_PREFETCH_DISTANCE * 2]);
+        }
+        if (i + FLUX_FSM_PREFETCH_DISTANCE < n && fsms[i + FLUX_FSM_PREFETCH_DISTANCE]) {
+            flux_fsm_prefetch_row(fsms[i + FLUX_FSM_PREFETCH_DISTANCE]);
+        }
+        if (i + FLUX_FSM_PREFETCH_DISTANCE / 2 < n && fsms[i + FLUX_FSM_PREFETCH_DISTANCE / 2]) {
+            flux_fsm_prefetch_slot(fsms[i + FLUX_FSM_PREFETCH_DISTANCE / 2],
+                                   events[i + FLUX_FSM_PREFETCH_DISTANCE / 2]);
+        }
+
+        flux_fsm_rc_t rc = fsms[i] ? flux_fsm_dispatch(fsms[i], events[i]) : FLUX_FSM_INVALID_EVENT;
+        if (results) {
+            results[i] = rc;
+        }
+        if (rc != FLUX_FSM_OK && first == FLUX_FSM_OK) {
+            first = rc;
+        }
+    }
+
+    return first;
 }
 
 flux_fsm_rc_t flux_fsm_exec_transition(flux_fsm_t* fsm, int trans_idx) {
-    flux_fsm_transition_t* trans = &fsm->transitions[trans_idx];
+    flux_fsm_rc_t rc;
 
-    /* Check guard condition */
-    if (trans->guard && !trans->guard(fsm->context)) {
-        return FLUX_FSM_GUARD_FAIL;
+    flux_fsm_count(rc, flux_fsm_run(fsm, (size_t)trans_idx));
+    return rc;
+}
+
+/* 几何增长的最小初始容量 */
+#define FLUX_FSM_MIN_CAPACITY  8
+
+static size_t flux_fsm_grow_capacity(size_t capacity, size_t need) {
+    size_t n = capacity ? capacity : FLUX_FSM_MIN_CAPACITY;
+    while (n < need) {
+        n *= 2;
     }
+    return n;
+}
 
-    /* Execute transition action */
-    if (trans->action) {
-        trans->action(fsm->context);
+static flux_fsm_rc_t flux_fsm_reserve_transitions(flux_fsm_t* fsm, size_t need) {
+    if (need <= fsm->transition_capacity) {
+        return FLUX_FSM_OK;
     }
 
-    /* Execute state handler */
-    if (fsm->handlers && fsm->handlers[fsm->current_state]) {
-        fsm->handlers[fsm->current_state](fsm->context, trans->event);
+    size_t cap = flux_fsm_grow_capacity(fsm->transition_capacity, need);
+
+    /* 键列先行扩容，其容量始终不小于 transition_capacity */
+    uint32_t* new_keys = flux_fsm_realloc(fsm->pool, fsm->scan_keys,
+        fsm->transition_count * sizeof(uint32_t), cap * sizeof(uint32_t));
+    if (!new_keys) {
+        return FLUX_FSM_ERROR;
     }
+    fsm->scan_keys = new_keys;
 
-    /* Update state */
-    fsm->current_state = trans->to;
+    if (fsm->compact) {
+        flux_fsm_compact_t* new_rows = flux_fsm_realloc(fsm->pool, fsm->compact,
+            fsm->transition_count * sizeof(flux_fsm_compact_t),
+            cap * sizeof(flux_fsm_compact_t));
+        if (!new_rows) {
+            return FLUX_FSM_ERROR;
+        }
+
+        fsm->compact = new_rows;
+        fsm->transition_capacity = cap;
+        return FLUX_FSM_OK;
+    }
+
+    flux_fsm_transition_t* new_trans = flux_fsm_realloc(fsm->pool, fsm->transitions,
+        fsm->transition_count * sizeof(flux_fsm_transition_t),
+        cap * sizeof(flux_fsm_transition_t));
+    if (!new_trans) {
+        return FLUX_FSM_ERROR;
+    }
+
+    fsm->transitions = new_trans;
+    fsm->transition_capacity = cap;
     return FLUX_FSM_OK;
 }
 
+static flux_fsm_rc_t flux_fsm_reserve_handlers(flux_fsm_t* fsm, size_t need) {
+    if (need <= fsm->handler_capacity) {
+        return FLUX_FSM_OK;
+    }
+
+    size_t cap = flux_fsm_grow_capacity(fsm->handler_capacity, need);
+    flux_fsm_state_handler_t* new_handlers = flux_fsm_realloc(fsm->pool, fsm->handlers,
+        fsm->handler_count * sizeof(flux_fsm_state_handler_t),
+        cap * sizeof(flux_fsm_state_handler_t));
+    if (!new_handlers) {
+        return FLUX_FSM_ERROR;
+    }
+
+    /* Initialize new handlers to NULL */
+    memset(new_handlers + fsm->handler_count, 0,
+           (cap - fsm->handler_count) * sizeof(flux_fsm_state_handler_t));
+
+    fsm->handlers = new_handlers;
+    fsm->handler_capacity = cap;
+    return FLUX_FSM_OK;
+}
+
+/* 保证位图覆盖状态 [0, need)，新增部分清零；超过上限的状态不建位图 */
+static flux_fsm_rc_t flux_fsm_reserve_event_masks(flux_fsm_t* fsm, size_t need) {
+    if (need > FLUX_FSM_EVENT_MASK_STATES) {
+        need = FLUX_FSM_EVENT_MASK_STATES;
+    }
+    if (need <= fsm->event_mask_capacity) {
+        return FLUX_FSM_OK;
+    }
+
+    size_t cap = flux_fsm_grow_capacity(fsm->event_mask_capacity, need);
+    if (cap > FLUX_FSM_EVENT_MASK_STATES) {
+        cap = FLUX_FSM_EVENT_MASK_STATES;
+    }
+    uint64_t* new_masks = flux_fsm_realloc(fsm->pool, fsm->event_masks,
+        fsm->event_mask_capacity * sizeof(uint64_t), cap * sizeof(uint64_t));
+    if (!new_masks) {
+        return FLUX_FSM_ERROR;
+    }
+
+    memset(new_masks + fsm->event_mask_capacity, 0,
+           (cap - fsm->event_mask_capacity) * sizeof(uint64_t));
+
+    fsm->event_masks = new_masks;
+    fsm->event_mask_capacity = cap;
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 预留转移表与处理器表容量
+ * @param fsm 状态机实例指针
+ * @param transitions 转移总数下限
+ * @param states 处理器表（状态数）下限
+ * @return 成功返回 FLUX_FSM_OK
+ */
+flux_fsm_rc_t flux_fsm_reserve(flux_fsm_t* fsm, size_t transitions, size_t states) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    if (flux_fsm_reserve_transitions(fsm, transitions) != FLUX_FSM_OK ||
+        flux_fsm_reserve_handlers(fsm, states) != FLUX_FSM_OK) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return FLUX_FSM_OK;
+}
+
+/* 全局转移表代数，任一状态机添加转移时递增 */
+static atomic_uint flux_fsm_generation_counter;
+
+/**
+ * @brief 读取全局转移表代数
+ * @return 任一状态机每次添加转移后递增的计数
+ * @note 聚合多台状态机的模块只需比较这一个字，变化后再逐台比较 version
+ */
+uint32_t flux_fsm_generation(void) {
+    return atomic_load_explicit(&flux_fsm_generation_counter, memory_order_relaxed);
+}
+
 flux_fsm_rc_t flux_fsm_add_transition(flux_fsm_t* fsm, const flux_fsm_transition_t* trans) {
-    if (!fsm || !trans) {
+    return flux_fsm_add_transitions(fsm, trans, 1);
+}
+
+/**
+ * @brief 批量添加状态转移
+ * @param fsm 状态机实例指针
+ * @param trans 转移数组
+ * @param n 转移数量
+ * @return 成功返回 FLUX_FSM_OK，失败时状态机保持不变
+ * @note 容量按几何级数增长，加载 N 条转移为线性时间
+ */
+flux_fsm_rc_t flux_fsm_add_transitions(flux_fsm_t* fsm, const flux_fsm_transition_t* trans, size_t n) {
+    if (!fsm || (!trans && n)) {
         return FLUX_FSM_INVALID_EVENT;
     }
 
-    flux_fsm_transition_t* new_trans = realloc(fsm->transitions,
-        (fsm->transition_count + 1) * sizeof(flux_fsm_transition_t));
-    if (!new_trans) {
+    size_t mask_need = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (trans[i].from >= 0 && (size_t)trans[i].from >= mask_need) {
+            mask_need = (size_t)trans[i].from + 1;
+        }
+    }
+
+    if (flux_fsm_reserve_transitions(fsm, fsm->transition_count + n) != FLUX_FSM_OK ||
+        flux_fsm_reserve_event_masks(fsm, mask_need) != FLUX_FSM_OK) {
         return FLUX_FSM_ERROR;
     }
 
-    fsm->transitions = new_trans;
-    memcpy(&fsm->transitions[fsm->transition_count], trans,
-           sizeof(flux_fsm_transition_t));
-    fsm->transition_count++;
+    if (fsm->compact) {
+        if (flux_fsm_compact_encode(fsm, fsm->compact + fsm->transition_count, trans, n) != FLUX_FSM_OK) {
+            return FLUX_FSM_ERROR;
+        }
+    } else {
+        memcpy(&fsm->transitions[fsm->transition_count], trans,
+               n * sizeof(flux_fsm_transition_t));
+    }
+    for (size_t i = 0; i < n; i++) {
+        fsm->scan_keys[fsm->transition_count + i] = flux_fsm_scan_key(trans[i].from, trans[i].event);
+        if ((size_t)(unsigned)trans[i].from < fsm->event_mask_capacity) {
+            fsm->event_masks[trans[i].from] |= (uint64_t)1 << ((unsigned)trans[i].event & 63);
+        }
+    }
+    fsm->transition_count += n;
+
+    for (size_t i = 0; i < n; i++) {
+        if (trans[i].from >= 0 && (size_t)trans[i].from >= fsm->state_count) {
+            fsm->state_count = (size_t)trans[i].from + 1;
+        }
+        if (trans[i].to >= 0 && (size_t)trans[i].to >= fsm->state_count) {
+            fsm->state_count = (size_t)trans[i].to + 1;
+        }
+    }
+
+    /* 缓存项随版本号整体失效；回绕到 0 时清空，避免旧版本项被误认 */
+    if (++fsm->version == 0 && fsm->cache) {
+        flux_fsm_cache_clear(fsm->cache);
+    }
+    atomic_fetch_add_explicit(&flux_fsm_generation_counter, 1, memory_order_relaxed);
+
+    /* 已封存的索引失效，下次查找时重建 */
+    if (fsm->index) {
+        flux_fsm_index_free(fsm->index, fsm->pool);
+        fsm->index = NULL;
+    }
 
     return FLUX_FSM_OK;
 }
@@ -126,20 +520,15 @@ flux_fsm_rc_t flux_fsm_add_handler(flux_fsm_t* fsm, int state, flux_fsm_state_ha
     if (!fsm || !handler) {
         return FLUX_FSM_INVALID_EVENT;
     }
+    if (state < 0) {
+        return FLUX_FSM_INVALID_STATE;
+    }
 
     if ((size_t)state >= fsm->handler_count) {
-        flux_fsm_state_handler_t* new_handlers = realloc(fsm->handlers,
-            (state + 1) * sizeof(flux_fsm_state_handler_t));
-        if (!new_handlers) {
+        if (flux_fsm_reserve_handlers(fsm, (size_t)state + 1) != FLUX_FSM_OK) {
             return FLUX_FSM_ERROR;
         }
-
-        /* Initialize new handlers to NULL */
-        memset(new_handlers + fsm->handler_count, 0,
-               (state + 1 - fsm->handler_count) * sizeof(flux_fsm_state_handler_t));
-
-        fsm->handlers = new_handlers;
-        fsm->handler_count = state + 1;
+        fsm->handler_count = (size_t)state + 1;
     }
 
     fsm->handlers[state] = handler;
@@ -147,5 +536,54 @@ flux_fsm_rc_t flux_fsm_add_handler(flux_fsm_t* fsm, int state, flux_fsm_state_ha
 }
 
 int flux_fsm_get_state(const flux_fsm_t* fsm) {
-    return fsm ? fsm->current_state : FLUX_FSM_INVALID_EVENT;
+    return fsm ? flux_fsm_state_load(&fsm->current_state) : FLUX_FSM_INVALID_EVENT;
+}
+
+/**
+ * @brief 在转移之外直接设置当前状态（如层次状态机的扁平分发、外部恢复）
+ * @param fsm 状态机实例指针
+ * @param state 新的当前状态
+ * @return 成功返回 FLUX_FSM_OK
+ * @note 不执行守卫、动作与处理器。启用剖析时，原状态截至此刻的停留计入其
+ *       停留时间，新状态从此刻开始计时；不计转移命中
+ */
+flux_fsm_rc_t flux_fsm_set_state(flux_fsm_t* fsm, int state) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_profile_t* p = fsm->profile;
+    if (p) {
+        uint64_t now = flux_fsm_ticks();
+        int from = fsm->current_state;
+        if (from >= 0 && ((size_t)from < p->state_capacity ||
+                          flux_fsm_profile_grow(fsm, 0, (size_t)from) == FLUX_FSM_OK)) {
+            p->dwell[from] += now - p->entered;
+        }
+        p->entered = now;
+    }
+
+    flux_fsm_state_store(&fsm->current_state, state);
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 读取第 i 条转移，与存储模式无关
+ * @param fsm 状态机实例指针
+ * @param i 转移序号
+ * @param out 输出转移
+ * @return 成功返回 FLUX_FSM_OK，越界返回 FLUX_FSM_ERROR
+ * @note 工具代码应通过此接口遍历转移表，而不是直接访问 transitions
+ */
+flux_fsm_rc_t flux_fsm_get_transition(const flux_fsm_t* fsm, size_t i, flux_fsm_transition_t* out) {
+    if (!fsm || !out) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (i >= fsm->transition_count) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_transition_t tmp;
+    *out = *flux_fsm_transition_at(fsm, i, &tmp);
+    return FLUX_FSM_OK;
 }
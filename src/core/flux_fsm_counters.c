@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <pthread.h>
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+
+#define FLUX_FSM_COUNTER_LINE  64
+
+/**
+ * @struct flux_fsm_counter_slot_t
+ * @brief 单个线程的计数器，独占缓存行
+ *
+ * 只有所属线程写入计数字段，因此以宽松的读后写代替原子加法；
+ * 合并线程以宽松读取得到近似一致的快照。
+ *
+ * @var epoch 计数所属的重置代数，与全局代数不一致时所属线程先清零
+ * @var in_use 是否被线程持有，线程退出后计数并入 retired 并可被复用
+ * @var next 全部槽位的链表，只在 flux_fsm_counters_lock 下修改
+ */
+typedef struct flux_fsm_counter_slot_s flux_fsm_counter_slot_t;
+
+struct flux_fsm_counter_slot_s {
+    _Alignas(FLUX_FSM_COUNTER_LINE) atomic_uint_fast64_t events;
+    atomic_uint_fast64_t transitions;
+    atomic_uint_fast64_t guard_failures;
+    atomic_uint_fast64_t invalid_events;
+    atomic_uint_fast64_t invalid_states;
+    atomic_uint_fast64_t ticks;
+    atomic_uint_fast64_t max_ticks;
+    atomic_uint epoch;
+    int in_use;
+    flux_fsm_counter_slot_t* next;
+};
+
+atomic_int flux_fsm_counters_on;
+const flux_fsm_phase_sink_t* _Atomic flux_fsm_phase_sink;
+
+static pthread_mutex_t flux_fsm_counters_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t flux_fsm_counters_once = PTHREAD_ONCE_INIT;
+static pthread_key_t flux_fsm_counters_key;
+static flux_fsm_counter_slot_t* flux_fsm_counters_slots;
+static atomic_uint flux_fsm_counters_epoch;
+
+/* 已退出线程在当前代数内的累计值（以 ticks 计时），受锁保护 */
+static flux_fsm_counters_t flux_fsm_counters_retired;
+
+static FLUX_FSM_TLS flux_fsm_counter_slot_t* flux_fsm_counters_slot;
+
+static inline uint64_t flux_fsm_counter_get(atomic_uint_fast64_t* c) {
+    return atomic_load_explicit(c, memory_order_relaxed);
+}
+
+static inline void flux_fsm_counter_set(atomic_uint_fast64_t* c, uint64_t v) {
+    atomic_store_explicit(c, v, memory_order_relaxed);
+}
+
+static inline void flux_fsm_counter_inc(atomic_uint_fast64_t* c, uint64_t v) {
+    flux_fsm_counter_set(c, flux_fsm_counter_get(c) + v);
+}
+
+static void flux_fsm_counter_clear(flux_fsm_counter_slot_t* slot) {
+    flux_fsm_counter_set(&slot->events, 0);
+    flux_fsm_counter_set(&slot->transitions, 0);
+    flux_fsm_counter_set(&slot->guard_failures, 0);
+    flux_fsm_counter_set(&slot->invalid_events, 0);
+    flux_fsm_counter_set(&slot->invalid_states, 0);
+    flux_fsm_counter_set(&slot->ticks, 0);
+    flux_fsm_counter_set(&slot->max_ticks, 0);
+}
+
+/* 将槽位中属于 epoch 的计数并入 out（以 ticks 计时） */
+static void flux_fsm_counter_merge(flux_fsm_counters_t* out, flux_fsm_counter_slot_t* slot, unsigned epoch) {
+    if (atomic_load_explicit(&slot->epoch, memory_order_acquire) != epoch) {
+        return;
+    }
+
+    out->events += flux_fsm_counter_get(&slot->events);
+    out->transitions += flux_fsm_counter_get(&slot->transitions);
+    out->guard_failures += flux_fsm_counter_get(&slot->guard_failures);
+    out->invalid_events += flux_fsm_counter_get(&slot->invalid_events);
+    out->invalid_states += flux_fsm_counter_get(&slot->invalid_states);
+    out->total_ns += flux_fsm_counter_get(&slot->ticks);
+
+    uint64_t max = flux_fsm_counter_get(&slot->max_ticks);
+    if (max > out->max_ns) {
+        out->max_ns = max;
+    }
+}
+
+/* 线程退出：计数并入 retired，槽位留给后续线程 */
+static void flux_fsm_counters_thread_exit(void* data) {
+    flux_fsm_counter_slot_t* slot = data;
+
+    pthread_mutex_lock(&flux_fsm_counters_lock);
+    flux_fsm_counter_merge(&flux_fsm_counters_retired, slot,
+        atomic_load_explicit(&flux_fsm_counters_epoch, memory_order_relaxed));
+    flux_fsm_counter_clear(slot);
+    slot->in_use = 0;
+    pthread_mutex_unlock(&flux_fsm_counters_lock);
+}
+
+static void flux_fsm_counters_init_once(void) {
+    pthread_key_create(&flux_fsm_counters_key, flux_fsm_counters_thread_exit);
+    flux_fsm_ns_per_tick();
+}
+
+static flux_fsm_counter_slot_t* flux_fsm_counters_acquire(void) {
+    flux_fsm_counter_slot_t* slot;
+
+    pthread_once(&flux_fsm_counters_once, flux_fsm_counters_init_once);
+    pthread_mutex_lock(&flux_fsm_counters_lock);
+
+    for (slot = flux_fsm_counters_slots; slot; slot = slot->next) {
+        if (!slot->in_use) {
+            break;
+        }
+    }
+
+    if (!slot) {
+        slot = aligned_alloc(FLUX_FSM_COUNTER_LINE, sizeof(flux_fsm_counter_slot_t));
+        if (slot) {
+            memset(slot, 0, sizeof(flux_fsm_counter_slot_t));
+            slot->next = flux_fsm_counters_slots;
+            flux_fsm_counters_slots = slot;
+        }
+    }
+
+    if (slot) {
+        slot->in_use = 1;
+        flux_fsm_counter_clear(slot);
+        atomic_store_explicit(&slot->epoch,
+            atomic_load_explicit(&flux_fsm_counters_epoch, memory_order_relaxed), memory_order_release);
+    }
+
+    pthread_mutex_unlock(&flux_fsm_counters_lock);
+
+    if (slot) {
+        pthread_setspecific(flux_fsm_counters_key, slot);
+        flux_fsm_counters_slot = slot;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief 累加一次事件处理的结果与耗时，由 flux_fsm_count 宏在计数开启时调用
+ * @note 快速路径只读写调用线程独占的缓存行，外加一次全局代数的宽松读取
+ */
+void flux_fsm_counters_add(flux_fsm_rc_t rc, uint64_t ticks) {
+    flux_fsm_counter_slot_t* slot = flux_fsm_counters_slot;
+    unsigned epoch = atomic_load_explicit(&flux_fsm_counters_epoch, memory_order_relaxed);
+
+    if (!slot) {
+        slot = flux_fsm_counters_acquire();
+        if (!slot) {
+            return;
+        }
+    } else if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != epoch) {
+        flux_fsm_counter_clear(slot);
+        atomic_store_explicit(&slot->epoch, epoch, memory_order_release);
+    }
+
+    flux_fsm_counter_inc(&slot->events, 1);
+    switch (rc) {
+    case FLUX_FSM_OK:
+        flux_fsm_counter_inc(&slot->transitions, 1);
+        break;
+    case FLUX_FSM_GUARD_FAIL:
+        flux_fsm_counter_inc(&slot->guard_failures, 1);
+        break;
+    case FLUX_FSM_INVALID_STATE:
+        flux_fsm_counter_inc(&slot->invalid_states, 1);
+        break;
+    default:
+        flux_fsm_counter_inc(&slot->invalid_events, 1);
+        break;
+    }
+
+    flux_fsm_counter_inc(&slot->ticks, ticks);
+    if (ticks > flux_fsm_counter_get(&slot->max_ticks)) {
+        flux_fsm_counter_set(&slot->max_ticks, ticks);
+    }
+}
+
+/**
+ * @brief 开启或关闭事件计数
+ * @note 关闭时每个事件只多一次宽松原子读取；开启时另有两次时间戳与
+ *       对线程私有缓存行的若干次写入，线程之间没有共享写
+ */
+void flux_fsm_counters_enable(int enable) {
+    if (enable) {
+        pthread_once(&flux_fsm_counters_once, flux_fsm_counters_init_once);
+    }
+    atomic_store_explicit(&flux_fsm_counters_on, enable ? 1 : 0, memory_order_relaxed);
+}
+
+int flux_fsm_counters_enabled(void) {
+    return atomic_load_explicit(&flux_fsm_counters_on, memory_order_relaxed);
+}
+
+/**
+ * @brief 合并全部线程（含已退出线程）自上次重置以来的计数
+ * @param out 输出，耗时换算为纳秒
+ * @note 开销与曾经计数的线程数成正比，与事件数无关，可周期性调用
+ */
+void flux_fsm_counters_read(flux_fsm_counters_t* out) {
+    if (!out) {
+        return;
+    }
+
+    pthread_mutex_lock(&flux_fsm_counters_lock);
+    unsigned epoch = atomic_load_explicit(&flux_fsm_counters_epoch, memory_order_relaxed);
+
+    *out = flux_fsm_counters_retired;
+    for (flux_fsm_counter_slot_t* slot = flux_fsm_counters_slots; slot; slot = slot->next) {
+        if (slot->in_use) {
+            flux_fsm_counter_merge(out, slot, epoch);
+        }
+    }
+    pthread_mutex_unlock(&flux_fsm_counters_lock);
+
+    double ns_per_tick = flux_fsm_ns_per_tick();
+    out->total_ns = (uint64_t)((double)out->total_ns * ns_per_tick);
+    out->max_ns = (uint64_t)((double)out->max_ns * ns_per_tick);
+}
+
+/**
+ * @brief 清零全部计数
+ * @note 递增全局代数，各线程在下一次计数时自行清零，避免跨线程写入
+ */
+void flux_fsm_counters_reset(void) {
+    pthread_mutex_lock(&flux_fsm_counters_lock);
+    memset(&flux_fsm_counters_retired, 0, sizeof(flux_fsm_counters_retired));
+    atomic_fetch_add_explicit(&flux_fsm_counters_epoch, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&flux_fsm_counters_lock);
+}
+
+/**
+ * @brief 设置阶段计时的接收者
+ * @param sink 接收者，NULL 表示关闭；须在关闭且事件线程静止之前保持有效
+ * @note 关闭时每次转移只多一次宽松原子读取；开启时每次转移额外读取
+ *       四次时间戳并调用一次 sink->handler
+ */
+void flux_fsm_phases_attach(const flux_fsm_phase_sink_t* sink) {
+    if (sink) {
+        pthread_once(&flux_fsm_counters_once, flux_fsm_counters_init_once);
+    }
+    atomic_store_explicit(&flux_fsm_phase_sink, sink, memory_order_release);
+}
+
+/**
+ * @brief flux_fsm_apply 的计时版本，语义相同，另将各阶段耗时交给阶段回调
+ */
+flux_fsm_rc_t flux_fsm_apply_timed(const flux_fsm_t* fsm, const flux_fsm_transition_t* trans,
+    void* ctx, int* state, uint64_t machine)
+{
+    const flux_fsm_phase_sink_t* sink = atomic_load_explicit(&flux_fsm_phase_sink, memory_order_acquire);
+    flux_fsm_phase_t phase;
+    uint64_t t0, t1, t2, t3;
+    int from = *state;
+
+    t0 = flux_fsm_ticks();
+    int pass = !trans->guard || trans->guard(ctx);
+    t1 = flux_fsm_ticks();
+
+    if (pass) {
+        if (trans->action) {
+            trans->action(ctx);
+        }
+        t2 = flux_fsm_ticks();
+
+        if ((size_t)from < fsm->handler_count && fsm->handlers[from]) {
+            fsm->handlers[from](ctx, trans->event);
+        }
+        t3 = flux_fsm_ticks();
+
+        flux_fsm_state_store(state, trans->to);
+    } else {
+        t2 = t3 = t1;
+    }
+
+    phase.rc = pass ? FLUX_FSM_OK : FLUX_FSM_GUARD_FAIL;
+    flux_fsm_trace(machine, from, trans->event, trans->to, phase.rc);
+
+    if (sink && sink->handler) {
+        double ns_per_tick = flux_fsm_ns_per_tick();
+
+        phase.machine = machine;
+        phase.from = from;
+        phase.event = trans->event;
+        phase.to = trans->to;
+        phase.guard_ns = (uint64_t)((double)(t1 - t0) * ns_per_tick);
+        phase.action_ns = (uint64_t)((double)(t2 - t1) * ns_per_tick);
+        phase.handler_ns = (uint64_t)((double)(t3 - t2) * ns_per_tick);
+        sink->handler(sink->data, &phase);
+    }
+
+    return phase.rc;
+}
+
+#endif /* FLUX_FSM_HAVE_COUNTERS */
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+/**
+ * @brief 创建空的状态机定义
+ * @return 成功返回定义指针（引用计数为 1），失败返回NULL
+ * @note 定义在 flux_fsm_def_seal 之前可写，封存后只读并可被多个实例共享
+ */
+flux_fsm_def_t* flux_fsm_def_create(void) {
+    flux_fsm_def_t* def = (flux_fsm_def_t*)calloc(1, sizeof(flux_fsm_def_t));
+    if (!def) {
+        return NULL;
+    }
+
+    atomic_init(&def->refcount, 1);
+    return def;
+}
+
+flux_fsm_def_t* flux_fsm_def_retain(flux_fsm_def_t* def) {
+    if (def) {
+        atomic_fetch_add_explicit(&def->refcount, 1, memory_order_relaxed);
+    }
+    return def;
+}
+
+void flux_fsm_def_release(flux_fsm_def_t* def) {
+    if (!def) {
+        return;
+    }
+
+    if (atomic_fetch_sub_explicit(&def->refcount, 1, memory_order_acq_rel) == 1) {
+        if (def->image) {
+            flux_fsm_image_release(def);
+        }
+        flux_fsm_fini(&def->table);
+        free(def);
+    }
+}
+
+flux_fsm_rc_t flux_fsm_def_add_transition(flux_fsm_def_t* def, const flux_fsm_transition_t* trans) {
+    if (!def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (def->table.sealed) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return flux_fsm_add_transition(&def->table, trans);
+}
+
+flux_fsm_rc_t flux_fsm_def_add_transitions(flux_fsm_def_t* def, const flux_fsm_transition_t* trans, size_t n) {
+    if (!def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (def->table.sealed) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return flux_fsm_add_transitions(&def->table, trans, n);
+}
+
+flux_fsm_rc_t flux_fsm_def_add_handler(flux_fsm_def_t* def, int state, flux_fsm_handler_pt handler) {
+    if (!def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (def->table.sealed) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return flux_fsm_add_handler(&def->table, state, handler);
+}
+
+static uint64_t flux_fsm_hash_word(uint64_t h, uint32_t w) {
+    for (int i = 0; i < 4; i++) {
+        h ^= (w >> (i * 8)) & 0xffu;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+/**
+ * @brief 计算转移表的结构哈希（FNV-1a 64）
+ * @return 非 0 的哈希值
+ */
+uint64_t flux_fsm_table_hash(const flux_fsm_t* table) {
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    h = flux_fsm_hash_word(h, (uint32_t)table->transition_count);
+    for (size_t i = 0; i < table->transition_count; i++) {
+        flux_fsm_transition_t tmp;
+        const flux_fsm_transition_t* t = flux_fsm_transition_at(table, i, &tmp);
+        h = flux_fsm_hash_word(h, (uint32_t)t->from);
+        h = flux_fsm_hash_word(h, (uint32_t)t->event);
+        h = flux_fsm_hash_word(h, (uint32_t)t->to);
+        h = flux_fsm_hash_word(h, (t->guard ? 1u : 0u) | (t->action ? 2u : 0u));
+    }
+
+    h = flux_fsm_hash_word(h, (uint32_t)table->handler_count);
+    for (size_t s = 0; s < table->handler_count; s++) {
+        h = flux_fsm_hash_word(h, table->handlers[s] ? 1u : 0u);
+    }
+
+    return h ? h : 1;
+}
+
+/**
+ * @brief 封存定义：编译分派索引并计算结构哈希，此后定义只读
+ * @param def 状态机定义
+ * @return 成功返回 FLUX_FSM_OK，重复封存同样返回 FLUX_FSM_OK
+ */
+flux_fsm_rc_t flux_fsm_def_seal(flux_fsm_def_t* def) {
+    if (!def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (def->table.sealed) {
+        return FLUX_FSM_OK;
+    }
+
+    flux_fsm_rc_t rc = flux_fsm_seal(&def->table);
+    if (rc == FLUX_FSM_OK) {
+        def->hash = flux_fsm_table_hash(&def->table);
+    }
+    return rc;
+}
+
+/**
+ * @brief 定义的结构哈希
+ * @return 已封存的定义返回非 0 的哈希值，未封存返回 0
+ * @note 覆盖转移的 (from, event, to)、守卫与动作是否存在以及各状态是否有
+ *       处理器，不含函数地址，因此同一份定义在不同进程中哈希相同
+ */
+uint64_t flux_fsm_def_hash(const flux_fsm_def_t* def) {
+    return def && def->table.sealed ? def->hash : 0;
+}
+
+/**
+ * @brief 将定义的转移表转为紧凑存储，须在封存之前调用
+ * @return 成功返回 FLUX_FSM_OK，已封存或取值超出 16 位返回 FLUX_FSM_ERROR
+ */
+flux_fsm_rc_t flux_fsm_def_compact(flux_fsm_def_t* def) {
+    if (!def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (def->table.sealed) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return flux_fsm_compact(&def->table);
+}
+
+/**
+ * @brief 获取定义内部的转移表，用于可视化、导出等只读工具
+ */
+const flux_fsm_t* flux_fsm_def_table(const flux_fsm_def_t* def) {
+    return def ? &def->table : NULL;
+}
+
+/**
+ * @brief 在调用方提供的存储上初始化实例
+ * @param inst 实例存储，可位于数组、内存池或其他对象之内
+ * @param def 已封存的定义，实例持有其一个引用
+ * @param init_state 初始状态
+ * @param context 状态上下文指针
+ * @return 成功返回 FLUX_FSM_OK，定义未封存返回 FLUX_FSM_ERROR
+ */
+flux_fsm_rc_t flux_fsm_inst_init(flux_fsm_inst_t* inst, flux_fsm_def_t* def,
+    int init_state, void* context)
+{
+    if (!inst || !def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (!def->table.sealed) {
+        return FLUX_FSM_ERROR;
+    }
+
+    inst->def = flux_fsm_def_retain(def);
+    inst->context = context;
+    inst->current_state = init_state;
+    inst->trace_id = 0;
+
+    return FLUX_FSM_OK;
+}
+
+void flux_fsm_inst_fini(flux_fsm_inst_t* inst) {
+    if (!inst) {
+        return;
+    }
+
+    flux_fsm_def_release(inst->def);
+    inst->def = NULL;
+}
+
+flux_fsm_inst_t* flux_fsm_inst_create(flux_fsm_def_t* def, int init_state, void* context) {
+    flux_fsm_inst_t* inst = (flux_fsm_inst_t*)malloc(sizeof(flux_fsm_inst_t));
+    if (!inst) {
+        return NULL;
+    }
+
+    if (flux_fsm_inst_init(inst, def, init_state, context) != FLUX_FSM_OK) {
+        free(inst);
+        return NULL;
+    }
+
+    return inst;
+}
+
+void flux_fsm_inst_destroy(flux_fsm_inst_t* inst) {
+    if (!inst) {
+        return;
+    }
+
+    flux_fsm_inst_fini(inst);
+    free(inst);
+}
+
+static inline flux_fsm_rc_t flux_fsm_inst_dispatch(flux_fsm_inst_t* inst, flux_fsm_event_t event) {
+    const flux_fsm_t* table = &inst->def->table;
+    if (flux_fsm_event_rejected(table, inst->current_state, event)) {
+        return FLUX_FSM_ERROR;
+    }
+
+    int trans_idx = inst->current_state >= 0
+        ? flux_fsm_index_lookup(table->index, inst->current_state, event)
+        : flux_fsm_scan(table, inst->current_state, event);
+    if (trans_idx < 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    return flux_fsm_apply_at(table, (size_t)trans_idx, inst->context, &inst->current_state,
+        flux_fsm_trace_machine(inst));
+}
+
+/**
+ * @brief 实例处理事件，查找与执行均基于共享定义
+ * @param inst 实例指针
+ * @param event 待处理事件
+ * @return 状态处理结果 FLUX_FSM_OK 表示成功
+ */
+flux_fsm_rc_t flux_fsm_inst_process_event(flux_fsm_inst_t* inst, flux_fsm_event_t event) {
+    if (!inst || !inst->def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_rc_t rc;
+    flux_fsm_count(rc, flux_fsm_inst_dispatch(inst, event));
+    return rc;
+}
+
+int flux_fsm_inst_get_state(const flux_fsm_inst_t* inst) {
+    return inst ? inst->current_state : FLUX_FSM_INVALID_EVENT;
+}
@@ -0,0 +1,643 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * 定义映像：封存后的定义按内存布局写入文件，加载时映射并原地使用。
+ *
+ *   header                          flux_fsm_image_header_t，含定义的结构哈希
+ *   TRANSITIONS  transition_count × flux_fsm_compact_t
+ *   CALLBACKS    callback_count   × {u32 guard, u32 action}   符号编号，0 为空
+ *   HANDLERS     handler_count    × u32                       符号编号，0 为空
+ *   MASKS        mask_count       × u64                       事件位图
+ *   INDEX_ROWS   row_count        × flux_fsm_index_row_t
+ *   ENTRIES      entry_count      × i32
+ *   KEYS         entry_count      × i32
+ *   SLOTS        slot_count       × i32
+ *   SYMBOLS      symbol_count     × u32                       名称在 STRINGS 中的偏移
+ *   STRINGS      strings_size 字节，以 '\0' 分隔的符号名
+ *
+ * 各段偏移记录在头部并按 8 字节对齐。整数以写入方的字节序存放，
+ * endian 字段用于检测字节序不同的映像；转移行与索引数组不做转换。
+ */
+
+#define FLUX_FSM_IMAGE_MAGIC    "FLUXFSM"
+#define FLUX_FSM_IMAGE_VERSION  2
+#define FLUX_FSM_IMAGE_ENDIAN   0x01020304u
+#define FLUX_FSM_IMAGE_ALIGN    8
+
+enum {
+    FLUX_FSM_IMAGE_TRANSITIONS,
+    FLUX_FSM_IMAGE_CALLBACKS,
+    FLUX_FSM_IMAGE_HANDLERS,
+    FLUX_FSM_IMAGE_MASKS,
+    FLUX_FSM_IMAGE_INDEX_ROWS,
+    FLUX_FSM_IMAGE_ENTRIES,
+    FLUX_FSM_IMAGE_KEYS,
+    FLUX_FSM_IMAGE_SLOTS,
+    FLUX_FSM_IMAGE_SYMBOLS,
+    FLUX_FSM_IMAGE_STRINGS,
+    FLUX_FSM_IMAGE_SECTIONS
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint32_t header_size;
+    uint32_t state_count;
+    uint64_t file_size;
+    uint32_t transition_count;
+    uint32_t callback_count;
+    uint32_t handler_count;
+    uint32_t mask_count;
+    uint32_t row_count;
+    uint32_t entry_count;
+    uint32_t slot_count;
+    uint32_t symbol_count;
+    uint32_t strings_size;
+    uint32_t reserved;
+    uint64_t def_hash;
+    uint64_t offsets[FLUX_FSM_IMAGE_SECTIONS];
+} flux_fsm_image_header_t;
+
+typedef struct {
+    uint32_t guard;
+    uint32_t action;
+} flux_fsm_image_callbacks_t;
+
+/* 保存过程中的符号登记：provided[k] 为调用方符号表第 k 项在映像中的编号 */
+typedef struct {
+    const flux_fsm_symbol_t* symbols;
+    size_t n;
+    uint32_t* provided;
+    uint32_t count;
+    uint32_t strings_size;
+} flux_fsm_image_names_t;
+
+static size_t flux_fsm_image_align(size_t n) {
+    return (n + FLUX_FSM_IMAGE_ALIGN - 1) & ~(size_t)(FLUX_FSM_IMAGE_ALIGN - 1);
+}
+
+/* 按函数指针查找符号并登记，返回映像中的编号（从 1 开始），未登记返回 0 */
+static uint32_t flux_fsm_image_name_id(flux_fsm_image_names_t* names, size_t k) {
+    if (!names->provided[k]) {
+        names->provided[k] = ++names->count;
+        names->strings_size += (uint32_t)strlen(names->symbols[k].name) + 1;
+    }
+    return names->provided[k];
+}
+
+static int flux_fsm_image_guard_id(flux_fsm_image_names_t* names, int (*guard)(void*), uint32_t* id) {
+    *id = 0;
+    if (!guard) {
+        return 0;
+    }
+    for (size_t k = 0; k < names->n; k++) {
+        if (names->symbols[k].guard == guard && names->symbols[k].name) {
+            *id = flux_fsm_image_name_id(names, k);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int flux_fsm_image_action_id(flux_fsm_image_names_t* names, void (*action)(void*), uint32_t* id) {
+    *id = 0;
+    if (!action) {
+        return 0;
+    }
+    for (size_t k = 0; k < names->n; k++) {
+        if (names->symbols[k].action == action && names->symbols[k].name) {
+            *id = flux_fsm_image_name_id(names, k);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int flux_fsm_image_handler_id(flux_fsm_image_names_t* names, flux_fsm_handler_pt handler, uint32_t* id) {
+    *id = 0;
+    if (!handler) {
+        return 0;
+    }
+    for (size_t k = 0; k < names->n; k++) {
+        if (names->symbols[k].handler == handler && names->symbols[k].name) {
+            *id = flux_fsm_image_name_id(names, k);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int flux_fsm_image_write(FILE* file, const void* data, size_t size) {
+    static const char pad[FLUX_FSM_IMAGE_ALIGN];
+
+    if (size && fwrite(data, 1, size, file) != size) {
+        return -1;
+    }
+
+    size_t rest = flux_fsm_image_align(size) - size;
+    return rest && fwrite(pad, 1, rest, file) != rest ? -1 : 0;
+}
+
+/**
+ * @brief 将已封存的定义保存为映像文件
+ * @param def 已封存的定义
+ * @param filename 目标路径，先写入 filename.tmp 再原子替换
+ * @param symbols 守卫、动作与处理器的符号表
+ * @param n 符号数量
+ * @return 成功返回 FLUX_FSM_OK；定义未封存、存在未登记的回调、状态或事件
+ *         超出 [0, 65535]、或写入失败返回 FLUX_FSM_ERROR
+ * @note 转移行以紧凑格式保存，已在其他进程中映射的旧文件不受影响
+ */
+flux_fsm_rc_t flux_fsm_def_save(const flux_fsm_def_t* def, const char* filename,
+    const flux_fsm_symbol_t* symbols, size_t n)
+{
+    if (!def || !filename || (!symbols && n)) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    const flux_fsm_t* table = &def->table;
+    if (!table->sealed || table->transition_count > UINT32_MAX || table->handler_count > UINT32_MAX
+        || table->event_mask_capacity > UINT32_MAX) {
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t tc = table->transition_count;
+    size_t hc = table->handler_count;
+    flux_fsm_index_t* own_index = table->index ? NULL : flux_fsm_index_build(table);
+    const flux_fsm_index_t* index = table->index ? table->index : own_index;
+
+    flux_fsm_image_names_t names = {symbols, n, calloc(n ? n : 1, sizeof(uint32_t)), 0, 0};
+    flux_fsm_compact_t* rows = malloc((tc ? tc : 1) * sizeof(flux_fsm_compact_t));
+    flux_fsm_image_callbacks_t* cbs = malloc((tc ? tc : 1) * sizeof(flux_fsm_image_callbacks_t));
+    flux_fsm_callbacks_t* cb_ptrs = malloc((tc ? tc : 1) * sizeof(flux_fsm_callbacks_t));
+    uint32_t* handlers = malloc((hc ? hc : 1) * sizeof(uint32_t));
+    char* path = malloc(strlen(filename) + sizeof(".tmp"));
+    uint32_t* sym_offsets = NULL;
+    char* strings = NULL;
+    FILE* file = NULL;
+    flux_fsm_rc_t rc = FLUX_FSM_ERROR;
+    uint32_t cb_count = 0;
+
+    if (!index || !names.provided || !rows || !cbs || !cb_ptrs || !handlers || !path) {
+        goto done;
+    }
+
+    /* 转移行编码为紧凑格式，(守卫, 动作) 组合去重 */
+    for (size_t i = 0; i < tc; i++) {
+        flux_fsm_transition_t tmp;
+        const flux_fsm_transition_t* t = flux_fsm_transition_at(table, i, &tmp);
+
+        if ((unsigned)t->from > FLUX_FSM_COMPACT_MAX || (unsigned)t->event > FLUX_FSM_COMPACT_MAX
+            || (unsigned)t->to > FLUX_FSM_COMPACT_MAX) {
+            goto done;
+        }
+
+        uint32_t cb = 0;
+        if (t->guard || t->action) {
+            for (uint32_t k = cb_count; k > 0; k--) {
+                if (cb_ptrs[k - 1].guard == t->guard && cb_ptrs[k - 1].action == t->action) {
+                    cb = k;
+                    break;
+                }
+            }
+            if (!cb) {
+                if (cb_count >= FLUX_FSM_COMPACT_MAX
+                    || flux_fsm_image_guard_id(&names, t->guard, &cbs[cb_count].guard) != 0
+                    || flux_fsm_image_action_id(&names, t->action, &cbs[cb_count].action) != 0) {
+                    goto done;
+                }
+                cb_ptrs[cb_count].guard = t->guard;
+                cb_ptrs[cb_count].action = t->action;
+                cb = ++cb_count;
+            }
+        }
+
+        rows[i].from = (uint16_t)t->from;
+        rows[i].event = (uint16_t)t->event;
+        rows[i].to = (uint16_t)t->to;
+        rows[i].cb = (uint16_t)cb;
+    }
+
+    for (size_t s = 0; s < hc; s++) {
+        if (flux_fsm_image_handler_id(&names, table->handlers[s], &handlers[s]) != 0) {
+            goto done;
+        }
+    }
+
+    sym_offsets = malloc((names.count ? names.count : 1) * sizeof(uint32_t));
+    strings = malloc(names.strings_size ? names.strings_size : 1);
+    if (!sym_offsets || !strings) {
+        goto done;
+    }
+
+    uint32_t pos = 0;
+    for (size_t k = 0; k < n; k++) {
+        uint32_t id = names.provided[k];
+        if (id) {
+            size_t len = strlen(symbols[k].name) + 1;
+            sym_offsets[id - 1] = pos;
+            memcpy(strings + pos, symbols[k].name, len);
+            pos += (uint32_t)len;
+        }
+    }
+
+    /* 头部与各段偏移 */
+    flux_fsm_image_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, FLUX_FSM_IMAGE_MAGIC, sizeof(FLUX_FSM_IMAGE_MAGIC));
+    h.version = FLUX_FSM_IMAGE_VERSION;
+    h.endian = FLUX_FSM_IMAGE_ENDIAN;
+    h.header_size = sizeof(h);
+    h.state_count = table->state_count > UINT32_MAX ? UINT32_MAX : (uint32_t)table->state_count;
+    h.transition_count = (uint32_t)tc;
+    h.callback_count = cb_count;
+    h.handler_count = (uint32_t)hc;
+    h.mask_count = (uint32_t)table->event_mask_capacity;
+    h.row_count = index->row_count;
+    h.entry_count = index->entry_count;
+    h.slot_count = index->slot_count;
+    h.symbol_count = names.count;
+    h.strings_size = names.strings_size;
+    h.def_hash = def->hash;
+
+    const void* data[FLUX_FSM_IMAGE_SECTIONS] = {
+        rows, cbs, handlers, table->event_masks, index->rows,
+        index->entries, index->keys, index->slots, sym_offsets, strings
+    };
+    size_t sizes[FLUX_FSM_IMAGE_SECTIONS] = {
+        tc * sizeof(flux_fsm_compact_t),
+        cb_count * sizeof(flux_fsm_image_callbacks_t),
+        hc * sizeof(uint32_t),
+        table->event_mask_capacity * sizeof(uint64_t),
+        (size_t)index->row_count * sizeof(flux_fsm_index_row_t),
+        (size_t)index->entry_count * sizeof(int32_t),
+        (size_t)index->entry_count * sizeof(int32_t),
+        (size_t)index->slot_count * sizeof(int32_t),
+        names.count * sizeof(uint32_t),
+        names.strings_size
+    };
+
+    size_t off = flux_fsm_image_align(sizeof(h));
+    for (int s = 0; s < FLUX_FSM_IMAGE_SECTIONS; s++) {
+        h.offsets[s] = off;
+        off += flux_fsm_image_align(sizes[s]);
+    }
+    h.file_size = off;
+
+    strcpy(path, filename);
+    strcat(path, ".tmp");
+    file = fopen(path, "wb");
+    if (!file || flux_fsm_image_write(file, &h, sizeof(h)) != 0) {
+        goto done;
+    }
+    for (int s = 0; s < FLUX_FSM_IMAGE_SECTIONS; s++) {
+        if (flux_fsm_image_write(file, data[s], sizes[s]) != 0) {
+            goto done;
+        }
+    }
+
+    int closed = fclose(file);
+    file = NULL;
+    if (closed == 0 && rename(path, filename) == 0) {
+        rc = FLUX_FSM_OK;
+    }
+
+done:
+    if (file) {
+        fclose(file);
+    }
+    if (rc != FLUX_FSM_OK && path) {
+        remove(path);
+    }
+    flux_fsm_index_free(own_index, NULL);
+    free(names.provided);
+    free(rows);
+    free(cbs);
+    free(cb_ptrs);
+    free(handlers);
+    free(path);
+    free(sym_offsets);
+    free(strings);
+    return rc;
+}
+
+/* 读入或映射整个文件 */
+static void* flux_fsm_image_open(const char* filename, size_t* size) {
+#if defined(FLUX_FSM_HAVE_MMAP)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(flux_fsm_image_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* image = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        return NULL;
+    }
+
+    *size = (size_t)st.st_size;
+    return image;
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    void* image = len >= (long)sizeof(flux_fsm_image_header_t) ? malloc((size_t)len) : NULL;
+    if (!image || fread(image, 1, (size_t)len, file) != (size_t)len) {
+        free(image);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    *size = (size_t)len;
+    return image;
+#endif
+}
+
+static void flux_fsm_image_close(void* image, size_t size) {
+#if defined(FLUX_FSM_HAVE_MMAP)
+    munmap(image, size);
+#else
+    (void)size;
+    free(image);
+#endif
+}
+
+/* 校验头部与各段边界，不检查段内容 */
+static int flux_fsm_image_check(const flux_fsm_image_header_t* h, size_t size) {
+    if (memcmp(h->magic, FLUX_FSM_IMAGE_MAGIC, sizeof(FLUX_FSM_IMAGE_MAGIC)) != 0
+        || h->endian != FLUX_FSM_IMAGE_ENDIAN
+        || h->version != FLUX_FSM_IMAGE_VERSION
+        || h->header_size != sizeof(flux_fsm_image_header_t)
+        || h->file_size != size) {
+        return -1;
+    }
+
+    uint64_t sizes[FLUX_FSM_IMAGE_SECTIONS] = {
+        (uint64_t)h->transition_count * sizeof(flux_fsm_compact_t),
+        (uint64_t)h->callback_count * sizeof(flux_fsm_image_callbacks_t),
+        (uint64_t)h->handler_count * sizeof(uint32_t),
+        (uint64_t)h->mask_count * sizeof(uint64_t),
+        (uint64_t)h->row_count * sizeof(flux_fsm_index_row_t),
+        (uint64_t)h->entry_count * sizeof(int32_t),
+        (uint64_t)h->entry_count * sizeof(int32_t),
+        (uint64_t)h->slot_count * sizeof(int32_t),
+        (uint64_t)h->symbol_count * sizeof(uint32_t),
+        h->strings_size
+    };
+
+    for (int s = 0; s < FLUX_FSM_IMAGE_SECTIONS; s++) {
+        if (h->offsets[s] % FLUX_FSM_IMAGE_ALIGN || h->offsets[s] < sizeof(*h)
+            || h->offsets[s] > size || sizes[s] > size - h->offsets[s]) {
+            return -1;
+        }
+    }
+
+    const char* strings = (const char*)h + h->offsets[FLUX_FSM_IMAGE_STRINGS];
+    const uint32_t* sym = (const uint32_t*)((const char*)h + h->offsets[FLUX_FSM_IMAGE_SYMBOLS]);
+    if (h->symbol_count && (!h->strings_size || strings[h->strings_size - 1] != '\0')) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < h->symbol_count; i++) {
+        if (sym[i] >= h->strings_size) {
+            return -1;
+        }
+    }
+
+    return h->callback_count > FLUX_FSM_COMPACT_MAX ? -1 : 0;
+}
+
+/**
+ * @brief 校验段内容的交叉引用：转移行的回调编号、索引行的区间与稠密窗口，
+ *        以及 entries/slots 引用的转移序号
+ * @note 索引项还须与所指转移行的 (from, event) 一致，过期或错位的索引被拒绝；
+ *       分派只依赖这些不变式，校验通过后查找不会越界
+ */
+static int flux_fsm_image_check_content(const flux_fsm_image_header_t* h) {
+    const char* base = (const char*)h;
+    const flux_fsm_compact_t* rows =
+        (const flux_fsm_compact_t*)(base + h->offsets[FLUX_FSM_IMAGE_TRANSITIONS]);
+    const flux_fsm_image_callbacks_t* cbs =
+        (const flux_fsm_image_callbacks_t*)(base + h->offsets[FLUX_FSM_IMAGE_CALLBACKS]);
+    const uint32_t* hids = (const uint32_t*)(base + h->offsets[FLUX_FSM_IMAGE_HANDLERS]);
+    const flux_fsm_index_row_t* index_rows =
+        (const flux_fsm_index_row_t*)(base + h->offsets[FLUX_FSM_IMAGE_INDEX_ROWS]);
+    const int32_t* entries = (const int32_t*)(base + h->offsets[FLUX_FSM_IMAGE_ENTRIES]);
+    const int32_t* keys = (const int32_t*)(base + h->offsets[FLUX_FSM_IMAGE_KEYS]);
+    const int32_t* slots = (const int32_t*)(base + h->offsets[FLUX_FSM_IMAGE_SLOTS]);
+
+    for (uint32_t i = 0; i < h->transition_count; i++) {
+        if (rows[i].cb > h->callback_count) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < h->callback_count; i++) {
+        if (cbs[i].guard > h->symbol_count || cbs[i].action > h->symbol_count) {
+            return -1;
+        }
+    }
+    for (uint32_t s = 0; s < h->handler_count; s++) {
+        if (hids[s] > h->symbol_count) {
+            return -1;
+        }
+    }
+
+    for (uint32_t r = 0; r < h->row_count; r++) {
+        const flux_fsm_index_row_t* row = &index_rows[r];
+
+        if ((uint64_t)row->first + row->count > h->entry_count) {
+            return -1;
+        }
+        for (uint32_t j = row->first; j < row->first + row->count; j++) {
+            if (entries[j] < 0 || (uint32_t)entries[j] >= h->transition_count
+                || rows[entries[j]].from != r || rows[entries[j]].event != (uint32_t)keys[j]) {
+                return -1;
+            }
+        }
+
+        if (row->span) {
+            if ((uint64_t)row->slot + row->span > h->slot_count) {
+                return -1;
+            }
+            for (uint32_t off = 0; off < row->span; off++) {
+                int32_t idx = slots[row->slot + off];
+                if (idx == -1) {
+                    continue;
+                }
+                if (idx < 0 || (uint32_t)idx >= h->transition_count || rows[idx].from != r
+                    || rows[idx].event != (uint32_t)row->ev_min + off) {
+                    return -1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* 按映像中的符号编号在调用方符号表中查找，id 为 0 时返回 NULL */
+static const flux_fsm_symbol_t* flux_fsm_image_symbol(const flux_fsm_image_header_t* h, uint32_t id,
+    const flux_fsm_symbol_t* symbols, size_t n)
+{
+    if (!id || id > h->symbol_count) {
+        return NULL;
+    }
+
+    const uint32_t* sym = (const uint32_t*)((const char*)h + h->offsets[FLUX_FSM_IMAGE_SYMBOLS]);
+    const char* name = (const char*)h + h->offsets[FLUX_FSM_IMAGE_STRINGS] + sym[id - 1];
+
+    for (size_t k = 0; k < n; k++) {
+        if (symbols[k].name && strcmp(symbols[k].name, name) == 0) {
+            return &symbols[k];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 映射映像文件并创建只读定义
+ * @param filename 由 flux_fsm_def_save 生成的文件
+ * @param symbols 符号表，按名称解析映像中的回调
+ * @param n 符号数量
+ * @return 成功返回已封存的定义（引用计数为 1），格式、版本、字节序不符或
+ *         存在无法解析的符号时返回 NULL
+ * @note 转移行、事件位图与索引数组直接使用映射的页面，不复制也不解析，
+ *       多个进程映射同一文件时共享物理页；只有回调旁表与处理器表按符号
+ *       解析到堆上。加载时校验头部、各段边界、回调编号与索引的全部区间，
+ *       并按解析后的转移表重新计算结构哈希，与头部记录不符（内容损坏或
+ *       与索引不匹配）时拒绝加载，快照恢复依赖该哈希
+ */
+flux_fsm_def_t* flux_fsm_def_map(const char* filename, const flux_fsm_symbol_t* symbols, size_t n) {
+    if (!filename || (!symbols && n)) {
+        return NULL;
+    }
+
+    size_t size = 0;
+    void* image = flux_fsm_image_open(filename, &size);
+    if (!image) {
+        return NULL;
+    }
+
+    const flux_fsm_image_header_t* h = image;
+    const char* base = image;
+    flux_fsm_def_t* def = NULL;
+    flux_fsm_callbacks_t* callbacks = NULL;
+    flux_fsm_state_handler_t* handlers = NULL;
+    flux_fsm_index_t* index = NULL;
+
+    if (flux_fsm_image_check(h, size) != 0 || flux_fsm_image_check_content(h) != 0) {
+        goto failed;
+    }
+
+    def = calloc(1, sizeof(flux_fsm_def_t));
+    callbacks = calloc(h->callback_count ? h->callback_count : 1, sizeof(flux_fsm_callbacks_t));
+    handlers = calloc(h->handler_count ? h->handler_count : 1, sizeof(flux_fsm_state_handler_t));
+    index = malloc(sizeof(flux_fsm_index_t));
+    if (!def || !callbacks || !handlers || !index) {
+        goto failed;
+    }
+
+    const flux_fsm_image_callbacks_t* cbs =
+        (const flux_fsm_image_callbacks_t*)(base + h->offsets[FLUX_FSM_IMAGE_CALLBACKS]);
+    for (uint32_t i = 0; i < h->callback_count; i++) {
+        const flux_fsm_symbol_t* g = flux_fsm_image_symbol(h, cbs[i].guard, symbols, n);
+        const flux_fsm_symbol_t* a = flux_fsm_image_symbol(h, cbs[i].action, symbols, n);
+        if ((cbs[i].guard && (!g || !g->guard)) || (cbs[i].action && (!a || !a->action))) {
+            goto failed;
+        }
+        callbacks[i].guard = g ? g->guard : NULL;
+        callbacks[i].action = a ? a->action : NULL;
+    }
+
+    const uint32_t* hids = (const uint32_t*)(base + h->offsets[FLUX_FSM_IMAGE_HANDLERS]);
+    for (uint32_t s = 0; s < h->handler_count; s++) {
+        const flux_fsm_symbol_t* sym = flux_fsm_image_symbol(h, hids[s], symbols, n);
+        if (hids[s] && (!sym || !sym->handler)) {
+            goto failed;
+        }
+        handlers[s] = sym ? sym->handler : NULL;
+    }
+
+    index->row_count = h->row_count;
+    index->entry_count = h->entry_count;
+    index->slot_count = h->slot_count;
+    index->rows = (const flux_fsm_index_row_t*)(base + h->offsets[FLUX_FSM_IMAGE_INDEX_ROWS]);
+    index->entries = (const int32_t*)(base + h->offsets[FLUX_FSM_IMAGE_ENTRIES]);
+    index->keys = (const int32_t*)(base + h->offsets[FLUX_FSM_IMAGE_KEYS]);
+    index->slots = (const int32_t*)(base + h->offsets[FLUX_FSM_IMAGE_SLOTS]);
+
+    /* 映像为只读页面；定义已封存，核心不会写入这些数组 */
+    flux_fsm_t* table = &def->table;
+    table->compact = (flux_fsm_compact_t*)(base + h->offsets[FLUX_FSM_IMAGE_TRANSITIONS]);
+    table->transition_count = h->transition_count;
+    table->transition_capacity = h->transition_count;
+    table->callbacks = callbacks;
+    table->callback_count = h->callback_count;
+    table->callback_capacity = h->callback_count;
+    table->handlers = handlers;
+    table->handler_count = h->handler_count;
+    table->handler_capacity = h->handler_count;
+    table->event_masks = (uint64_t*)(base + h->offsets[FLUX_FSM_IMAGE_MASKS]);
+    table->event_mask_capacity = h->mask_count;
+    table->state_count = h->state_count;
+    table->index = index;
+    table->sealed = 1;
+
+    if (flux_fsm_table_hash(table) != h->def_hash) {
+        goto failed;
+    }
+
+    atomic_init(&def->refcount, 1);
+    def->hash = h->def_hash;
+    def->image = image;
+    def->image_size = size;
+
+    return def;
+
+failed:
+    free(def);
+    free(callbacks);
+    free(handlers);
+    free(index);
+    flux_fsm_image_close(image, size);
+    return NULL;
+}
+
+/**
+ * @brief 释放定义引用的映像，由 flux_fsm_def_release 在 flux_fsm_fini 之前调用
+ * @note 指向映像的数组先置空，其余堆内存仍由 flux_fsm_fini 释放
+ */
+void flux_fsm_image_release(flux_fsm_def_t* def) {
+    def->table.compact = NULL;
+    def->table.event_masks = NULL;
+    flux_fsm_image_close(def->image, def->image_size);
+    def->image = NULL;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_internal.h"
+
+/* 稠密窗口允许的最大稀疏度：span <= fan-out * FACTOR + SLACK */
+#define FLUX_FSM_INDEX_DENSE_FACTOR  4
+#define FLUX_FSM_INDEX_DENSE_SLACK   8
+
+typedef struct {
+    int32_t key;
+    int32_t idx;
+} flux_fsm_index_pair_t;
+
+static int flux_fsm_index_pair_cmp(const void* a, const void* b) {
+    const flux_fsm_index_pair_t* pa = a;
+    const flux_fsm_index_pair_t* pb = b;
+
+    if (pa->key != pb->key) {
+        return pa->key < pb->key ? -1 : 1;
+    }
+    return pa->idx < pb->idx ? -1 : (pa->idx > pb->idx);
+}
+
+/**
+ * @brief 由转移表构建分派索引
+ * @param fsm 状态机，索引从其所属内存池分配（无池时使用堆）
+ * @return 成功返回索引，失败返回NULL
+ * @note 源状态为负的转移不进入索引，查找时由调用方线性回退；
+ *       普通与紧凑存储模式均只读取 (from, event) 键列
+ */
+flux_fsm_index_t* flux_fsm_index_build(const flux_fsm_t* fsm) {
+    size_t count = fsm->transition_count;
+    struct flux_fsm_pool_s* pool = fsm->pool;
+
+    if (count > INT32_MAX) {
+        return NULL;
+    }
+
+    /* 第一遍：确定行数与索引条目数 */
+    int max_from = -1;
+    uint32_t entry_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        int from = flux_fsm_row_from(fsm, i);
+        if (from >= 0) {
+            entry_count++;
+            if (from > max_from) {
+                max_from = from;
+            }
+        }
+    }
+    uint32_t row_count = (uint32_t)(max_from + 1);
+
+    /* 第二遍：统计每行出边数量与事件范围 */
+    size_t rows_size = (row_count ? row_count : 1) * sizeof(flux_fsm_index_row_t);
+    flux_fsm_index_row_t* rows = flux_fsm_alloc(pool, rows_size);
+    int32_t* ev_max = flux_fsm_alloc(pool, (row_count ? row_count : 1) * sizeof(int32_t));
+    if (!rows || !ev_max) {
+        flux_fsm_free(pool, rows);
+        flux_fsm_free(pool, ev_max);
+        return NULL;
+    }
+    memset(rows, 0, rows_size);
+
+    for (size_t i = 0; i < count; i++) {
+        int from = flux_fsm_row_from(fsm, i);
+        int event = flux_fsm_row_event(fsm, i);
+        if (from < 0) {
+            continue;
+        }
+        flux_fsm_index_row_t* row = &rows[from];
+        if (row->count == 0 || event < row->ev_min) {
+            row->ev_min = event;
+        }
+        if (row->count == 0 || event > ev_max[from]) {
+            ev_max[from] = event;
+        }
+        row->count++;
+    }
+
+    uint32_t first = 0;
+    uint64_t slot_count = 0;
+    for (uint32_t s = 0; s < row_count; s++) {
+        flux_fsm_index_row_t* row = &rows[s];
+        row->first = first;
+        first += row->count;
+        if (row->count == 0) {
+            continue;
+        }
+
+        uint64_t span = (uint64_t)((int64_t)ev_max[s] - row->ev_min) + 1;
+        if (span <= (uint64_t)row->count * FLUX_FSM_INDEX_DENSE_FACTOR + FLUX_FSM_INDEX_DENSE_SLACK) {
+            row->span = (uint32_t)span;
+            row->slot = (uint32_t)slot_count;
+            slot_count += span;
+        }
+    }
+    flux_fsm_free(pool, ev_max);
+
+    if (slot_count > UINT32_MAX) {
+        flux_fsm_free(pool, rows);
+        return NULL;
+    }
+
+    /* 单块分配：索引头 + 行 + CSR 条目 + 事件键 + 稠密窗口 */
+    size_t size = sizeof(flux_fsm_index_t)
+                + row_count * sizeof(flux_fsm_index_row_t)
+                + (size_t)entry_count * 2 * sizeof(int32_t)
+                + (size_t)slot_count * sizeof(int32_t);
+    flux_fsm_index_t* index = flux_fsm_alloc(pool, size);
+    flux_fsm_index_pair_t* pairs = flux_fsm_alloc(pool,
+        (entry_count ? entry_count : 1) * sizeof(flux_fsm_index_pair_t));
+    if (!index || !pairs) {
+        flux_fsm_free(pool, index);
+        flux_fsm_free(pool, pairs);
+        flux_fsm_free(pool, rows);
+        return NULL;
+    }
+
+    flux_fsm_index_row_t* out_rows = (flux_fsm_index_row_t*)(index + 1);
+    int32_t* entries = (int32_t*)(out_rows + row_count);
+    int32_t* keys = entries + entry_count;
+    int32_t* slots = keys + entry_count;
+
+    memcpy(out_rows, rows, row_count * sizeof(flux_fsm_index_row_t));
+    flux_fsm_free(pool, rows);
+
+    /* 第三遍：按原始顺序放入 CSR，cursor 复用 count 字段 */
+    for (uint32_t s = 0; s < row_count; s++) {
+        out_rows[s].count = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        int from = flux_fsm_row_from(fsm, i);
+        if (from < 0) {
+            continue;
+        }
+        flux_fsm_index_row_t* row = &out_rows[from];
+        pairs[row->first + row->count].key = flux_fsm_row_event(fsm, i);
+        pairs[row->first + row->count].idx = (int32_t)i;
+        row->count++;
+    }
+
+    memset(slots, 0xff, (size_t)slot_count * sizeof(int32_t));
+
+    for (uint32_t s = 0; s < row_count; s++) {
+        flux_fsm_index_row_t* row = &out_rows[s];
+        flux_fsm_index_pair_t* seg = pairs + row->first;
+
+        qsort(seg, row->count, sizeof(flux_fsm_index_pair_t), flux_fsm_index_pair_cmp);
+
+        for (uint32_t k = 0; k < row->count; k++) {
+            entries[row->first + k] = seg[k].idx;
+            keys[row->first + k] = seg[k].key;
+
+            /* 段内有序，同一事件的首个条目即最先添加的转移 */
+            if (row->span) {
+                int32_t* slot = &slots[row->slot + (uint32_t)seg[k].key - (uint32_t)row->ev_min];
+                if (*slot < 0) {
+                    *slot = seg[k].idx;
+                }
+            }
+        }
+    }
+    flux_fsm_free(pool, pairs);
+
+    index->row_count = row_count;
+    index->entry_count = entry_count;
+    index->slot_count = (uint32_t)slot_count;
+    index->rows = out_rows;
+    index->entries = entries;
+    index->keys = keys;
+    index->slots = slots;
+
+    return index;
+}
+
+void flux_fsm_index_free(flux_fsm_index_t* index, struct flux_fsm_pool_s* pool) {
+    flux_fsm_free(pool, index);
+}
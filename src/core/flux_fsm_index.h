@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_INDEX_H_INCLUDED_
+#define _FLUX_FSM_INDEX_H_INCLUDED_
+
+#include <stdint.h>
+#include "flux_fsm_core.h"
+
+/**
+ * @struct flux_fsm_index_row_t
+ * @brief 单个状态的索引行
+ *
+ * @var first CSR 偏移：该状态在 entries/keys 中的起始位置
+ * @var count 该状态的出边数量
+ * @var ev_min 稠密窗口的最小事件值
+ * @var span 稠密窗口宽度，0 表示该行按事件有序二分查找
+ * @var slot 稠密窗口在 slots 中的起始位置
+ */
+typedef struct {
+    uint32_t first;
+    uint32_t count;
+    int32_t ev_min;
+    uint32_t span;
+    uint32_t slot;
+} flux_fsm_index_row_t;
+
+/**
+ * @struct flux_fsm_index_s
+ * @brief 编译后的 (状态, 事件) 分派索引
+ *
+ * 所有数组均为定长整型，既可由 flux_fsm_index_build 分配，
+ * 也可直接指向外部存储。
+ */
+struct flux_fsm_index_s {
+    uint32_t row_count;
+    uint32_t entry_count;
+    uint32_t slot_count;
+    const flux_fsm_index_row_t* rows;
+    const int32_t* entries;   /* 按状态分组、组内按 (事件, 序号) 排序的转移索引 */
+    const int32_t* keys;      /* entries 对应的事件值 */
+    const int32_t* slots;     /* 稠密窗口：事件 -> 转移索引，-1 为空 */
+};
+
+flux_fsm_index_t* flux_fsm_index_build(const flux_fsm_t* fsm);
+void flux_fsm_index_free(flux_fsm_index_t* index, struct flux_fsm_pool_s* pool);
+
+/**
+ * @brief 在索引中查找转移
+ * @return 转移索引；-1 表示不存在；state 为负时调用方应回退到线性查找
+ */
+static inline int flux_fsm_index_lookup(const flux_fsm_index_t* index, int state, int event) {
+    if ((uint32_t)state >= index->row_count) {
+        return -1;
+    }
+
+    const flux_fsm_index_row_t* row = &index->rows[state];
+
+    if (row->span) {
+        uint32_t off = (uint32_t)event - (uint32_t)row->ev_min;
+        return off < row->span ? index->slots[row->slot + off] : -1;
+    }
+
+    /* 稀疏行：在有序事件段上求下界，保证取到最先添加的转移 */
+    const int32_t* keys = index->keys + row->first;
+    uint32_t lo = 0;
+    uint32_t hi = row->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (keys[mid] < event) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < row->count && keys[lo] == event) {
+        return index->entries[row->first + lo];
+    }
+    return -1;
+}
+
+#endif /* _FLUX_FSM_INDEX_H_INCLUDED_ */
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#ifndef _FLUX_FSM_INTERNAL_H_INCLUDED_
+#define _FLUX_FSM_INTERNAL_H_INCLUDED_
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flux_fsm_core.h"
+#include "flux_fsm_index.h"
+
+/**
+ * @struct flux_fsm_def_s
+ * @brief 共享的只读状态机定义
+ *
+ * @var table 原型状态机，持有转移表、处理器与分派索引
+ * @var refcount 引用计数，由定义本身与各实例共同持有
+ * @var image 由 flux_fsm_def_map 加载时的映像，转移行、事件位图与索引数组
+ *      直接指向其中，NULL 表示定义由接口逐条构建
+ * @var image_size 映像字节数
+ * @var hash 结构哈希，封存或映射时确定，见 flux_fsm_def_hash
+ */
+struct flux_fsm_def_s {
+    flux_fsm_t table;
+    atomic_size_t refcount;
+    void* image;
+    size_t image_size;
+    uint64_t hash;
+};
+
+/**
+ * @struct flux_fsm_cache_entry_t
+ * @brief 缓存项，version 与状态机当前版本一致且 idx >= 0 时有效
+ */
+typedef struct {
+    int32_t state;
+    int32_t event;
+    int32_t idx;
+    uint32_t version;
+} flux_fsm_cache_entry_t;
+
+/**
+ * @struct flux_fsm_cache_s
+ * @brief 直接映射的 (状态, 事件) -> 转移序号缓存
+ *
+ * @var mask 槽位数 - 1，槽位数为 2 的幂
+ * @var hits 命中次数
+ * @var misses 未命中次数
+ * @var entries 缓存槽
+ */
+struct flux_fsm_cache_s {
+    uint32_t mask;
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+    flux_fsm_cache_entry_t entries[];
+};
+
+/**
+ * @struct flux_fsm_profile_s
+ * @brief 按转移序号与状态号索引的平坦计数数组
+ *
+ * @var hits 每条转移完成的次数
+ * @var hit_capacity hits 的项数
+ * @var dwell 每个状态的累计停留时间（ticks），不含当前这次停留
+ * @var state_capacity dwell 的项数
+ * @var entered 进入当前状态的时间戳
+ */
+struct flux_fsm_profile_s {
+    uint64_t* hits;
+    size_t hit_capacity;
+    uint64_t* dwell;
+    size_t state_capacity;
+    uint64_t entered;
+};
+
+void flux_fsm_fini(flux_fsm_t* fsm);
+void flux_fsm_queue_free(flux_fsm_t* fsm);
+void flux_fsm_cache_clear(flux_fsm_cache_t* cache);
+void flux_fsm_image_release(flux_fsm_def_t* def);
+uint64_t flux_fsm_table_hash(const flux_fsm_t* table);
+
+static inline flux_fsm_cache_entry_t* flux_fsm_cache_slot(flux_fsm_cache_t* cache, int state, int event) {
+    uint32_t h = (uint32_t)state * 0x9e3779b1u ^ (uint32_t)event * 0x85ebca6bu;
+    return &cache->entries[(h ^ h >> 16) & cache->mask];
+}
+
+/*
+ * 线程局部变量：默认 TLS 模型，动态库被 dlopen 时也能加载；静态链接时
+ * 定义 FLUX_FSM_STATIC_TLS 改用 initial-exec，按固定偏移访问
+ */
+#if defined(FLUX_FSM_HAVE_INITIAL_EXEC_TLS)
+#define FLUX_FSM_TLS  _Thread_local __attribute__((tls_model("initial-exec")))
+#else
+#define FLUX_FSM_TLS  _Thread_local
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define flux_fsm_prefetch(p)  __builtin_prefetch(p)
+#else
+#define flux_fsm_prefetch(p)  ((void)(p))
+#endif
+
+/*
+ * 当前状态以宽松原子方式写入与被其他线程读取，采集线程可与事件线程并发
+ * 调用 flux_fsm_get_state；宽松原子读写编译为普通访存指令
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define flux_fsm_state_store(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define flux_fsm_state_load(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#else
+#define flux_fsm_state_store(p, v)  (*(p) = (v))
+#define flux_fsm_state_load(p)      (*(p))
+#endif
+
+/* 计数只由拥有状态机的线程递增，读-改-写无需 LOCK 前缀 */
+static inline void flux_fsm_cache_count(atomic_uint_least64_t* c) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+}
+
+/*
+ * 分配辅助：pool 非 NULL 时从内存池分配，释放为空操作，
+ * 内存在池重置/销毁时统一回收
+ */
+static inline void* flux_fsm_alloc(struct flux_fsm_pool_s* pool, size_t size) {
+#if defined(FLUX_FSM_HAVE_POOL)
+    if (pool) {
+        return flux_fsm_palloc(pool, size);
+    }
+#else
+    (void)pool;
+#endif
+    return malloc(size);
+}
+
+static inline void flux_fsm_free(struct flux_fsm_pool_s* pool, void* p) {
+    if (!pool) {
+        free(p);
+    }
+}
+
+static inline void* flux_fsm_realloc(struct flux_fsm_pool_s* pool, void* p,
+    size_t old_size, size_t new_size)
+{
+#if defined(FLUX_FSM_HAVE_POOL)
+    if (pool) {
+        void* np = flux_fsm_palloc(pool, new_size);
+        if (np && p) {
+            memcpy(np, p, old_size < new_size ? old_size : new_size);
+        }
+        return np;
+    }
+#else
+    (void)old_size;
+#endif
+    return realloc(p, new_size);
+}
+
+/* 紧凑模式下键与状态的取值上限 */
+#define FLUX_FSM_COMPACT_MAX  UINT16_MAX
+
+flux_fsm_rc_t flux_fsm_compact_encode(flux_fsm_t* fsm, flux_fsm_compact_t* rows,
+    const flux_fsm_transition_t* trans, size_t n);
+
+static inline int flux_fsm_row_from(const flux_fsm_t* fsm, size_t i) {
+    return fsm->compact ? fsm->compact[i].from : fsm->transitions[i].from;
+}
+
+static inline int flux_fsm_row_event(const flux_fsm_t* fsm, size_t i) {
+    return fsm->compact ? fsm->compact[i].event : fsm->transitions[i].event;
+}
+
+/**
+ * @brief 取得第 i 条转移
+ * @param tmp 紧凑模式下用于解码的临时存储
+ * @return 普通模式返回表内指针，紧凑模式返回 tmp
+ */
+static inline const flux_fsm_transition_t* flux_fsm_transition_at(const flux_fsm_t* fsm,
+    size_t i, flux_fsm_transition_t* tmp)
+{
+    if (!fsm->compact) {
+        return &fsm->transitions[i];
+    }
+
+    const flux_fsm_compact_t* row = &fsm->compact[i];
+    tmp->from = row->from;
+    tmp->event = row->event;
+    tmp->to = row->to;
+    if (row->cb) {
+        tmp->guard = fsm->callbacks[row->cb - 1].guard;
+        tmp->action = fsm->callbacks[row->cb - 1].action;
+    } else {
+        tmp->guard = NULL;
+        tmp->action = NULL;
+    }
+    return tmp;
+}
+
+int flux_fsm_keyscan(const uint32_t* keys, size_t n, size_t i, uint32_t key);
+
+/* 压缩键：from 与 event 各取低 16 位，不同转移可能同键，命中后须核对 */
+static inline uint32_t flux_fsm_scan_key(int from, int event) {
+    return (uint32_t)from << 16 | ((uint32_t)event & 0xffffu);
+}
+
+/**
+ * @brief 事件位图快速过滤
+ * @return 1 表示 (state, event) 一定没有转移，0 表示需要继续查找
+ * @note 负状态及位图未覆盖的状态（含未维护位图时）不过滤
+ */
+static inline int flux_fsm_event_rejected(const flux_fsm_t* fsm, int state, int event) {
+    if ((size_t)(unsigned)state >= fsm->event_mask_capacity) {
+        return 0;
+    }
+    return !(fsm->event_masks[state] >> ((unsigned)event & 63) & 1);
+}
+
+/**
+ * @brief 在转移表中线性查找 (state, event)
+ * @note 有键列时以 SIMD 内核筛选候选行，再核对完整的键
+ */
+static inline int flux_fsm_scan(const flux_fsm_t* fsm, int state, int event) {
+    if (fsm->scan_keys) {
+        uint32_t key = flux_fsm_scan_key(state, event);
+        size_t i = 0;
+        int hit;
+
+        while ((hit = flux_fsm_keyscan(fsm->scan_keys, fsm->transition_count, i, key)) >= 0) {
+            if (flux_fsm_row_from(fsm, (size_t)hit) == state &&
+                flux_fsm_row_event(fsm, (size_t)hit) == event) {
+                return hit;
+            }
+            i = (size_t)hit + 1;
+        }
+        return -1;
+    }
+
+    for (size_t i = 0; i < fsm->transition_count; i++) {
+        if (flux_fsm_row_from(fsm, i) == state && flux_fsm_row_event(fsm, i) == event) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* 低开销时间戳：x86 上为 TSC，否则为不受 NTP 调整的单调时钟纳秒 */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FLUX_FSM_HAVE_TSC
+#endif
+
+static inline uint64_t flux_fsm_ticks(void) {
+#if defined(FLUX_FSM_HAVE_TSC)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* flux_fsm_ticks 的每周期纳秒数，首次调用时校准（约 5ms） */
+double flux_fsm_ns_per_tick(void);
+
+#if defined(FLUX_FSM_HAVE_TRACE)
+/* 追踪开关，flux_fsm_trace_start/stop 设置；关闭时每次转移只多一次宽松读取 */
+extern atomic_int flux_fsm_trace_on;
+
+void flux_fsm_trace_write(uint64_t machine, int from, int event, int to, flux_fsm_rc_t rc);
+
+#define flux_fsm_trace(machine, from, event, to, rc)                              \
+    do {                                                                           \
+        if (atomic_load_explicit(&flux_fsm_trace_on, memory_order_relaxed)) {      \
+            flux_fsm_trace_write((machine), (from), (event), (to), (rc));          \
+        }                                                                          \
+    } while (0)
+#else
+#define flux_fsm_trace(machine, from, event, to, rc)  ((void)0)
+#endif
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+/* 计数开关，flux_fsm_counters_enable 设置 */
+extern atomic_int flux_fsm_counters_on;
+
+void flux_fsm_counters_add(flux_fsm_rc_t rc, uint64_t ticks);
+
+/* 以 call 的结果赋值 rc；计数开启时为其计时并累加到调用线程的计数器 */
+#define flux_fsm_count(rc, call)                                                  \
+    do {                                                                           \
+        if (atomic_load_explicit(&flux_fsm_counters_on, memory_order_relaxed)) {   \
+            uint64_t start_ = flux_fsm_ticks();                                    \
+            (rc) = (call);                                                         \
+            flux_fsm_counters_add((rc), flux_fsm_ticks() - start_);                \
+        } else {                                                                   \
+            (rc) = (call);                                                         \
+        }                                                                          \
+    } while (0)
+
+/* 阶段计时回调，flux_fsm_phases_attach 设置；非 NULL 时转移走计时路径 */
+extern const flux_fsm_phase_sink_t* _Atomic flux_fsm_phase_sink;
+
+flux_fsm_rc_t flux_fsm_apply_timed(const flux_fsm_t* fsm, const flux_fsm_transition_t* trans,
+    void* ctx, int* state, uint64_t machine);
+#else
+#define flux_fsm_count(rc, call)  ((rc) = (call))
+#endif
+
+flux_fsm_rc_t flux_fsm_profile_grow(flux_fsm_t* fsm, size_t trans_idx, size_t state);
+
+/**
+ * @brief 记录一次完成的转移：累加转移命中与源状态的停留时间
+ * @note 数组不足时（启用后新增了转移或状态）扩容，负状态不计停留时间
+ */
+static inline void flux_fsm_profile_hit(flux_fsm_t* fsm, size_t trans_idx, int from) {
+    flux_fsm_profile_t* p = fsm->profile;
+    uint64_t now = flux_fsm_ticks();
+    size_t state = from < 0 ? 0 : (size_t)from;
+
+    if (trans_idx >= p->hit_capacity || state >= p->state_capacity) {
+        if (flux_fsm_profile_grow(fsm, trans_idx, state) != FLUX_FSM_OK) {
+            return;
+        }
+        p = fsm->profile;
+    }
+
+    p->hits[trans_idx]++;
+    if (from >= 0) {
+        p->dwell[from] += now - p->entered;
+    }
+    p->entered = now;
+}
+
+/* 追踪记录中的状态机标识：trace_id，未设置时为结构体地址 */
+#define flux_fsm_trace_machine(m)                                                 \
+    ((m)->trace_id ? (uint64_t)(m)->trace_id : (uint64_t)(uintptr_t)(m))
+
+/**
+ * @brief 执行一次转移：守卫、动作、源状态处理器，最后更新状态
+ * @param fsm 持有处理器表的状态机
+ * @param trans 待执行的转移
+ * @param ctx 上下文
+ * @param state 当前状态，成功时被更新
+ * @param machine 追踪记录中的状态机标识
+ */
+static inline flux_fsm_rc_t flux_fsm_apply(const flux_fsm_t* fsm,
+    const flux_fsm_transition_t* trans, void* ctx, int* state, uint64_t machine)
+{
+    int from = *state;
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+    if (atomic_load_explicit(&flux_fsm_phase_sink, memory_order_relaxed)) {
+        return flux_fsm_apply_timed(fsm, trans, ctx, state, machine);
+    }
+#endif
+
+    /* Check guard condition */
+    if (trans->guard && !trans->guard(ctx)) {
+        flux_fsm_trace(machine, from, trans->event, trans->to, FLUX_FSM_GUARD_FAIL);
+        return FLUX_FSM_GUARD_FAIL;
+    }
+
+    /* Execute transition action */
+    if (trans->action) {
+        trans->action(ctx);
+    }
+
+    /* Execute state handler */
+    if ((size_t)from < fsm->handler_count && fsm->handlers[from]) {
+        fsm->handlers[from](ctx, trans->event);
+    }
+
+    /* Update state */
+    flux_fsm_state_store(state, trans->to);
+    flux_fsm_trace(machine, from, trans->event, trans->to, FLUX_FSM_OK);
+    (void)machine;
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 执行第 trans_idx 条转移，兼容两种存储模式
+ */
+static inline flux_fsm_rc_t flux_fsm_apply_at(const flux_fsm_t* fsm, size_t trans_idx,
+    void* ctx, int* state, uint64_t machine)
+{
+    flux_fsm_transition_t tmp;
+
+    return flux_fsm_apply(fsm, flux_fsm_transition_at(fsm, trans_idx, &tmp), ctx, state, machine);
+}
+
+#endif /* _FLUX_FSM_INTERNAL_H_INCLUDED_ */
@@ -0,0 +1,402 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_POOL)
+
+#define FLUX_FSM_POOL_ALIGNMENT  _Alignof(max_align_t)
+
+/* 块内分配连续失败超过该次数后，不再作为 current 块尝试 */
+#define FLUX_FSM_POOL_MAX_FAILED  4
+
+#define flux_fsm_align_ptr(p, a)                                              \
+    (unsigned char*)(((uintptr_t)(p) + ((uintptr_t)(a) - 1)) & ~((uintptr_t)(a) - 1))
+
+typedef struct flux_fsm_pool_block_s flux_fsm_pool_block_t;
+typedef struct flux_fsm_pool_large_s flux_fsm_pool_large_t;
+typedef struct flux_fsm_pool_cleanup_s flux_fsm_pool_cleanup_t;
+
+struct flux_fsm_pool_block_s {
+    unsigned char* last;
+    unsigned char* end;
+    flux_fsm_pool_block_t* next;
+    unsigned failed;
+};
+
+struct flux_fsm_pool_large_s {
+    flux_fsm_pool_large_t* next;
+    void* alloc;
+    size_t size;
+};
+
+struct flux_fsm_pool_cleanup_s {
+    flux_fsm_pool_cleanup_pt handler;
+    void* data;
+    flux_fsm_pool_cleanup_t* next;
+};
+
+/**
+ * @struct flux_fsm_pool_s
+ * @brief 链式内存池，池头与首块位于同一次分配
+ *
+ * @var block 首块
+ * @var current 当前用于分配的块
+ * @var large 超过 max 的大块分配链表
+ * @var cleanup 重置或销毁时执行的清理回调
+ * @var size 每块总大小
+ * @var max 小块分配上限
+ */
+struct flux_fsm_pool_s {
+    flux_fsm_pool_block_t block;
+    flux_fsm_pool_block_t* current;
+    flux_fsm_pool_large_t* large;
+    flux_fsm_pool_cleanup_t* cleanup;
+    size_t size;
+    size_t max;
+};
+
+#if defined(FLUX_FSM_STATIC_POOL)
+
+/*
+ * 裸机构建：所有块与大块分配来自静态缓冲区。空闲区按地址有序成链，首次适配
+ * 分配，释放时与相邻空闲区合并，因此池重置释放大块、非栈序销毁池都能回收空间
+ */
+typedef struct flux_fsm_static_free_s flux_fsm_static_free_t;
+
+struct flux_fsm_static_free_s {
+    size_t size;
+    flux_fsm_static_free_t* next;
+};
+
+/* 分配粒度：容得下空闲区头部且保持 max_align_t 对齐 */
+#define FLUX_FSM_STATIC_UNIT                                                  \
+    ((sizeof(flux_fsm_static_free_t) + FLUX_FSM_POOL_ALIGNMENT - 1)            \
+     / FLUX_FSM_POOL_ALIGNMENT * FLUX_FSM_POOL_ALIGNMENT)
+
+#define flux_fsm_static_round(size)                                           \
+    (((size) + FLUX_FSM_STATIC_UNIT - 1) / FLUX_FSM_STATIC_UNIT * FLUX_FSM_STATIC_UNIT)
+
+static _Alignas(max_align_t) unsigned char flux_fsm_static_pool[FLUX_FSM_STATIC_POOL_SIZE];
+static flux_fsm_static_free_t* flux_fsm_static_free;
+static int flux_fsm_static_ready;
+
+static void* flux_fsm_pool_sys_alloc(size_t size) {
+    if (!flux_fsm_static_ready) {
+        flux_fsm_static_free = (flux_fsm_static_free_t*)flux_fsm_static_pool;
+        flux_fsm_static_free->size = FLUX_FSM_STATIC_POOL_SIZE / FLUX_FSM_STATIC_UNIT
+                                     * FLUX_FSM_STATIC_UNIT;
+        flux_fsm_static_free->next = NULL;
+        flux_fsm_static_ready = 1;
+    }
+
+    if (size == 0 || size > FLUX_FSM_STATIC_POOL_SIZE) {
+        return NULL;
+    }
+    size = flux_fsm_static_round(size);
+
+    for (flux_fsm_static_free_t** link = &flux_fsm_static_free; *link; link = &(*link)->next) {
+        flux_fsm_static_free_t* f = *link;
+        if (f->size < size) {
+            continue;
+        }
+
+        if (f->size > size) {
+            flux_fsm_static_free_t* rest = (flux_fsm_static_free_t*)((unsigned char*)f + size);
+            rest->size = f->size - size;
+            rest->next = f->next;
+            *link = rest;
+        } else {
+            *link = f->next;
+        }
+        return f;
+    }
+
+    return NULL;
+}
+
+static void flux_fsm_pool_sys_free(void* p, size_t size) {
+    flux_fsm_static_free_t* chunk = p;
+    flux_fsm_static_free_t* prev = NULL;
+    flux_fsm_static_free_t* next = flux_fsm_static_free;
+
+    while (next && next < chunk) {
+        prev = next;
+        next = next->next;
+    }
+
+    chunk->size = flux_fsm_static_round(size);
+    chunk->next = next;
+    if (next && (unsigned char*)chunk + chunk->size == (unsigned char*)next) {
+        chunk->size += next->size;
+        chunk->next = next->next;
+    }
+
+    if (!prev) {
+        flux_fsm_static_free = chunk;
+    } else if ((unsigned char*)prev + prev->size == (unsigned char*)chunk) {
+        prev->size += chunk->size;
+        prev->next = chunk->next;
+    } else {
+        prev->next = chunk;
+    }
+}
+
+#else
+
+static void* flux_fsm_pool_sys_alloc(size_t size) {
+    return malloc(size);
+}
+
+static void flux_fsm_pool_sys_free(void* p, size_t size) {
+    (void)size;
+    free(p);
+}
+
+#endif
+
+/**
+ * @brief 创建内存池
+ * @param size 每块大小，0 表示使用 FLUX_FSM_POOL_SIZE
+ * @return 成功返回内存池指针，失败返回NULL
+ */
+flux_fsm_pool_t* flux_fsm_pool_create(size_t size) {
+    if (size == 0) {
+        size = FLUX_FSM_POOL_SIZE;
+    }
+    if (size < sizeof(flux_fsm_pool_t) + FLUX_FSM_POOL_ALIGNMENT) {
+        size = sizeof(flux_fsm_pool_t) + FLUX_FSM_POOL_ALIGNMENT;
+    }
+
+    flux_fsm_pool_t* pool = flux_fsm_pool_sys_alloc(size);
+    if (!pool) {
+        return NULL;
+    }
+
+    pool->block.last = (unsigned char*)pool + sizeof(flux_fsm_pool_t);
+    pool->block.end = (unsigned char*)pool + size;
+    pool->block.next = NULL;
+    pool->block.failed = 0;
+
+    size_t avail = size - sizeof(flux_fsm_pool_t);
+    pool->max = (avail < FLUX_FSM_MAX_ALLOC_FROM_POOL) ? avail : FLUX_FSM_MAX_ALLOC_FROM_POOL;
+
+    pool->current = &pool->block;
+    pool->large = NULL;
+    pool->cleanup = NULL;
+    pool->size = size;
+
+    return pool;
+}
+
+static void flux_fsm_pool_run_cleanup(flux_fsm_pool_t* pool) {
+    for (flux_fsm_pool_cleanup_t* c = pool->cleanup; c; c = c->next) {
+        c->handler(c->data);
+    }
+    pool->cleanup = NULL;
+
+    for (flux_fsm_pool_large_t* l = pool->large; l; l = l->next) {
+        if (l->alloc) {
+            flux_fsm_pool_sys_free(l->alloc, l->size);
+        }
+    }
+    pool->large = NULL;
+}
+
+void flux_fsm_pool_destroy(flux_fsm_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+
+    flux_fsm_pool_run_cleanup(pool);
+
+    flux_fsm_pool_block_t* b = pool->block.next;
+    while (b) {
+        flux_fsm_pool_block_t* next = b->next;
+        flux_fsm_pool_sys_free(b, pool->size);
+        b = next;
+    }
+
+    flux_fsm_pool_sys_free(pool, pool->size);
+}
+
+/**
+ * @brief 整池重置：执行清理回调、释放大块，所有块回到空状态以便复用
+ * @note 之前从池中分配的所有对象（含状态机与实例）随之失效
+ */
+void flux_fsm_pool_reset(flux_fsm_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+
+    flux_fsm_pool_run_cleanup(pool);
+
+    pool->block.last = (unsigned char*)pool + sizeof(flux_fsm_pool_t);
+    pool->block.failed = 0;
+    for (flux_fsm_pool_block_t* b = pool->block.next; b; b = b->next) {
+        b->last = (unsigned char*)b + sizeof(flux_fsm_pool_block_t);
+        b->failed = 0;
+    }
+
+    pool->current = &pool->block;
+}
+
+static void* flux_fsm_palloc_block(flux_fsm_pool_t* pool, size_t size) {
+    unsigned char* m = flux_fsm_pool_sys_alloc(pool->size);
+    if (!m) {
+        return NULL;
+    }
+
+    flux_fsm_pool_block_t* nb = (flux_fsm_pool_block_t*)m;
+    nb->end = m + pool->size;
+    nb->next = NULL;
+    nb->failed = 0;
+
+    m = flux_fsm_align_ptr(m + sizeof(flux_fsm_pool_block_t), FLUX_FSM_POOL_ALIGNMENT);
+    nb->last = m + size;
+
+    /* 追加到链尾，多次分配失败的块不再作为 current */
+    flux_fsm_pool_block_t* b = pool->current;
+    for (; b->next; b = b->next) {
+        if (b->failed++ > FLUX_FSM_POOL_MAX_FAILED) {
+            pool->current = b->next;
+        }
+    }
+    b->next = nb;
+
+    return m;
+}
+
+static void* flux_fsm_palloc_large(flux_fsm_pool_t* pool, size_t size) {
+    void* p = flux_fsm_pool_sys_alloc(size);
+    if (!p) {
+        return NULL;
+    }
+
+    flux_fsm_pool_large_t* large = flux_fsm_palloc(pool, sizeof(flux_fsm_pool_large_t));
+    if (!large) {
+        flux_fsm_pool_sys_free(p, size);
+        return NULL;
+    }
+
+    large->alloc = p;
+    large->size = size;
+    large->next = pool->large;
+    pool->large = large;
+
+    return p;
+}
+
+/**
+ * @brief 从内存池按 max_align_t 对齐分配
+ * @param pool 内存池
+ * @param size 分配大小
+ * @return 成功返回内存指针，失败返回NULL
+ * @note 超过 max 的请求单独分配并在重置/销毁时释放
+ */
+void* flux_fsm_palloc(flux_fsm_pool_t* pool, size_t size) {
+    if (!pool) {
+        return NULL;
+    }
+
+    if (size > pool->max) {
+        return flux_fsm_palloc_large(pool, size);
+    }
+
+    for (flux_fsm_pool_block_t* b = pool->current; b; b = b->next) {
+        unsigned char* m = flux_fsm_align_ptr(b->last, FLUX_FSM_POOL_ALIGNMENT);
+        if (m <= b->end && (size_t)(b->end - m) >= size) {
+            b->last = m + size;
+            return m;
+        }
+    }
+
+    return flux_fsm_palloc_block(pool, size);
+}
+
+void* flux_fsm_pcalloc(flux_fsm_pool_t* pool, size_t size) {
+    void* p = flux_fsm_palloc(pool, size);
+    if (p) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+/**
+ * @brief 注册清理回调，在池重置或销毁时按注册的逆序执行
+ */
+flux_fsm_rc_t flux_fsm_pool_cleanup_add(flux_fsm_pool_t* pool,
+    flux_fsm_pool_cleanup_pt handler, void* data)
+{
+    if (!pool || !handler) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_pool_cleanup_t* c = flux_fsm_palloc(pool, sizeof(flux_fsm_pool_cleanup_t));
+    if (!c) {
+        return FLUX_FSM_ERROR;
+    }
+
+    c->handler = handler;
+    c->data = data;
+    c->next = pool->cleanup;
+    pool->cleanup = c;
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 在内存池中创建状态机，转移表、处理器与索引也从池中分配
+ * @param pool 内存池
+ * @param initial_state 初始状态
+ * @param context 状态上下文指针
+ * @return 成功返回状态机指针，失败返回NULL
+ * @note flux_fsm_destroy 对池状态机不释放内存，统一由池重置/销毁回收
+ */
+flux_fsm_t* flux_fsm_create_from_pool(flux_fsm_pool_t* pool, int initial_state, void* context) {
+    flux_fsm_t* fsm = flux_fsm_pcalloc(pool, sizeof(flux_fsm_t));
+    if (!fsm) {
+        return NULL;
+    }
+
+    fsm->initial_state = initial_state;
+    fsm->current_state = initial_state;
+    fsm->context = context;
+    fsm->pool = pool;
+
+    return fsm;
+}
+
+static void flux_fsm_inst_cleanup(void* data) {
+    flux_fsm_inst_fini((flux_fsm_inst_t*)data);
+}
+
+/**
+ * @brief 在内存池中创建实例，池重置或销毁时自动释放对定义的引用
+ */
+flux_fsm_inst_t* flux_fsm_inst_create_from_pool(flux_fsm_pool_t* pool, flux_fsm_def_t* def,
+    int init_state, void* context)
+{
+    flux_fsm_inst_t* inst = flux_fsm_palloc(pool, sizeof(flux_fsm_inst_t));
+    if (!inst) {
+        return NULL;
+    }
+
+    if (flux_fsm_inst_init(inst, def, init_state, context) != FLUX_FSM_OK) {
+        return NULL;
+    }
+
+    if (flux_fsm_pool_cleanup_add(pool, flux_fsm_inst_cleanup, inst) != FLUX_FSM_OK) {
+        flux_fsm_inst_fini(inst);
+        return NULL;
+    }
+
+    return inst;
+}
+
+#endif /* FLUX_FSM_HAVE_POOL */
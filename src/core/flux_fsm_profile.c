@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+/* 将数组扩至不少于 need 项，新增部分清零 */
+static uint64_t* flux_fsm_profile_extend(flux_fsm_t* fsm, uint64_t* a, size_t* capacity, size_t need) {
+    size_t cap = *capacity ? *capacity : 8;
+    while (cap < need) {
+        cap *= 2;
+    }
+
+    uint64_t* na = flux_fsm_realloc(fsm->pool, a, *capacity * sizeof(uint64_t), cap * sizeof(uint64_t));
+    if (!na) {
+        return NULL;
+    }
+
+    memset(na + *capacity, 0, (cap - *capacity) * sizeof(uint64_t));
+    *capacity = cap;
+    return na;
+}
+
+/**
+ * @brief 扩容剖析数组以容纳 trans_idx 与 state，由 flux_fsm_profile_hit 调用
+ */
+flux_fsm_rc_t flux_fsm_profile_grow(flux_fsm_t* fsm, size_t trans_idx, size_t state) {
+    flux_fsm_profile_t* p = fsm->profile;
+
+    if (trans_idx >= p->hit_capacity) {
+        uint64_t* hits = flux_fsm_profile_extend(fsm, p->hits, &p->hit_capacity, trans_idx + 1);
+        if (!hits) {
+            return FLUX_FSM_ERROR;
+        }
+        p->hits = hits;
+    }
+
+    if (state >= p->state_capacity) {
+        uint64_t* dwell = flux_fsm_profile_extend(fsm, p->dwell, &p->state_capacity, state + 1);
+        if (!dwell) {
+            return FLUX_FSM_ERROR;
+        }
+        p->dwell = dwell;
+    }
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 启用转移命中与状态停留剖析
+ * @param fsm 状态机实例指针
+ * @return 成功返回 FLUX_FSM_OK
+ * @note 每次完成转移（flux_fsm_process_event、flux_fsm_exec_transition 等）
+ *       累加该转移的命中次数与源状态自进入以来的停留时间，额外开销为一次
+ *       时间戳与两次数组写入；未启用时只多一次指针判断。
+ *       数组按当前转移数与状态数分配，之后新增的转移或状态在首次命中时扩容。
+ *       重复调用清零计数，当前状态的停留从此刻开始计时
+ */
+flux_fsm_rc_t flux_fsm_profile_enable(flux_fsm_t* fsm) {
+    if (!fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_profile_disable(fsm);
+
+    flux_fsm_profile_t* p = flux_fsm_alloc(fsm->pool, sizeof(flux_fsm_profile_t));
+    if (!p) {
+        return FLUX_FSM_ERROR;
+    }
+    memset(p, 0, sizeof(flux_fsm_profile_t));
+    fsm->profile = p;
+
+    size_t states = fsm->state_count;
+    if (fsm->current_state >= 0 && (size_t)fsm->current_state >= states) {
+        states = (size_t)fsm->current_state + 1;
+    }
+    if (flux_fsm_profile_grow(fsm, fsm->transition_count ? fsm->transition_count - 1 : 0,
+                              states ? states - 1 : 0) != FLUX_FSM_OK) {
+        flux_fsm_profile_disable(fsm);
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_ns_per_tick();
+    p->entered = flux_fsm_ticks();
+    return FLUX_FSM_OK;
+}
+
+void flux_fsm_profile_disable(flux_fsm_t* fsm) {
+    if (!fsm || !fsm->profile) {
+        return;
+    }
+
+    flux_fsm_free(fsm->pool, fsm->profile->hits);
+    flux_fsm_free(fsm->pool, fsm->profile->dwell);
+    flux_fsm_free(fsm->pool, fsm->profile);
+    fsm->profile = NULL;
+}
+
+/* 清零全部计数，当前状态的停留从此刻重新计时 */
+void flux_fsm_profile_reset(flux_fsm_t* fsm) {
+    if (!fsm || !fsm->profile) {
+        return;
+    }
+
+    flux_fsm_profile_t* p = fsm->profile;
+    memset(p->hits, 0, p->hit_capacity * sizeof(uint64_t));
+    memset(p->dwell, 0, p->state_capacity * sizeof(uint64_t));
+    p->entered = flux_fsm_ticks();
+}
+
+/**
+ * @brief 读取第 trans_idx 条转移完成的次数
+ * @return 未启用剖析或序号越界返回 0
+ */
+uint64_t flux_fsm_profile_hits(const flux_fsm_t* fsm, size_t trans_idx) {
+    if (!fsm || !fsm->profile || trans_idx >= fsm->profile->hit_capacity) {
+        return 0;
+    }
+    return fsm->profile->hits[trans_idx];
+}
+
+/**
+ * @brief 读取状态的累计停留时间（纳秒）
+ * @return 当前状态包含截至调用时刻的这次停留；未启用剖析返回 0
+ */
+uint64_t flux_fsm_profile_dwell_ns(const flux_fsm_t* fsm, int state) {
+    if (!fsm || !fsm->profile || state < 0) {
+        return 0;
+    }
+
+    const flux_fsm_profile_t* p = fsm->profile;
+    uint64_t ticks = (size_t)state < p->state_capacity ? p->dwell[state] : 0;
+    if (state == fsm->current_state) {
+        ticks += flux_fsm_ticks() - p->entered;
+    }
+    return (uint64_t)((double)ticks * flux_fsm_ns_per_tick());
+}
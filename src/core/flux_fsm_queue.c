@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "flux_fsm_queue.h"
+#include "flux_fsm_internal.h"
+
+#define FLUX_FSM_CACHE_LINE  64
+
+typedef struct {
+    atomic_size_t seq;
+    flux_fsm_event_t event;
+} flux_fsm_queue_cell_t;
+
+/**
+ * @struct flux_fsm_queue_s
+ * @brief 有界 MPSC 环形队列
+ *
+ * 生产者先在 count 上预留容量，再在 tail 上领取票号，两步均为
+ * fetch_add，因此投递是无等待的；预留成功即保证票号对应的槽位
+ * 已被消费者释放。消费者按票号顺序读取，槽位 seq == 票号 + 1
+ * 表示数据已写入。
+ *
+ * @var count 已预留但尚未被消费的槽位数（生产者写，消费者减）
+ * @var tail 下一个票号（生产者）
+ * @var owned 消费者令牌，持有者才可调用 drain
+ * @var head 下一个待消费票号（仅消费者）
+ * @var mask 容量 - 1
+ */
+struct flux_fsm_queue_s {
+    atomic_size_t count;
+    char pad0[FLUX_FSM_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t tail;
+    char pad1[FLUX_FSM_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_int owned;
+    char pad2[FLUX_FSM_CACHE_LINE - sizeof(atomic_int)];
+    size_t head;
+    size_t mask;
+    flux_fsm_queue_cell_t cells[];
+};
+
+/**
+ * @brief 为状态机创建事件队列
+ * @param fsm 状态机实例指针
+ * @param capacity 队列容量，向上取整为 2 的幂
+ * @return 成功返回 FLUX_FSM_OK，已存在队列返回 FLUX_FSM_ERROR
+ * @note 应在投递事件之前、由拥有状态机的线程调用
+ */
+flux_fsm_rc_t flux_fsm_queue_init(flux_fsm_t* fsm, size_t capacity) {
+    if (!fsm || capacity == 0) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (fsm->queue) {
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t cap = 1;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    flux_fsm_queue_t* q = flux_fsm_alloc(fsm->pool,
+        sizeof(flux_fsm_queue_t) + cap * sizeof(flux_fsm_queue_cell_t));
+    if (!q) {
+        return FLUX_FSM_ERROR;
+    }
+
+    atomic_init(&q->count, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->owned, 0);
+    q->head = 0;
+    q->mask = cap - 1;
+
+    /* 槽位 i 初始 seq 为 i，不等于任何已发布票号 (t + 1) */
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&q->cells[i].seq, i);
+    }
+
+    fsm->queue = q;
+    return FLUX_FSM_OK;
+}
+
+void flux_fsm_queue_free(flux_fsm_t* fsm) {
+    flux_fsm_free(fsm->pool, fsm->queue);
+    fsm->queue = NULL;
+}
+
+/**
+ * @brief 从任意线程投递事件
+ * @param fsm 状态机实例指针
+ * @param event 待投递事件
+ * @return 成功返回 FLUX_FSM_OK，队列满返回 FLUX_FSM_ERROR
+ * @note 无等待：两次 fetch_add 加一次写入，不会因其他生产者而重试
+ */
+flux_fsm_rc_t flux_fsm_post_event(flux_fsm_t* fsm, flux_fsm_event_t event) {
+    if (!fsm || !fsm->queue) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_queue_t* q = fsm->queue;
+
+    /* 预留容量；失败时归还，最多造成其他生产者短暂误判为满 */
+    if (atomic_fetch_add_explicit(&q->count, 1, memory_order_acquire) > q->mask) {
+        atomic_fetch_sub_explicit(&q->count, 1, memory_order_relaxed);
+        return FLUX_FSM_ERROR;
+    }
+
+    /*
+     * acq_rel 使票号链传递同步：更早领号者的容量预留（与消费者的归还同步）
+     * 先于本次写入槽位
+     */
+    size_t pos = atomic_fetch_add_explicit(&q->tail, 1, memory_order_acq_rel);
+    flux_fsm_queue_cell_t* cell = &q->cells[pos & q->mask];
+
+    cell->event = event;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 在拥有状态机的线程上执行已投递的事件
+ * @param fsm 状态机实例指针
+ * @param max 最多处理的事件数，0 表示处理到队列为空
+ * @return 实际出队的事件数
+ * @note 同一时刻只能有一个线程调用；事件按投递顺序经
+ *       flux_fsm_process_event 执行，无匹配转移的事件被丢弃
+ */
+size_t flux_fsm_drain(flux_fsm_t* fsm, size_t max) {
+    if (!fsm || !fsm->queue) {
+        return 0;
+    }
+
+    flux_fsm_queue_t* q = fsm->queue;
+    size_t n = 0;
+
+    while (max == 0 || n < max) {
+        flux_fsm_queue_cell_t* cell = &q->cells[q->head & q->mask];
+        if (atomic_load_explicit(&cell->seq, memory_order_acquire) != q->head + 1) {
+            break;
+        }
+
+        flux_fsm_event_t event = cell->event;
+        q->head++;
+
+        /* 先读出事件再归还容量，使下一轮生产者可以安全覆盖该槽位 */
+        atomic_fetch_sub_explicit(&q->count, 1, memory_order_release);
+
+        flux_fsm_process_event(fsm, event);
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ * @brief 返回已预留但尚未出队的事件数（近似值，可能包含正在写入的事件）
+ */
+size_t flux_fsm_pending(const flux_fsm_t* fsm) {
+    if (!fsm || !fsm->queue) {
+        return 0;
+    }
+
+    return atomic_load_explicit(&fsm->queue->count, memory_order_relaxed);
+}
+
+/**
+ * @brief 尝试成为队列的唯一消费者
+ * @return 成功返回 1，已被其他线程持有返回 0
+ * @note 供调度器在多个线程之间转移状态机的所有权，保证同一时刻只有
+ *       一个线程执行 drain；持有者处理完毕后调用 flux_fsm_queue_release
+ */
+int flux_fsm_queue_acquire(flux_fsm_t* fsm) {
+    if (!fsm || !fsm->queue) {
+        return 0;
+    }
+
+    return atomic_exchange_explicit(&fsm->queue->owned, 1, memory_order_acquire) == 0;
+}
+
+void flux_fsm_queue_release(flux_fsm_t* fsm) {
+    if (!fsm || !fsm->queue) {
+        return;
+    }
+
+    atomic_store_explicit(&fsm->queue->owned, 0, memory_order_release);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_SIMD)
+#include <immintrin.h>
+#endif
+
+typedef int (*flux_fsm_keyscan_pt)(const uint32_t* keys, size_t n, size_t i, uint32_t key);
+
+static int flux_fsm_keyscan_scalar(const uint32_t* keys, size_t n, size_t i, uint32_t key) {
+    for (; i < n; i++) {
+        if (keys[i] == key) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+#if defined(FLUX_FSM_HAVE_SIMD)
+
+/* 每轮比较 8 个键：两次 128 位比较合并为 8 位掩码 */
+static int flux_fsm_keyscan_sse2(const uint32_t* keys, size_t n, size_t i, uint32_t key) {
+    __m128i k = _mm_set1_epi32((int)key);
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + i)), k);
+        __m128i b = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(keys + i + 4)), k);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(a))
+                 | _mm_movemask_ps(_mm_castsi128_ps(b)) << 4;
+        if (mask) {
+            return (int)(i + (size_t)__builtin_ctz((unsigned)mask));
+        }
+    }
+
+    return flux_fsm_keyscan_scalar(keys, n, i, key);
+}
+
+/* 每轮比较 16 个键：两次 256 位比较合并为 16 位掩码 */
+__attribute__((target("avx2")))
+static int flux_fsm_keyscan_avx2(const uint32_t* keys, size_t n, size_t i, uint32_t key) {
+    __m256i k = _mm256_set1_epi32((int)key);
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(keys + i)), k);
+        __m256i b = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(keys + i + 8)), k);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(a))
+                      | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(b)) << 8;
+        if (mask) {
+            return (int)(i + (size_t)__builtin_ctz(mask));
+        }
+    }
+
+    return flux_fsm_keyscan_sse2(keys, n, i, key);
+}
+
+static flux_fsm_keyscan_pt flux_fsm_keyscan_select(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return flux_fsm_keyscan_avx2;
+    }
+    return flux_fsm_keyscan_sse2;
+}
+
+#else
+
+static flux_fsm_keyscan_pt flux_fsm_keyscan_select(void) {
+    return flux_fsm_keyscan_scalar;
+}
+
+#endif /* FLUX_FSM_HAVE_SIMD */
+
+/* 首次调用时按 CPU 特性选定实现；并发首次调用的结果相同，重复选择无害 */
+static _Atomic(flux_fsm_keyscan_pt) flux_fsm_keyscan_impl;
+
+/**
+ * @brief 在压缩键列中查找首个等于 key 的位置
+ * @param keys 键列
+ * @param n 键数量
+ * @param i 起始位置
+ * @param key 待查找的键
+ * @return 首个匹配位置，不存在返回 -1
+ * @note 键只保留 from 与 event 的低 16 位，命中后需由调用方核对完整的转移行
+ */
+int flux_fsm_keyscan(const uint32_t* keys, size_t n, size_t i, uint32_t key) {
+    flux_fsm_keyscan_pt scan = atomic_load_explicit(&flux_fsm_keyscan_impl, memory_order_relaxed);
+    if (!scan) {
+        scan = flux_fsm_keyscan_select();
+        atomic_store_explicit(&flux_fsm_keyscan_impl, scan, memory_order_relaxed);
+    }
+
+    return scan(keys, n, i, key);
+}
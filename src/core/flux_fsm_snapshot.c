@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_MMAP)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * 实例状态快照，按列存放：
+ *
+ *   header      flux_fsm_snapshot_header_t
+ *   HASHES      def_count × u64    各定义的结构哈希
+ *   IDS         count × u64        调用方提供的实例标识（flags & IDS 时存在）
+ *   STATES      count × i32        当前状态
+ *   DEFS        count × u16        实例所引用定义在 HASHES 中的序号
+ *
+ * 各列按元素宽度递减排列，从 8 字节对齐的起始地址开始时无需填充。
+ */
+
+#define FLUX_FSM_SNAPSHOT_MAGIC    "FLUXSNP"
+#define FLUX_FSM_SNAPSHOT_VERSION  1
+#define FLUX_FSM_SNAPSHOT_ENDIAN   0x01020304u
+#define FLUX_FSM_SNAPSHOT_IDS      0x1u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t count;
+    uint64_t size;
+    uint32_t def_count;
+    uint32_t flags;
+} flux_fsm_snapshot_header_t;
+
+/*
+ * 将实例映射到定义序号；定义按结构哈希去重，连续引用同一定义的实例
+ * 只比较指针。hashes 容量为 FLUX_FSM_SNAPSHOT_DEFS
+ */
+typedef struct {
+    uint64_t* hashes;
+    uint32_t count;
+    const flux_fsm_def_t* last_def;
+    uint32_t last_id;
+} flux_fsm_snapshot_defs_t;
+
+static int flux_fsm_snapshot_def_id(flux_fsm_snapshot_defs_t* defs, const flux_fsm_def_t* def) {
+    if (def && def == defs->last_def) {
+        return (int)defs->last_id;
+    }
+
+    uint64_t hash = flux_fsm_def_hash(def);
+    if (!hash) {
+        return -1;
+    }
+
+    uint32_t id = 0;
+    while (id < defs->count && defs->hashes[id] != hash) {
+        id++;
+    }
+    if (id == defs->count) {
+        if (defs->count == FLUX_FSM_SNAPSHOT_DEFS) {
+            return -1;
+        }
+        defs->hashes[defs->count++] = hash;
+    }
+
+    defs->last_def = def;
+    defs->last_id = id;
+    return (int)id;
+}
+
+static size_t flux_fsm_snapshot_layout(size_t def_count, size_t n, int with_ids) {
+    return sizeof(flux_fsm_snapshot_header_t)
+         + def_count * sizeof(uint64_t)
+         + (with_ids ? n * sizeof(uint64_t) : 0)
+         + n * sizeof(int32_t)
+         + n * sizeof(uint16_t);
+}
+
+/**
+ * @brief 计算快照所需的字节数
+ * @param insts 实例数组，均须引用已封存的定义
+ * @param n 实例数量
+ * @param ids 实例标识，可为 NULL
+ * @return 字节数；存在未封存的定义或不同定义超过 FLUX_FSM_SNAPSHOT_DEFS 时返回 0
+ */
+size_t flux_fsm_snapshot_size(const flux_fsm_inst_t* insts, size_t n, const uint64_t* ids) {
+    if (!insts && n) {
+        return 0;
+    }
+
+    uint64_t hashes[FLUX_FSM_SNAPSHOT_DEFS];
+    flux_fsm_snapshot_defs_t defs = {hashes, 0, NULL, 0};
+
+    for (size_t i = 0; i < n; i++) {
+        if (flux_fsm_snapshot_def_id(&defs, insts[i].def) < 0) {
+            return 0;
+        }
+    }
+
+    return flux_fsm_snapshot_layout(defs.count, n, ids != NULL);
+}
+
+/**
+ * @brief 将实例状态编码到调用方缓冲区
+ * @param buf 8 字节对齐的缓冲区
+ * @param size 缓冲区字节数，不小于 flux_fsm_snapshot_size 的结果
+ * @param insts 实例数组
+ * @param n 实例数量
+ * @param ids 实例标识，可为 NULL；提供时恢复时逐一核对
+ * @return 成功返回 FLUX_FSM_OK，缓冲区不足或定义无效返回 FLUX_FSM_ERROR
+ * @note 不分配内存：定义去重表位于栈上，各列直接写入 buf
+ */
+flux_fsm_rc_t flux_fsm_snapshot_encode(void* buf, size_t size, const flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids)
+{
+    if (!buf || (!insts && n)) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if ((uintptr_t)buf % sizeof(uint64_t) || size < sizeof(flux_fsm_snapshot_header_t)) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_snapshot_header_t* h = buf;
+    uint64_t* hashes = (uint64_t*)(h + 1);
+    flux_fsm_snapshot_defs_t defs = {hashes, 0, NULL, 0};
+
+    /* 第一遍：定义去重表直接写入 HASHES 列，先确认容量 */
+    size_t avail = (size - sizeof(*h)) / sizeof(uint64_t);
+    uint64_t local[FLUX_FSM_SNAPSHOT_DEFS];
+    if (avail < FLUX_FSM_SNAPSHOT_DEFS) {
+        defs.hashes = local;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (flux_fsm_snapshot_def_id(&defs, insts[i].def) < 0) {
+            return FLUX_FSM_ERROR;
+        }
+    }
+
+    size_t total = flux_fsm_snapshot_layout(defs.count, n, ids != NULL);
+    if (size < total) {
+        return FLUX_FSM_ERROR;
+    }
+    if (defs.hashes != hashes) {
+        memcpy(hashes, local, defs.count * sizeof(uint64_t));
+        defs.hashes = hashes;
+    }
+
+    uint64_t* id_col = hashes + defs.count;
+    int32_t* states = (int32_t*)(ids ? id_col + n : id_col);
+    uint16_t* def_col = (uint16_t*)(states + n);
+
+    if (ids) {
+        memcpy(id_col, ids, n * sizeof(uint64_t));
+    }
+
+    /* 第二遍：写入状态列与定义序号列 */
+    defs.last_def = NULL;
+    for (size_t i = 0; i < n; i++) {
+        states[i] = insts[i].current_state;
+        def_col[i] = (uint16_t)flux_fsm_snapshot_def_id(&defs, insts[i].def);
+    }
+
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, FLUX_FSM_SNAPSHOT_MAGIC, sizeof(FLUX_FSM_SNAPSHOT_MAGIC));
+    h->version = FLUX_FSM_SNAPSHOT_VERSION;
+    h->endian = FLUX_FSM_SNAPSHOT_ENDIAN;
+    h->count = n;
+    h->size = total;
+    h->def_count = defs.count;
+    h->flags = ids ? FLUX_FSM_SNAPSHOT_IDS : 0;
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 由快照恢复实例状态
+ * @param buf 8 字节对齐的快照
+ * @param size 快照字节数
+ * @param insts 待恢复的实例数组，须已引用各自的定义
+ * @param n 实例数量，须与快照一致
+ * @param ids 实例标识，可为 NULL；提供时快照中须含标识且逐一相等
+ * @return 成功返回 FLUX_FSM_OK；格式、版本或字节序不符返回 FLUX_FSM_ERROR；
+ *         实例数量、标识或定义哈希不一致返回 FLUX_FSM_INVALID_STATE
+ * @note 全部核对通过后才写入状态，失败时实例保持不变
+ */
+flux_fsm_rc_t flux_fsm_snapshot_decode(const void* buf, size_t size, flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids)
+{
+    if (!buf || (!insts && n)) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    const flux_fsm_snapshot_header_t* h = buf;
+    if ((uintptr_t)buf % sizeof(uint64_t) || size < sizeof(*h)
+        || memcmp(h->magic, FLUX_FSM_SNAPSHOT_MAGIC, sizeof(FLUX_FSM_SNAPSHOT_MAGIC)) != 0
+        || h->version != FLUX_FSM_SNAPSHOT_VERSION
+        || h->endian != FLUX_FSM_SNAPSHOT_ENDIAN
+        || h->def_count > FLUX_FSM_SNAPSHOT_DEFS
+        || h->count > SIZE_MAX / 16
+        || h->size > size
+        || h->size != flux_fsm_snapshot_layout(h->def_count, (size_t)h->count,
+                                               (h->flags & FLUX_FSM_SNAPSHOT_IDS) != 0)) {
+        return FLUX_FSM_ERROR;
+    }
+
+    int has_ids = (h->flags & FLUX_FSM_SNAPSHOT_IDS) != 0;
+    if (h->count != n || (ids && !has_ids)) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+
+    const uint64_t* hashes = (const uint64_t*)(h + 1);
+    const uint64_t* id_col = hashes + h->def_count;
+    const int32_t* states = (const int32_t*)(has_ids ? id_col + n : id_col);
+    const uint16_t* def_col = (const uint16_t*)(states + n);
+
+    if (ids && memcmp(id_col, ids, n * sizeof(uint64_t)) != 0) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+
+    const flux_fsm_def_t* last_def = NULL;
+    uint16_t last_id = 0;
+    for (size_t i = 0; i < n; i++) {
+        const flux_fsm_def_t* def = insts[i].def;
+        if (def && def == last_def && def_col[i] == last_id) {
+            continue;
+        }
+        if (def_col[i] >= h->def_count || !def || flux_fsm_def_hash(def) != hashes[def_col[i]]) {
+            return FLUX_FSM_INVALID_STATE;
+        }
+        last_def = def;
+        last_id = def_col[i];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        insts[i].current_state = states[i];
+    }
+
+    return FLUX_FSM_OK;
+}
+
+#if defined(FLUX_FSM_HAVE_MMAP)
+
+/* 同步 filename 所在目录，使 rename 产生的目录项落盘；文件系统不支持时忽略 */
+static int flux_fsm_snapshot_sync_dir(const char* filename) {
+    const char* slash = strrchr(filename, '/');
+    char* dir = slash ? malloc((size_t)(slash - filename) + 2) : NULL;
+
+    if (slash && !dir) {
+        return -1;
+    }
+    if (dir) {
+        size_t len = slash == filename ? 1 : (size_t)(slash - filename);
+        memcpy(dir, filename, len);
+        dir[len] = '\0';
+    }
+
+    int fd = open(dir ? dir : ".", O_RDONLY);
+    free(dir);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int rc = fsync(fd) == 0 || errno == EINVAL ? 0 : -1;
+    close(fd);
+    return rc;
+}
+
+#endif
+
+/**
+ * @brief 将实例状态写入快照文件
+ * @param filename 目标路径，先写入 filename.tmp 再原子替换
+ * @return 成功返回 FLUX_FSM_OK，失败返回 FLUX_FSM_ERROR
+ * @note 有 mmap 时直接编码到映射的文件页面，不分配中间缓冲区。替换前以
+ *       msync/fsync 落盘临时文件，替换后同步所在目录，崩溃后目标要么是旧
+ *       快照，要么是完整的新快照
+ */
+flux_fsm_rc_t flux_fsm_snapshot_save(const char* filename, const flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids)
+{
+    if (!filename || (!insts && n)) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    size_t size = flux_fsm_snapshot_size(insts, n, ids);
+    char* path = malloc(strlen(filename) + sizeof(".tmp"));
+    if (!size || !path) {
+        free(path);
+        return FLUX_FSM_ERROR;
+    }
+    strcpy(path, filename);
+    strcat(path, ".tmp");
+
+    flux_fsm_rc_t rc = FLUX_FSM_ERROR;
+
+#if defined(FLUX_FSM_HAVE_MMAP)
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        void* buf = ftruncate(fd, (off_t)size) == 0
+            ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+        if (buf != MAP_FAILED) {
+            rc = flux_fsm_snapshot_encode(buf, size, insts, n, ids);
+            if (rc == FLUX_FSM_OK && msync(buf, size, MS_SYNC) != 0) {
+                rc = FLUX_FSM_ERROR;
+            }
+            if (munmap(buf, size) != 0) {
+                rc = FLUX_FSM_ERROR;
+            }
+        }
+        if (rc == FLUX_FSM_OK && fsync(fd) != 0) {
+            rc = FLUX_FSM_ERROR;
+        }
+        if (close(fd) != 0) {
+            rc = FLUX_FSM_ERROR;
+        }
+    }
+#else
+    uint64_t* buf = malloc(size);
+    FILE* file = buf ? fopen(path, "wb") : NULL;
+    if (file) {
+        rc = flux_fsm_snapshot_encode(buf, size, insts, n, ids);
+        if (rc == FLUX_FSM_OK && fwrite(buf, 1, size, file) != size) {
+            rc = FLUX_FSM_ERROR;
+        }
+        if (fclose(file) != 0) {
+            rc = FLUX_FSM_ERROR;
+        }
+    }
+    free(buf);
+#endif
+
+    if (rc == FLUX_FSM_OK && rename(path, filename) != 0) {
+        rc = FLUX_FSM_ERROR;
+    }
+    if (rc != FLUX_FSM_OK) {
+        remove(path);
+    }
+#if defined(FLUX_FSM_HAVE_MMAP)
+    if (rc == FLUX_FSM_OK && flux_fsm_snapshot_sync_dir(filename) != 0) {
+        rc = FLUX_FSM_ERROR;
+    }
+#endif
+
+    free(path);
+    return rc;
+}
+
+/**
+ * @brief 由快照文件恢复实例状态，核对规则同 flux_fsm_snapshot_decode
+ * @note 有 mmap 时原地读取映射的文件页面
+ */
+flux_fsm_rc_t flux_fsm_snapshot_restore(const char* filename, flux_fsm_inst_t* insts,
+    size_t n, const uint64_t* ids)
+{
+    if (!filename || (!insts && n)) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_rc_t rc = FLUX_FSM_ERROR;
+
+#if defined(FLUX_FSM_HAVE_MMAP)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(flux_fsm_snapshot_header_t)) {
+        void* buf = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (buf != MAP_FAILED) {
+            rc = flux_fsm_snapshot_decode(buf, (size_t)st.st_size, insts, n, ids);
+            munmap(buf, (size_t)st.st_size);
+        }
+    }
+    close(fd);
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return FLUX_FSM_ERROR;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint64_t* buf = len >= (long)sizeof(flux_fsm_snapshot_header_t) ? malloc((size_t)len) : NULL;
+    if (buf && fread(buf, 1, (size_t)len, file) == (size_t)len) {
+        rc = flux_fsm_snapshot_decode(buf, (size_t)len, insts, n, ids);
+    }
+    free(buf);
+    fclose(file);
+#endif
+
+    return rc;
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flux_fsm_trace.h"
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_TRACE)
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @struct flux_fsm_trace_ring_t
+ * @brief 线程私有的追踪文件映射
+ *
+ * @var header 映射起始处的文件头
+ * @var records 紧随文件头的记录槽位
+ * @var mask 槽位数 - 1
+ * @var size 映射字节数
+ * @var generation 打开时的追踪代数，与全局代数不一致时重新打开
+ */
+typedef struct {
+    flux_fsm_trace_header_t* header;
+    flux_fsm_trace_record_t* records;
+    uint64_t mask;
+    size_t size;
+    unsigned generation;
+} flux_fsm_trace_ring_t;
+
+atomic_int flux_fsm_trace_on;
+
+static pthread_mutex_t flux_fsm_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t flux_fsm_trace_once = PTHREAD_ONCE_INIT;
+static pthread_key_t flux_fsm_trace_key;
+static char* flux_fsm_trace_prefix;
+static size_t flux_fsm_trace_capacity;
+static atomic_uint flux_fsm_trace_generation;
+static atomic_uint flux_fsm_trace_threads;
+
+static FLUX_FSM_TLS flux_fsm_trace_ring_t* flux_fsm_trace_ring;
+
+/* 打开失败的代数 + 1，避免每次转移都重试 */
+static FLUX_FSM_TLS unsigned flux_fsm_trace_failed;
+
+static int64_t flux_fsm_trace_realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void flux_fsm_trace_close(flux_fsm_trace_ring_t* ring) {
+    if (ring) {
+        munmap(ring->header, ring->size);
+        free(ring);
+    }
+}
+
+/* 线程退出时解除映射，已写入的记录保留在文件中 */
+static void flux_fsm_trace_thread_exit(void* data) {
+    flux_fsm_trace_close(data);
+}
+
+static void flux_fsm_trace_init_once(void) {
+    pthread_key_create(&flux_fsm_trace_key, flux_fsm_trace_thread_exit);
+    flux_fsm_ns_per_tick();
+}
+
+/**
+ * @brief 为调用线程创建追踪文件并映射，替换该线程旧的映射
+ * @return 成功返回映射，追踪未开启或文件无法创建返回 NULL
+ */
+static flux_fsm_trace_ring_t* flux_fsm_trace_open(void) {
+    char path[4096];
+    size_t capacity;
+    unsigned generation;
+
+    pthread_mutex_lock(&flux_fsm_trace_lock);
+    if (!atomic_load_explicit(&flux_fsm_trace_on, memory_order_relaxed)) {
+        pthread_mutex_unlock(&flux_fsm_trace_lock);
+        return NULL;
+    }
+    generation = atomic_load_explicit(&flux_fsm_trace_generation, memory_order_relaxed);
+    capacity = flux_fsm_trace_capacity;
+    unsigned thread = atomic_fetch_add_explicit(&flux_fsm_trace_threads, 1, memory_order_relaxed);
+    int len = snprintf(path, sizeof(path), "%s.%ld.%u.trace",
+                       flux_fsm_trace_prefix, (long)getpid(), thread);
+    pthread_mutex_unlock(&flux_fsm_trace_lock);
+
+    flux_fsm_trace_failed = generation + 1;
+    if (len < 0 || (size_t)len >= sizeof(path)) {
+        return NULL;
+    }
+
+    size_t size = sizeof(flux_fsm_trace_header_t) + capacity * sizeof(flux_fsm_trace_record_t);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    void* map = ftruncate(fd, (off_t)size) == 0
+        ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    flux_fsm_trace_ring_t* ring = malloc(sizeof(flux_fsm_trace_ring_t));
+    if (!ring) {
+        munmap(map, size);
+        return NULL;
+    }
+
+    flux_fsm_trace_header_t* h = map;
+    memcpy(h->magic, FLUX_FSM_TRACE_MAGIC, sizeof(FLUX_FSM_TRACE_MAGIC));
+    h->version = FLUX_FSM_TRACE_VERSION;
+    h->record_size = sizeof(flux_fsm_trace_record_t);
+    h->capacity = capacity;
+    h->head = 0;
+    h->ns_base = flux_fsm_trace_realtime_ns();
+    h->tick_base = flux_fsm_ticks();
+    h->ns_per_tick = flux_fsm_ns_per_tick();
+    h->pid = (uint32_t)getpid();
+    h->thread = thread;
+
+    ring->header = h;
+    ring->records = (flux_fsm_trace_record_t*)(h + 1);
+    ring->mask = capacity - 1;
+    ring->size = size;
+    ring->generation = generation;
+
+    flux_fsm_trace_close(flux_fsm_trace_ring);
+    flux_fsm_trace_ring = ring;
+    flux_fsm_trace_failed = 0;
+    pthread_setspecific(flux_fsm_trace_key, ring);
+
+    return ring;
+}
+
+/**
+ * @brief 追加一条追踪记录，由 flux_fsm_trace 宏在追踪开启时调用
+ * @note 快速路径只有一次线程局部读取、一次代数比较、一次时间戳与
+ *       32 字节写入；head 在记录写完后递增，崩溃时不会暴露半条记录
+ */
+void flux_fsm_trace_write(uint64_t machine, int from, int event, int to, flux_fsm_rc_t rc) {
+    flux_fsm_trace_ring_t* ring = flux_fsm_trace_ring;
+    unsigned generation = atomic_load_explicit(&flux_fsm_trace_generation, memory_order_relaxed);
+
+    if (!ring || ring->generation != generation) {
+        if (flux_fsm_trace_failed == generation + 1) {
+            return;
+        }
+        ring = flux_fsm_trace_open();
+        if (!ring) {
+            return;
+        }
+    }
+
+    flux_fsm_trace_header_t* h = ring->header;
+    uint64_t head = h->head;
+    flux_fsm_trace_record_t* rec = &ring->records[head & ring->mask];
+
+    rec->ticks = flux_fsm_ticks();
+    rec->machine = machine;
+    rec->from = from;
+    rec->event = event;
+    rec->to = to;
+    rec->rc = rc;
+
+    atomic_signal_fence(memory_order_release);
+    h->head = head + 1;
+}
+
+/**
+ * @brief 开启转移追踪
+ * @param prefix 文件名前缀，可含目录，各线程的文件为 <prefix>.<pid>.<n>.trace
+ * @param records 每个线程的记录槽位数，向上取整为 2 的幂，0 表示 FLUX_FSM_TRACE_RECORDS
+ * @return 成功返回 FLUX_FSM_OK；已开启或调用线程的文件无法创建返回 FLUX_FSM_ERROR
+ * @note 首次开启时校准时钟，耗时约 5ms；调用线程的文件立即创建，
+ *       其他线程在第一次执行转移时创建
+ */
+flux_fsm_rc_t flux_fsm_trace_start(const char* prefix, size_t records) {
+    if (!prefix) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    size_t capacity = 1;
+    while (capacity < (records ? records : FLUX_FSM_TRACE_RECORDS)) {
+        capacity <<= 1;
+    }
+
+    char* copy = malloc(strlen(prefix) + 1);
+    if (!copy) {
+        return FLUX_FSM_ERROR;
+    }
+    strcpy(copy, prefix);
+
+    pthread_once(&flux_fsm_trace_once, flux_fsm_trace_init_once);
+
+    pthread_mutex_lock(&flux_fsm_trace_lock);
+    if (atomic_load_explicit(&flux_fsm_trace_on, memory_order_relaxed)) {
+        pthread_mutex_unlock(&flux_fsm_trace_lock);
+        free(copy);
+        return FLUX_FSM_ERROR;
+    }
+
+    free(flux_fsm_trace_prefix);
+    flux_fsm_trace_prefix = copy;
+    flux_fsm_trace_capacity = capacity;
+    atomic_store_explicit(&flux_fsm_trace_threads, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&flux_fsm_trace_generation, 1, memory_order_relaxed);
+    atomic_store_explicit(&flux_fsm_trace_on, 1, memory_order_release);
+    pthread_mutex_unlock(&flux_fsm_trace_lock);
+
+    if (!flux_fsm_trace_open()) {
+        flux_fsm_trace_stop();
+        return FLUX_FSM_ERROR;
+    }
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 关闭转移追踪
+ * @note 立即解除调用线程的映射；其他线程的映射在线程退出或下次开启后
+ *       首次写入时解除，其中已写入的记录均已在文件中
+ */
+void flux_fsm_trace_stop(void) {
+    pthread_mutex_lock(&flux_fsm_trace_lock);
+    atomic_store_explicit(&flux_fsm_trace_on, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&flux_fsm_trace_generation, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&flux_fsm_trace_lock);
+
+    if (flux_fsm_trace_ring) {
+        pthread_setspecific(flux_fsm_trace_key, NULL);
+        flux_fsm_trace_close(flux_fsm_trace_ring);
+        flux_fsm_trace_ring = NULL;
+    }
+}
+
+int flux_fsm_trace_enabled(void) {
+    return atomic_load_explicit(&flux_fsm_trace_on, memory_order_relaxed);
+}
+
+#endif /* FLUX_FSM_HAVE_TRACE */
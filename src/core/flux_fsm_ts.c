@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include "flux_fsm_core.h"
+#include "flux_fsm_internal.h"
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+
+/* CAS 失败：状态已被其他线程改变，*from 为最新状态 */
+#define FLUX_FSM_TS_LOST  1
+
+/**
+ * @brief 以 from 为预期源状态尝试提交一次转移
+ * @param ts 实例
+ * @param from 预期源状态，CAS 失败时被更新为当前状态
+ * @param event 事件
+ * @return 成功返回 FLUX_FSM_OK，CAS 失败返回 FLUX_FSM_TS_LOST，
+ *         否则返回查找或守卫的失败结果
+ * @note 守卫在提交之前求值，可能因重试被调用多次，应无副作用；
+ *       动作与源状态处理器只由赢得 CAS 的线程执行一次
+ */
+static int flux_fsm_ts_commit(flux_fsm_ts_t* ts, int* from, flux_fsm_event_t event) {
+    const flux_fsm_t* table = &ts->def->table;
+    if (flux_fsm_event_rejected(table, *from, event)) {
+        return FLUX_FSM_ERROR;
+    }
+
+    int trans_idx = *from >= 0
+        ? flux_fsm_index_lookup(table->index, *from, event)
+        : flux_fsm_scan(table, *from, event);
+    if (trans_idx < 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_transition_t tmp;
+    const flux_fsm_transition_t* trans = flux_fsm_transition_at(table, (size_t)trans_idx, &tmp);
+
+    if (trans->guard && !trans->guard(ts->context)) {
+        flux_fsm_trace(flux_fsm_trace_machine(ts), *from, event, trans->to, FLUX_FSM_GUARD_FAIL);
+        return FLUX_FSM_GUARD_FAIL;
+    }
+
+    if (!atomic_compare_exchange_strong_explicit(&ts->current_state, from, trans->to,
+            memory_order_acq_rel, memory_order_acquire)) {
+        return FLUX_FSM_TS_LOST;
+    }
+
+    if (trans->action) {
+        trans->action(ts->context);
+    }
+
+    if ((size_t)*from < table->handler_count && table->handlers[*from]) {
+        table->handlers[*from](ts->context, event);
+    }
+
+    flux_fsm_trace(flux_fsm_trace_machine(ts), *from, event, trans->to, FLUX_FSM_OK);
+    return FLUX_FSM_OK;
+}
+
+static inline flux_fsm_rc_t flux_fsm_ts_dispatch(flux_fsm_ts_t* ts, flux_fsm_event_t event) {
+    int from = atomic_load_explicit(&ts->current_state, memory_order_acquire);
+    int rc;
+
+    while ((rc = flux_fsm_ts_commit(ts, &from, event)) == FLUX_FSM_TS_LOST) {
+        /* from 已被 CAS 更新为最新状态 */
+    }
+
+    return (flux_fsm_rc_t)rc;
+}
+
+static inline flux_fsm_rc_t flux_fsm_ts_try_commit(flux_fsm_ts_t* ts, int expected, flux_fsm_event_t event) {
+    int rc = flux_fsm_ts_commit(ts, &expected, event);
+
+    return rc == FLUX_FSM_TS_LOST ? FLUX_FSM_INVALID_STATE : (flux_fsm_rc_t)rc;
+}
+
+/**
+ * @brief 在调用方提供的存储上初始化线程安全实例
+ * @param ts 实例存储
+ * @param def 已封存的定义，实例持有其一个引用
+ * @param init_state 初始状态
+ * @param context 状态上下文指针
+ * @return 成功返回 FLUX_FSM_OK，定义未封存返回 FLUX_FSM_ERROR
+ */
+flux_fsm_rc_t flux_fsm_ts_init(flux_fsm_ts_t* ts, flux_fsm_def_t* def,
+    int init_state, void* context)
+{
+    if (!ts || !def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (!def->table.sealed) {
+        return FLUX_FSM_ERROR;
+    }
+
+    ts->def = flux_fsm_def_retain(def);
+    ts->context = context;
+    atomic_init(&ts->current_state, init_state);
+    ts->trace_id = 0;
+
+    return FLUX_FSM_OK;
+}
+
+void flux_fsm_ts_fini(flux_fsm_ts_t* ts) {
+    if (!ts) {
+        return;
+    }
+
+    flux_fsm_def_release(ts->def);
+    ts->def = NULL;
+}
+
+/**
+ * @brief 从任意线程处理事件
+ * @param ts 实例
+ * @param event 待处理事件
+ * @return 状态处理结果 FLUX_FSM_OK 表示成功
+ * @note 读取当前状态、查找转移后以 CAS 提交；若其间状态被其他线程
+ *       改变，则基于新状态重新查找。每个事件都作用于某个确定的、
+ *       恰好由一次提交产生的状态上，无需全局互斥锁
+ */
+flux_fsm_rc_t flux_fsm_ts_process_event(flux_fsm_ts_t* ts, flux_fsm_event_t event) {
+    if (!ts || !ts->def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_rc_t rc;
+    flux_fsm_count(rc, flux_fsm_ts_dispatch(ts, event));
+    return rc;
+}
+
+/**
+ * @brief 仅当当前状态为 expected 时处理事件，不重试
+ * @param ts 实例
+ * @param expected 调用方观察到的源状态
+ * @param event 待处理事件
+ * @return 成功返回 FLUX_FSM_OK，状态已不是 expected 返回 FLUX_FSM_INVALID_STATE
+ * @note 多个线程基于同一观察状态竞争时恰有一个成功，其余线程得到
+ *       FLUX_FSM_INVALID_STATE，可据此决定是否重新读取状态
+ */
+flux_fsm_rc_t flux_fsm_ts_try_event(flux_fsm_ts_t* ts, int expected, flux_fsm_event_t event) {
+    if (!ts || !ts->def) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_rc_t rc;
+    flux_fsm_count(rc, flux_fsm_ts_try_commit(ts, expected, event));
+    return rc;
+}
+
+/**
+ * @brief 无锁读取当前状态，可在监控线程中调用
+ */
+int flux_fsm_ts_get_state(const flux_fsm_ts_t* ts) {
+    if (!ts) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    return atomic_load_explicit((atomic_int*)&ts->current_state, memory_order_acquire);
+}
+
+#endif /* FLUX_FSM_HAVE_ATOMIC */
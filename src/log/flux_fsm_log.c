@@ -2,12 +2,73 @@
  * Copyright (C) 2024 FluxState. All rights reserved.
  */
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include "flux_fsm_config.h"
 #include "flux_fsm_log.h"
 
+#define FLUX_FSM_LOG_CACHE_LINE  64
+#define FLUX_FSM_LOG_ALIGN       16
+#define FLUX_FSM_LOG_PAD         0xffff
+#define FLUX_FSM_LOG_RING_MASK   (FLUX_FSM_LOG_RING_SIZE - 1)
+
+#if (FLUX_FSM_LOG_RING_SIZE & FLUX_FSM_LOG_RING_MASK) != 0
+#error "FLUX_FSM_LOG_RING_SIZE must be a power of two"
+#endif
+
+/*
+ * Ring record: header followed by the unterminated message, padded to
+ * FLUX_FSM_LOG_ALIGN. A record never wraps; when the space left before the
+ * end of the ring is too small the producer fills it with a PAD record.
+ */
+typedef struct {
+    uint32_t size;        /* Bytes including header and padding */
+    uint16_t level;       /* Log level or FLUX_FSM_LOG_PAD */
+    uint16_t len;         /* Message length */
+    int64_t time;         /* Seconds since the epoch */
+} flux_fsm_log_record_t;
+
+/*
+ * Single-producer single-consumer byte ring owned by one calling thread.
+ * tail is written by the producer, head by the writer thread; both grow
+ * monotonically and are masked on access.
+ */
+typedef struct flux_fsm_log_ring_s flux_fsm_log_ring_t;
+
+struct flux_fsm_log_ring_s {
+    atomic_size_t tail;
+    char pad0[FLUX_FSM_LOG_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_size_t head;
+    char pad1[FLUX_FSM_LOG_CACHE_LINE - sizeof(atomic_size_t)];
+    atomic_int orphaned;  /* Owning thread exited, ring may be adopted */
+    flux_fsm_log_ring_t* next;
+    _Alignas(FLUX_FSM_LOG_ALIGN) unsigned char data[FLUX_FSM_LOG_RING_SIZE];
+};
+
+struct flux_fsm_log_async_s {
+    pthread_t thread;
+    pthread_key_t key;    /* Calling thread -> its ring */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;  /* Wakes the writer */
+    pthread_cond_t done;  /* Signals completed flush requests */
+    flux_fsm_log_ring_t* rings;  /* Guarded by lock, only ever prepended */
+    int policy;
+    int stopping;
+    uint64_t flush_req;
+    uint64_t flush_done;
+    atomic_uint_least64_t dropped;
+    size_t batch_len;
+    char batch[FLUX_FSM_LOG_BATCH_SIZE];
+};
+
+static void flux_fsm_log_async_free(flux_fsm_log_async_t* async);
+static void flux_fsm_log_write_async(flux_fsm_log_t* log, int level, const char* fmt, va_list args);
+
 
 /* ANSI color codes */
 #define COLOR_RED     "\x1b[31m"
@@ -42,6 +103,28 @@ static const char* level_colors[] = {
     COLOR_BLUE      /* DEBUG */
 };
 
+/*
+ * Formatted timestamp, cached per thread and refreshed once per second;
+ * localtime_r and strftime run at most once per second per thread.
+ */
+static const char* flux_fsm_log_time_str(time_t t, size_t* len) {
+    static _Thread_local time_t cached_time = (time_t)-1;
+    static _Thread_local size_t cached_len;
+    static _Thread_local char cached_str[32];
+
+    if (t != cached_time) {
+        struct tm lt;
+        localtime_r(&t, &lt);
+        cached_len = strftime(cached_str, sizeof(cached_str), "%Y-%m-%d %H:%M:%S", &lt);
+        cached_time = t;
+    }
+
+    if (len) {
+        *len = cached_len;
+    }
+    return cached_str;
+}
+
 flux_fsm_log_t* flux_fsm_log_create(const char* filename, int level) {
     flux_fsm_log_t* log = (flux_fsm_log_t*)malloc(sizeof(flux_fsm_log_t));
     if (!log) {
@@ -60,6 +143,7 @@ flux_fsm_log_t* flux_fsm_log_create(const char* filename, int level) {
 
     log->level = level;
     log->use_colors = 1;  /* Enable colors by default */
+    log->async = NULL;
 
     return log;
 }
@@ -69,6 +153,19 @@ void flux_fsm_log_destroy(flux_fsm_log_t* log) {
         return;
     }
 
+    if (log->async) {
+        flux_fsm_log_async_t* async = log->async;
+
+        pthread_mutex_lock(&async->lock);
+        async->stopping = 1;
+        pthread_cond_signal(&async->wake);
+        pthread_mutex_unlock(&async->lock);
+
+        pthread_join(async->thread, NULL);
+        flux_fsm_log_async_free(async);
+        log->async = NULL;
+    }
+
     if (log->file && log->file != stdout) {
         fclose(log->file);
     }
@@ -89,6 +186,304 @@ static void write_colored(FILE* file, const char* color, const char* text) {
     fprintf(file, "%s%s%s", color, text, COLOR_RESET);
 }
 
+/* Called at thread exit; the writer still drains whatever is left */
+static void flux_fsm_log_ring_orphan(void* data) {
+    flux_fsm_log_ring_t* ring = data;
+    atomic_store_explicit(&ring->orphaned, 1, memory_order_release);
+}
+
+static flux_fsm_log_ring_t* flux_fsm_log_ring_acquire(flux_fsm_log_async_t* async) {
+    flux_fsm_log_ring_t* ring;
+
+    pthread_mutex_lock(&async->lock);
+
+    /* Reuse the ring of an exited thread before allocating a new one */
+    for (ring = async->rings; ring; ring = ring->next) {
+        if (atomic_load_explicit(&ring->orphaned, memory_order_acquire)) {
+            atomic_store_explicit(&ring->orphaned, 0, memory_order_relaxed);
+            break;
+        }
+    }
+
+    if (!ring) {
+        ring = malloc(sizeof(flux_fsm_log_ring_t));
+        if (ring) {
+            atomic_init(&ring->tail, 0);
+            atomic_init(&ring->head, 0);
+            atomic_init(&ring->orphaned, 0);
+            ring->next = async->rings;
+            async->rings = ring;
+        }
+    }
+
+    pthread_mutex_unlock(&async->lock);
+
+    if (ring && pthread_setspecific(async->key, ring) != 0) {
+        flux_fsm_log_ring_orphan(ring);
+        ring = NULL;
+    }
+
+    return ring;
+}
+
+static void flux_fsm_log_async_free(flux_fsm_log_async_t* async) {
+    flux_fsm_log_ring_t* ring = async->rings;
+    while (ring) {
+        flux_fsm_log_ring_t* next = ring->next;
+        free(ring);
+        ring = next;
+    }
+
+    pthread_key_delete(async->key);
+    pthread_cond_destroy(&async->done);
+    pthread_cond_destroy(&async->wake);
+    pthread_mutex_destroy(&async->lock);
+    free(async);
+}
+
+static void flux_fsm_log_batch_flush(flux_fsm_log_t* log) {
+    flux_fsm_log_async_t* async = log->async;
+
+    if (async->batch_len) {
+        fwrite(async->batch, 1, async->batch_len, log->file);
+        async->batch_len = 0;
+    }
+}
+
+static void flux_fsm_log_batch_append(flux_fsm_log_async_t* async, const char* text, size_t len) {
+    memcpy(async->batch + async->batch_len, text, len);
+    async->batch_len += len;
+}
+
+/* Format one record into the batch buffer (writer thread only) */
+static void flux_fsm_log_emit(flux_fsm_log_t* log, const flux_fsm_log_record_t* rec) {
+    flux_fsm_log_async_t* async = log->async;
+    const char* level = level_strings[rec->level];
+    int colored = log->use_colors && log->file == stdout;
+
+    size_t time_len;
+    const char* time_str = flux_fsm_log_time_str((time_t)rec->time, &time_len);
+
+    size_t need = time_len + sizeof(" [] \n") + strlen(level) + rec->len
+                + (colored ? strlen(level_colors[rec->level]) + sizeof(COLOR_RESET) : 0);
+    if (async->batch_len + need > sizeof(async->batch)) {
+        flux_fsm_log_batch_flush(log);
+    }
+
+    flux_fsm_log_batch_append(async, time_str, time_len);
+    flux_fsm_log_batch_append(async, " [", 2);
+    if (colored) {
+        flux_fsm_log_batch_append(async, level_colors[rec->level], strlen(level_colors[rec->level]));
+    }
+    flux_fsm_log_batch_append(async, level, strlen(level));
+    if (colored) {
+        flux_fsm_log_batch_append(async, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+    }
+    flux_fsm_log_batch_append(async, "] ", 2);
+    flux_fsm_log_batch_append(async, (const char*)(rec + 1), rec->len);
+    flux_fsm_log_batch_append(async, "\n", 1);
+}
+
+/* Move every published record of one ring into the batch; returns 1 if any */
+static int flux_fsm_log_drain(flux_fsm_log_t* log, flux_fsm_log_ring_t* ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return 0;
+    }
+
+    while (head != tail) {
+        const flux_fsm_log_record_t* rec =
+            (const flux_fsm_log_record_t*)(ring->data + (head & FLUX_FSM_LOG_RING_MASK));
+        if (rec->level != FLUX_FSM_LOG_PAD) {
+            flux_fsm_log_emit(log, rec);
+        }
+        head += rec->size;
+    }
+
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+    return 1;
+}
+
+static void* flux_fsm_log_writer(void* arg) {
+    flux_fsm_log_t* log = arg;
+    flux_fsm_log_async_t* async = log->async;
+
+    pthread_mutex_lock(&async->lock);
+
+    for ( ;; ) {
+        uint64_t req = async->flush_req;
+        int stopping = async->stopping;
+        flux_fsm_log_ring_t* rings = async->rings;
+        pthread_mutex_unlock(&async->lock);
+
+        int busy = 0;
+        for (flux_fsm_log_ring_t* ring = rings; ring; ring = ring->next) {
+            busy |= flux_fsm_log_drain(log, ring);
+        }
+        if (busy) {
+            flux_fsm_log_batch_flush(log);
+            fflush(log->file);
+        }
+
+        pthread_mutex_lock(&async->lock);
+
+        /* Everything published before req was seen has now been written */
+        if (async->flush_done != req) {
+            async->flush_done = req;
+            pthread_cond_broadcast(&async->done);
+        }
+
+        if (busy) {
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        if (async->flush_req == req && !async->stopping) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += (long)FLUX_FSM_LOG_FLUSH_MS * 1000000L;
+            ts.tv_sec += ts.tv_nsec / 1000000000L;
+            ts.tv_nsec %= 1000000000L;
+            pthread_cond_timedwait(&async->wake, &async->lock, &ts);
+        }
+    }
+
+    pthread_mutex_unlock(&async->lock);
+    return NULL;
+}
+
+static void flux_fsm_log_write_async(flux_fsm_log_t* log, int level, const char* fmt, va_list args) {
+    flux_fsm_log_async_t* async = log->async;
+    flux_fsm_log_ring_t* ring = pthread_getspecific(async->key);
+
+    if (!ring) {
+        ring = flux_fsm_log_ring_acquire(async);
+        if (!ring) {
+            atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+            return;
+        }
+    }
+
+    char msg[FLUX_FSM_LOG_RECORD_MAX];
+    int len = vsnprintf(msg, sizeof(msg), fmt, args);
+    if (len < 0) {
+        return;
+    }
+    if ((size_t)len >= sizeof(msg)) {
+        len = (int)sizeof(msg) - 1;
+    }
+
+    size_t need = (sizeof(flux_fsm_log_record_t) + (size_t)len + FLUX_FSM_LOG_ALIGN - 1)
+                & ~(size_t)(FLUX_FSM_LOG_ALIGN - 1);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t off = tail & FLUX_FSM_LOG_RING_MASK;
+    size_t contig = FLUX_FSM_LOG_RING_SIZE - off;
+    size_t total = contig < need ? contig + need : need;
+    size_t used;
+
+    for ( ;; ) {
+        used = tail - atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (FLUX_FSM_LOG_RING_SIZE - used >= total) {
+            break;
+        }
+
+        pthread_cond_signal(&async->wake);
+        if (async->policy != FLUX_FSM_LOG_BLOCK) {
+            atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+            return;
+        }
+        sched_yield();
+    }
+
+    if (contig < need) {
+        flux_fsm_log_record_t* pad = (flux_fsm_log_record_t*)(ring->data + off);
+        pad->size = (uint32_t)contig;
+        pad->level = FLUX_FSM_LOG_PAD;
+        off = 0;
+    }
+
+    flux_fsm_log_record_t* rec = (flux_fsm_log_record_t*)(ring->data + off);
+    rec->size = (uint32_t)need;
+    rec->level = (uint16_t)level;
+    rec->len = (uint16_t)len;
+    rec->time = (int64_t)time(NULL);
+    memcpy(rec + 1, msg, (size_t)len);
+
+    atomic_store_explicit(&ring->tail, tail + total, memory_order_release);
+
+    /* Wake the writer early once the ring passes half full */
+    if (used < FLUX_FSM_LOG_RING_SIZE / 2 && used + total >= FLUX_FSM_LOG_RING_SIZE / 2) {
+        pthread_cond_signal(&async->wake);
+    }
+}
+
+flux_fsm_log_t* flux_fsm_log_create_async(const char* filename, int level, int policy) {
+    flux_fsm_log_t* log = flux_fsm_log_create(filename, level);
+    if (!log) {
+        return NULL;
+    }
+
+    flux_fsm_log_async_t* async = calloc(1, sizeof(flux_fsm_log_async_t));
+    if (!async) {
+        flux_fsm_log_destroy(log);
+        return NULL;
+    }
+
+    if (pthread_key_create(&async->key, flux_fsm_log_ring_orphan) != 0) {
+        free(async);
+        flux_fsm_log_destroy(log);
+        return NULL;
+    }
+
+    pthread_mutex_init(&async->lock, NULL);
+    pthread_cond_init(&async->wake, NULL);
+    pthread_cond_init(&async->done, NULL);
+    atomic_init(&async->dropped, 0);
+    async->policy = policy;
+
+    log->async = async;
+    if (pthread_create(&async->thread, NULL, flux_fsm_log_writer, log) != 0) {
+        log->async = NULL;
+        flux_fsm_log_async_free(async);
+        flux_fsm_log_destroy(log);
+        return NULL;
+    }
+
+    return log;
+}
+
+/* Block until every record written before the call has reached the file */
+void flux_fsm_log_flush(flux_fsm_log_t* log) {
+    if (!log) {
+        return;
+    }
+
+    if (!log->async) {
+        fflush(log->file);
+        return;
+    }
+
+    flux_fsm_log_async_t* async = log->async;
+
+    pthread_mutex_lock(&async->lock);
+    uint64_t target = ++async->flush_req;
+    pthread_cond_signal(&async->wake);
+    while (async->flush_done < target) {
+        pthread_cond_wait(&async->done, &async->lock);
+    }
+    pthread_mutex_unlock(&async->lock);
+}
+
+uint64_t flux_fsm_log_dropped(const flux_fsm_log_t* log) {
+    if (!log || !log->async) {
+        return 0;
+    }
+    return atomic_load_explicit(&log->async->dropped, memory_order_relaxed);
+}
+
 void flux_fsm_log_write(flux_fsm_log_t* log, int level, const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
@@ -105,11 +500,13 @@ void flux_fsm_log_write_va(flux_fsm_log_t* log, int level, const char* fmt, va_l
         return;
     }
 
+    if (log->async) {
+        flux_fsm_log_write_async(log, level, fmt, args);
+        return;
+    }
+
     /* Get current time */
-    time_t t = time(NULL);
-    struct tm* lt = localtime(&t);
-    char time_str[32];
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", lt);
+    const char* time_str = flux_fsm_log_time_str(time(NULL), NULL);
 
     /* Write log header */
     if (log->use_colors && log->file == stdout) {
@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "flux_fsm_executor.h"
+
+#if defined(FLUX_FSM_HAVE_PARALLEL)
+
+/* 每次调度排空的默认事件数，用完后让出工作线程 */
+#define FLUX_FSM_EXECUTOR_BUDGET    64
+#define FLUX_FSM_RUNQ_MIN_CAPACITY  64
+
+/* 有排队却取不到状态机（窃取时锁被占用）时的退避：先让出若干次，再指数休眠 */
+#define FLUX_FSM_EXECUTOR_YIELDS    16
+#define FLUX_FSM_EXECUTOR_MAX_SLEEP 1000000L    /* ns */
+
+/**
+ * @brief 工作线程的运行队列（环形数组）
+ * @note 拥有者从头部取出，窃取者从尾部取出
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    flux_fsm_t** items;
+    size_t capacity;
+    size_t head;
+    size_t count;
+} flux_fsm_runq_t;
+
+typedef struct {
+    pthread_t thread;
+    flux_fsm_runq_t runq;
+    struct flux_fsm_executor_s* ex;
+    size_t id;
+} flux_fsm_worker_t;
+
+/**
+ * @struct flux_fsm_executor_s
+ * @brief 工作窃取执行器
+ *
+ * @var workers 工作线程数组
+ * @var nworkers 工作线程数量
+ * @var budget 单次调度排空的事件上限
+ * @var queued 位于运行队列中的状态机数量
+ * @var active 已调度（排队或正在处理）的状态机数量
+ * @var sleepers 正在休眠的工作线程数量
+ * @var stop 停止标志
+ */
+struct flux_fsm_executor_s {
+    flux_fsm_worker_t* workers;
+    size_t nworkers;
+    size_t budget;
+    atomic_size_t queued;
+    atomic_size_t active;
+    atomic_size_t sleepers;
+    atomic_int stop;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    pthread_cond_t done_cond;
+};
+
+static int flux_fsm_runq_push(flux_fsm_runq_t* q, flux_fsm_t* fsm) {
+    pthread_mutex_lock(&q->lock);
+
+    if (q->count == q->capacity) {
+        size_t cap = q->capacity ? q->capacity * 2 : FLUX_FSM_RUNQ_MIN_CAPACITY;
+        flux_fsm_t** items = malloc(cap * sizeof(flux_fsm_t*));
+        if (!items) {
+            pthread_mutex_unlock(&q->lock);
+            return -1;
+        }
+        for (size_t i = 0; i < q->count; i++) {
+            items[i] = q->items[(q->head + i) % q->capacity];
+        }
+        free(q->items);
+        q->items = items;
+        q->capacity = cap;
+        q->head = 0;
+    }
+
+    q->items[(q->head + q->count) % q->capacity] = fsm;
+    q->count++;
+
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+static flux_fsm_t* flux_fsm_runq_pop(flux_fsm_runq_t* q) {
+    flux_fsm_t* fsm = NULL;
+
+    pthread_mutex_lock(&q->lock);
+    if (q->count) {
+        fsm = q->items[q->head];
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return fsm;
+}
+
+static flux_fsm_t* flux_fsm_runq_steal(flux_fsm_runq_t* q) {
+    flux_fsm_t* fsm = NULL;
+
+    if (pthread_mutex_trylock(&q->lock) != 0) {
+        return NULL;
+    }
+    if (q->count) {
+        q->count--;
+        fsm = q->items[(q->head + q->count) % q->capacity];
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return fsm;
+}
+
+/*
+ * 放入运行队列并在有线程休眠时唤醒；扩容失败时依次尝试其余工作线程，
+ * 全部失败返回 -1
+ */
+static int flux_fsm_executor_enqueue(flux_fsm_executor_t* ex, size_t worker, flux_fsm_t* fsm) {
+    size_t tries = 0;
+
+    while (flux_fsm_runq_push(&ex->workers[worker].runq, fsm) != 0) {
+        if (++tries == ex->nworkers) {
+            return -1;
+        }
+        worker = (worker + 1) % ex->nworkers;
+    }
+
+    atomic_fetch_add(&ex->queued, 1);
+    if (atomic_load(&ex->sleepers) > 0) {
+        pthread_mutex_lock(&ex->idle_lock);
+        pthread_cond_signal(&ex->idle_cond);
+        pthread_mutex_unlock(&ex->idle_lock);
+    }
+    return 0;
+}
+
+/* 一个已调度的状态机退出调度，最后一个退出时唤醒 wait_idle */
+static void flux_fsm_executor_retire(flux_fsm_executor_t* ex) {
+    if (atomic_fetch_sub(&ex->active, 1) == 1) {
+        pthread_mutex_lock(&ex->idle_lock);
+        pthread_cond_broadcast(&ex->done_cond);
+        pthread_mutex_unlock(&ex->idle_lock);
+    }
+}
+
+static flux_fsm_t* flux_fsm_executor_next(flux_fsm_worker_t* w) {
+    flux_fsm_executor_t* ex = w->ex;
+
+    flux_fsm_t* fsm = flux_fsm_runq_pop(&w->runq);
+    if (!fsm) {
+        for (size_t i = 1; i < ex->nworkers && !fsm; i++) {
+            fsm = flux_fsm_runq_steal(&ex->workers[(w->id + i) % ex->nworkers].runq);
+        }
+    }
+
+    if (fsm) {
+        atomic_fetch_sub(&ex->queued, 1);
+    }
+    return fsm;
+}
+
+static void flux_fsm_executor_backoff(unsigned misses) {
+    if (misses < FLUX_FSM_EXECUTOR_YIELDS) {
+        sched_yield();
+        return;
+    }
+
+    unsigned shift = misses - FLUX_FSM_EXECUTOR_YIELDS;
+    long ns = shift < 10 ? 1000L << shift : FLUX_FSM_EXECUTOR_MAX_SLEEP;
+    struct timespec ts = { 0, ns < FLUX_FSM_EXECUTOR_MAX_SLEEP ? ns : FLUX_FSM_EXECUTOR_MAX_SLEEP };
+    nanosleep(&ts, NULL);
+}
+
+static void* flux_fsm_executor_worker(void* arg) {
+    flux_fsm_worker_t* w = arg;
+    flux_fsm_executor_t* ex = w->ex;
+    unsigned misses = 0;
+
+    for (;;) {
+        flux_fsm_t* fsm = flux_fsm_executor_next(w);
+
+        if (!fsm && atomic_load(&ex->queued) > 0 && !atomic_load(&ex->stop)) {
+            /* 队列非空但窃取未拿到锁，或投递方尚未完成入队 */
+            flux_fsm_executor_backoff(misses++);
+            continue;
+        }
+        misses = 0;
+
+        if (!fsm) {
+            pthread_mutex_lock(&ex->idle_lock);
+            atomic_fetch_add(&ex->sleepers, 1);
+            while (atomic_load(&ex->queued) == 0 && !atomic_load(&ex->stop)) {
+                pthread_cond_wait(&ex->idle_cond, &ex->idle_lock);
+            }
+            atomic_fetch_sub(&ex->sleepers, 1);
+            pthread_mutex_unlock(&ex->idle_lock);
+
+            if (atomic_load(&ex->stop)) {
+                break;
+            }
+            continue;
+        }
+
+        int requeued = 0;
+        for (;;) {
+            flux_fsm_drain(fsm, ex->budget);
+            flux_fsm_queue_release(fsm);
+
+            /* 与投递方的 post -> acquire 构成 Dekker 式配对，避免漏调度 */
+            atomic_thread_fence(memory_order_seq_cst);
+            if (!flux_fsm_pending(fsm) || !flux_fsm_queue_acquire(fsm)) {
+                break;
+            }
+            if (flux_fsm_executor_enqueue(ex, w->id, fsm) == 0) {
+                requeued = 1;
+                break;
+            }
+            /* 所有运行队列都无法扩容：仍持有消费者令牌，留在本线程继续排空 */
+        }
+
+        if (!requeued) {
+            flux_fsm_executor_retire(ex);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 创建执行器并启动工作线程
+ * @param workers 工作线程数，0 表示在线 CPU 数
+ * @param budget 单次调度排空的事件上限，0 表示默认值
+ * @return 成功返回执行器指针，失败返回NULL
+ */
+flux_fsm_executor_t* flux_fsm_executor_create(size_t workers, size_t budget) {
+    if (workers == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = n > 0 ? (size_t)n : 1;
+    }
+
+    flux_fsm_executor_t* ex = calloc(1, sizeof(flux_fsm_executor_t));
+    if (!ex) {
+        return NULL;
+    }
+
+    ex->workers = calloc(workers, sizeof(flux_fsm_worker_t));
+    if (!ex->workers) {
+        free(ex);
+        return NULL;
+    }
+
+    ex->nworkers = workers;
+    ex->budget = budget ? budget : FLUX_FSM_EXECUTOR_BUDGET;
+    atomic_init(&ex->queued, 0);
+    atomic_init(&ex->active, 0);
+    atomic_init(&ex->sleepers, 0);
+    atomic_init(&ex->stop, 0);
+    pthread_mutex_init(&ex->idle_lock, NULL);
+    pthread_cond_init(&ex->idle_cond, NULL);
+    pthread_cond_init(&ex->done_cond, NULL);
+
+    for (size_t i = 0; i < workers; i++) {
+        pthread_mutex_init(&ex->workers[i].runq.lock, NULL);
+        ex->workers[i].ex = ex;
+        ex->workers[i].id = i;
+    }
+
+    for (size_t i = 0; i < workers; i++) {
+        if (pthread_create(&ex->workers[i].thread, NULL,
+                           flux_fsm_executor_worker, &ex->workers[i]) != 0) {
+            /* 未启动线程的队列锁由这里销毁，其余由 destroy 回收 */
+            for (size_t j = i; j < workers; j++) {
+                pthread_mutex_destroy(&ex->workers[j].runq.lock);
+            }
+            ex->nworkers = i;
+            flux_fsm_executor_destroy(ex);
+            return NULL;
+        }
+    }
+
+    return ex;
+}
+
+/**
+ * @brief 停止并回收执行器
+ * @note 尚在运行队列中的状态机不再被处理，其消费者令牌被归还，
+ *       需要完整处理时应先调用 flux_fsm_executor_wait_idle
+ */
+void flux_fsm_executor_destroy(flux_fsm_executor_t* ex) {
+    if (!ex) {
+        return;
+    }
+
+    pthread_mutex_lock(&ex->idle_lock);
+    atomic_store(&ex->stop, 1);
+    pthread_cond_broadcast(&ex->idle_cond);
+    pthread_mutex_unlock(&ex->idle_lock);
+
+    for (size_t i = 0; i < ex->nworkers; i++) {
+        pthread_join(ex->workers[i].thread, NULL);
+    }
+
+    for (size_t i = 0; ex->workers && i < ex->nworkers; i++) {
+        flux_fsm_runq_t* q = &ex->workers[i].runq;
+        for (size_t k = 0; k < q->count; k++) {
+            flux_fsm_queue_release(q->items[(q->head + k) % q->capacity]);
+        }
+        free(q->items);
+        pthread_mutex_destroy(&q->lock);
+    }
+
+    pthread_cond_destroy(&ex->done_cond);
+    pthread_cond_destroy(&ex->idle_cond);
+    pthread_mutex_destroy(&ex->idle_lock);
+    free(ex->workers);
+    free(ex);
+}
+
+/**
+ * @brief 向状态机投递事件并在需要时调度
+ * @param ex 执行器
+ * @param fsm 已通过 flux_fsm_queue_init 创建队列的状态机
+ * @param event 待投递事件
+ * @return 成功返回 FLUX_FSM_OK，队列满或所有运行队列都无法扩容时返回
+ *         FLUX_FSM_ERROR
+ * @note 可从任意线程调用；状态机按地址固定分片到某个工作线程，
+ *       由该线程或窃取它的线程按顺序执行事件。运行队列扩容失败时事件
+ *       仍留在状态机队列中，随该状态机下一次成功调度执行
+ */
+flux_fsm_rc_t flux_fsm_executor_post(flux_fsm_executor_t* ex, flux_fsm_t* fsm, flux_fsm_event_t event) {
+    if (!ex || !fsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_rc_t rc = flux_fsm_post_event(fsm, event);
+    if (rc != FLUX_FSM_OK) {
+        return rc;
+    }
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (flux_fsm_queue_acquire(fsm)) {
+        atomic_fetch_add(&ex->active, 1);
+        size_t shard = (size_t)(((uintptr_t)fsm >> 6) % ex->nworkers);
+        if (flux_fsm_executor_enqueue(ex, shard, fsm) != 0) {
+            flux_fsm_queue_release(fsm);
+            flux_fsm_executor_retire(ex);
+            return FLUX_FSM_ERROR;
+        }
+    }
+
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 等待所有已投递事件执行完毕
+ * @note 与新的投递并发调用时只保证返回时刻之前的某一时间点已空闲
+ */
+void flux_fsm_executor_wait_idle(flux_fsm_executor_t* ex) {
+    if (!ex) {
+        return;
+    }
+
+    pthread_mutex_lock(&ex->idle_lock);
+    while (atomic_load(&ex->active) != 0) {
+        pthread_cond_wait(&ex->done_cond, &ex->idle_lock);
+    }
+    pthread_mutex_unlock(&ex->idle_lock);
+}
+
+size_t flux_fsm_executor_workers(const flux_fsm_executor_t* ex) {
+    return ex ? ex->nworkers : 0;
+}
+
+#endif /* FLUX_FSM_HAVE_PARALLEL */
@@ -0,0 +1,665 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_hierarchical.h"
+
+#if defined(FLUX_FSM_HAVE_HIERARCHICAL)
+
+/**
+ * @struct flux_fsm_hsm_node_t
+ * @brief 状态节点
+ *
+ * @var exists 是否已通过 flux_fsm_hsm_add_state 声明
+ * @var parent 父状态，FLUX_FSM_HSM_ROOT 表示顶层
+ * @var initial 复合状态的初始子状态，-1 表示未设置
+ * @var depth 嵌套深度，顶层为 0（构建时计算）
+ * @var children 直接子状态数量（构建时计算），0 表示叶状态
+ */
+typedef struct {
+    int exists;
+    int parent;
+    int initial;
+    int depth;
+    int children;
+    flux_fsm_hsm_state_pt entry;
+    flux_fsm_hsm_state_pt exit;
+} flux_fsm_hsm_node_t;
+
+/* 构建期的候选转移：叶状态 L 上事件 event 的第 seq 个候选 */
+typedef struct {
+    int event;
+    uint32_t seq;
+    uint32_t trans;
+} flux_fsm_hsm_cand_t;
+
+/**
+ * @struct flux_fsm_hsm_s
+ * @brief 层次状态机
+ *
+ * @var nodes 状态节点表，按状态编号索引
+ * @var trans 用户定义的转移，源状态可以是复合状态
+ * @var flat 展开后的等效转移表：每行的源为叶状态、目标为叶状态，
+ *      同一 (叶状态, 事件) 的候选按由内向外的顺序连续存放
+ * @var step_first 每行退出/进入序列在 steps 中的起始位置（共 行数 + 1 项）
+ * @var step_exits 每行的退出步数，其后为进入步
+ * @var steps 状态编号序列
+ */
+struct flux_fsm_hsm_s {
+    void* context;
+    int initial_state;
+    int started;
+    flux_fsm_hsm_node_t* nodes;
+    size_t node_count;
+    flux_fsm_transition_t* trans;
+    size_t trans_count;
+    size_t trans_capacity;
+    flux_fsm_t* flat;
+    uint32_t* step_first;
+    uint32_t* step_exits;
+    int* steps;
+};
+
+static int flux_fsm_hsm_grow(void** p, size_t* cap, size_t need, size_t elem) {
+    if (need <= *cap) {
+        return 0;
+    }
+
+    size_t n = *cap ? *cap : 8;
+    while (n < need) {
+        n *= 2;
+    }
+
+    void* np = realloc(*p, n * elem);
+    if (!np) {
+        return -1;
+    }
+
+    *p = np;
+    *cap = n;
+    return 0;
+}
+
+static flux_fsm_hsm_node_t* flux_fsm_hsm_node(const flux_fsm_hsm_t* hsm, int state) {
+    if (state < 0 || (size_t)state >= hsm->node_count || !hsm->nodes[state].exists) {
+        return NULL;
+    }
+    return &hsm->nodes[state];
+}
+
+static void flux_fsm_hsm_clear_build(flux_fsm_hsm_t* hsm) {
+    flux_fsm_destroy(hsm->flat);
+    free(hsm->step_first);
+    free(hsm->step_exits);
+    free(hsm->steps);
+    hsm->flat = NULL;
+    hsm->step_first = NULL;
+    hsm->step_exits = NULL;
+    hsm->steps = NULL;
+}
+
+flux_fsm_hsm_t* flux_fsm_hsm_create(int initial_state, void* context) {
+    flux_fsm_hsm_t* hsm = calloc(1, sizeof(flux_fsm_hsm_t));
+    if (!hsm) {
+        return NULL;
+    }
+
+    hsm->initial_state = initial_state;
+    hsm->context = context;
+    return hsm;
+}
+
+void flux_fsm_hsm_destroy(flux_fsm_hsm_t* hsm) {
+    if (!hsm) {
+        return;
+    }
+
+    flux_fsm_hsm_clear_build(hsm);
+    free(hsm->nodes);
+    free(hsm->trans);
+    free(hsm);
+}
+
+/**
+ * @brief 声明状态及其父状态
+ * @param hsm 层次状态机
+ * @param state 状态编号，非负
+ * @param parent 父状态编号，FLUX_FSM_HSM_ROOT 表示顶层；父状态可稍后声明
+ * @return 成功返回 FLUX_FSM_OK，已启动返回 FLUX_FSM_ERROR
+ */
+flux_fsm_rc_t flux_fsm_hsm_add_state(flux_fsm_hsm_t* hsm, int state, int parent) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (state < 0 || parent < FLUX_FSM_HSM_ROOT || state == parent) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+    if (hsm->started) {
+        return FLUX_FSM_ERROR;
+    }
+
+    if ((size_t)state >= hsm->node_count) {
+        size_t n = hsm->node_count ? hsm->node_count : 8;
+        while (n <= (size_t)state) {
+            n *= 2;
+        }
+
+        flux_fsm_hsm_node_t* nodes = realloc(hsm->nodes, n * sizeof(flux_fsm_hsm_node_t));
+        if (!nodes) {
+            return FLUX_FSM_ERROR;
+        }
+        memset(nodes + hsm->node_count, 0, (n - hsm->node_count) * sizeof(flux_fsm_hsm_node_t));
+
+        hsm->nodes = nodes;
+        hsm->node_count = n;
+    }
+
+    flux_fsm_hsm_node_t* node = &hsm->nodes[state];
+    if (!node->exists) {
+        node->initial = -1;
+    }
+    node->exists = 1;
+    node->parent = parent;
+
+    flux_fsm_hsm_clear_build(hsm);
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 设置复合状态的初始子状态，进入该复合状态时沿初始子状态下降到叶状态
+ */
+flux_fsm_rc_t flux_fsm_hsm_set_initial(flux_fsm_hsm_t* hsm, int state, int child) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_hsm_node_t* node = flux_fsm_hsm_node(hsm, state);
+    flux_fsm_hsm_node_t* sub = flux_fsm_hsm_node(hsm, child);
+    if (!node || !sub || sub->parent != state) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+    if (hsm->started) {
+        return FLUX_FSM_ERROR;
+    }
+
+    node->initial = child;
+    flux_fsm_hsm_clear_build(hsm);
+    return FLUX_FSM_OK;
+}
+
+flux_fsm_rc_t flux_fsm_hsm_set_entry(flux_fsm_hsm_t* hsm, int state, flux_fsm_hsm_state_pt entry) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_hsm_node_t* node = flux_fsm_hsm_node(hsm, state);
+    if (!node) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+
+    node->entry = entry;
+    return FLUX_FSM_OK;
+}
+
+flux_fsm_rc_t flux_fsm_hsm_set_exit(flux_fsm_hsm_t* hsm, int state, flux_fsm_hsm_state_pt exit) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_hsm_node_t* node = flux_fsm_hsm_node(hsm, state);
+    if (!node) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+
+    node->exit = exit;
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 添加转移，源状态可以是复合状态，对其所有后代叶状态生效
+ * @note 状态在构建时校验；同一状态上同一事件的多条转移按添加顺序尝试，
+ *       守卫全部失败时事件继续交给外层状态
+ */
+flux_fsm_rc_t flux_fsm_hsm_add_transition(flux_fsm_hsm_t* hsm, const flux_fsm_transition_t* trans) {
+    if (!hsm || !trans) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (hsm->started) {
+        return FLUX_FSM_ERROR;
+    }
+
+    if (flux_fsm_hsm_grow((void**)&hsm->trans, &hsm->trans_capacity,
+                          hsm->trans_count + 1, sizeof(flux_fsm_transition_t)) != 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    hsm->trans[hsm->trans_count++] = *trans;
+    flux_fsm_hsm_clear_build(hsm);
+    return FLUX_FSM_OK;
+}
+
+/* 沿初始子状态下降到叶状态，复合状态缺少初始子状态时返回 -1 */
+static int flux_fsm_hsm_leaf_of(const flux_fsm_hsm_t* hsm, int state) {
+    while (hsm->nodes[state].children > 0) {
+        state = hsm->nodes[state].initial;
+        if (state < 0) {
+            return -1;
+        }
+    }
+    return state;
+}
+
+/* 包含 a 与 b 的最小状态（含自身），不存在时返回 FLUX_FSM_HSM_ROOT */
+static int flux_fsm_hsm_lca(const flux_fsm_hsm_t* hsm, int a, int b) {
+    while (a != b) {
+        if (a == FLUX_FSM_HSM_ROOT || b == FLUX_FSM_HSM_ROOT) {
+            return FLUX_FSM_HSM_ROOT;
+        }
+
+        int da = hsm->nodes[a].depth;
+        int db = hsm->nodes[b].depth;
+        if (da >= db) {
+            a = hsm->nodes[a].parent;
+        }
+        if (db >= da) {
+            b = hsm->nodes[b].parent;
+        }
+    }
+    return a;
+}
+
+static int flux_fsm_hsm_cand_cmp(const void* a, const void* b) {
+    const flux_fsm_hsm_cand_t* ca = a;
+    const flux_fsm_hsm_cand_t* cb = b;
+
+    if (ca->event != cb->event) {
+        return ca->event < cb->event ? -1 : 1;
+    }
+    return ca->seq < cb->seq ? -1 : (ca->seq > cb->seq);
+}
+
+/* 构建期的可增长数组集合 */
+typedef struct {
+    flux_fsm_transition_t* rows;
+    size_t row_cap;
+    size_t row_count;
+    uint32_t* first;
+    size_t first_cap;
+    uint32_t* exits;
+    size_t exits_cap;
+    int* steps;
+    size_t step_cap;
+    size_t step_count;
+} flux_fsm_hsm_builder_t;
+
+static int flux_fsm_hsm_push_step(flux_fsm_hsm_builder_t* b, int state) {
+    if (b->step_count >= UINT32_MAX ||
+        flux_fsm_hsm_grow((void**)&b->steps, &b->step_cap, b->step_count + 1, sizeof(int)) != 0) {
+        return -1;
+    }
+    b->steps[b->step_count++] = state;
+    return 0;
+}
+
+/*
+ * 生成一行等效转移：叶状态 leaf 经由定义在 source 上的转移 t 离开。
+ * 外部转移语义：退出从 leaf 到最小公共真祖先（不含）之间的状态，
+ * 再由外向内进入直至目标的初始叶状态。
+ */
+static flux_fsm_rc_t flux_fsm_hsm_emit(const flux_fsm_hsm_t* hsm, flux_fsm_hsm_builder_t* b,
+    int leaf, const flux_fsm_transition_t* t)
+{
+    int target = flux_fsm_hsm_leaf_of(hsm, t->to);
+    if (target < 0) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+
+    int domain = flux_fsm_hsm_lca(hsm, t->from, t->to);
+    if (domain == t->from || domain == t->to) {
+        domain = hsm->nodes[domain].parent;
+    }
+
+    if (flux_fsm_hsm_grow((void**)&b->rows, &b->row_cap, b->row_count + 1,
+                          sizeof(flux_fsm_transition_t)) != 0 ||
+        flux_fsm_hsm_grow((void**)&b->first, &b->first_cap, b->row_count + 2, sizeof(uint32_t)) != 0 ||
+        flux_fsm_hsm_grow((void**)&b->exits, &b->exits_cap, b->row_count + 1, sizeof(uint32_t)) != 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    b->first[b->row_count] = (uint32_t)b->step_count;
+
+    uint32_t exits = 0;
+    for (int s = leaf; s != domain; s = hsm->nodes[s].parent) {
+        if (flux_fsm_hsm_push_step(b, s) != 0) {
+            return FLUX_FSM_ERROR;
+        }
+        exits++;
+    }
+
+    /* 先按由内向外压入，再原地反转为由外向内 */
+    size_t enter_first = b->step_count;
+    for (int s = t->to; s != domain; s = hsm->nodes[s].parent) {
+        if (flux_fsm_hsm_push_step(b, s) != 0) {
+            return FLUX_FSM_ERROR;
+        }
+    }
+    for (size_t i = enter_first, j = b->step_count - 1; i < j; i++, j--) {
+        int tmp = b->steps[i];
+        b->steps[i] = b->steps[j];
+        b->steps[j] = tmp;
+    }
+    for (int s = t->to; s != target; ) {
+        s = hsm->nodes[s].initial;
+        if (flux_fsm_hsm_push_step(b, s) != 0) {
+            return FLUX_FSM_ERROR;
+        }
+    }
+
+    b->exits[b->row_count] = exits;
+
+    flux_fsm_transition_t* row = &b->rows[b->row_count++];
+    row->from = leaf;
+    row->event = t->event;
+    row->to = target;
+    row->guard = t->guard;
+    row->action = t->action;
+
+    b->first[b->row_count] = (uint32_t)b->step_count;
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 展开层次结构，生成等效转移表与退出/进入序列
+ * @param hsm 层次状态机
+ * @return 成功返回 FLUX_FSM_OK；父状态不存在、存在环、转移或初始状态
+ *         指向未声明的状态、或目标复合状态缺少初始子状态时返回 FLUX_FSM_INVALID_STATE
+ * @note 对每个叶状态，由内向外收集自身及各祖先上的转移；同一事件的候选
+ *       在遇到第一条无守卫转移后截止。构建代价为 叶状态数 × 深度，
+ *       运行期分派为一次索引查找
+ */
+flux_fsm_rc_t flux_fsm_hsm_build(flux_fsm_hsm_t* hsm) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (hsm->started) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_hsm_clear_build(hsm);
+
+    /* 校验父链并计算深度与子状态数 */
+    for (size_t i = 0; i < hsm->node_count; i++) {
+        hsm->nodes[i].children = 0;
+    }
+    for (size_t i = 0; i < hsm->node_count; i++) {
+        flux_fsm_hsm_node_t* node = &hsm->nodes[i];
+        if (!node->exists) {
+            continue;
+        }
+
+        int depth = 0;
+        for (int p = node->parent; p != FLUX_FSM_HSM_ROOT; p = hsm->nodes[p].parent) {
+            if (!flux_fsm_hsm_node(hsm, p) || (size_t)depth >= hsm->node_count) {
+                return FLUX_FSM_INVALID_STATE;
+            }
+            depth++;
+        }
+        node->depth = depth;
+        if (node->parent != FLUX_FSM_HSM_ROOT) {
+            hsm->nodes[node->parent].children++;
+        }
+    }
+
+    for (size_t i = 0; i < hsm->trans_count; i++) {
+        if (!flux_fsm_hsm_node(hsm, hsm->trans[i].from) || !flux_fsm_hsm_node(hsm, hsm->trans[i].to)) {
+            return FLUX_FSM_INVALID_STATE;
+        }
+    }
+
+    if (!flux_fsm_hsm_node(hsm, hsm->initial_state)) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+    int initial_leaf = flux_fsm_hsm_leaf_of(hsm, hsm->initial_state);
+    if (initial_leaf < 0) {
+        return FLUX_FSM_INVALID_STATE;
+    }
+
+    /* 按源状态分组（CSR），组内保持添加顺序 */
+    uint32_t* by_first = calloc(hsm->node_count + 1, sizeof(uint32_t));
+    uint32_t* by_state = malloc((hsm->trans_count ? hsm->trans_count : 1) * sizeof(uint32_t));
+    flux_fsm_hsm_cand_t* cands = NULL;
+    size_t cand_cap = 0;
+    flux_fsm_hsm_builder_t b;
+    memset(&b, 0, sizeof(b));
+    flux_fsm_rc_t rc = FLUX_FSM_ERROR;
+
+    if (!by_first || !by_state) {
+        goto done;
+    }
+
+    for (size_t i = 0; i < hsm->trans_count; i++) {
+        by_first[hsm->trans[i].from + 1]++;
+    }
+    for (size_t s = 0; s < hsm->node_count; s++) {
+        by_first[s + 1] += by_first[s];
+    }
+    for (size_t i = 0; i < hsm->trans_count; i++) {
+        /* by_first[from] 作为游标递增，结束后整体右移一位 */
+        by_state[by_first[hsm->trans[i].from]++] = (uint32_t)i;
+    }
+    for (size_t s = hsm->node_count; s > 0; s--) {
+        by_first[s] = by_first[s - 1];
+    }
+    by_first[0] = 0;
+
+    /* 逐个叶状态展开 */
+    for (size_t leaf = 0; leaf < hsm->node_count; leaf++) {
+        if (!hsm->nodes[leaf].exists || hsm->nodes[leaf].children > 0) {
+            continue;
+        }
+
+        size_t cand_count = 0;
+        for (int s = (int)leaf; s != FLUX_FSM_HSM_ROOT; s = hsm->nodes[s].parent) {
+            for (uint32_t k = by_first[s]; k < by_first[s + 1]; k++) {
+                if (flux_fsm_hsm_grow((void**)&cands, &cand_cap, cand_count + 1,
+                                      sizeof(flux_fsm_hsm_cand_t)) != 0) {
+                    goto done;
+                }
+                cands[cand_count].event = hsm->trans[by_state[k]].event;
+                cands[cand_count].seq = (uint32_t)cand_count;
+                cands[cand_count].trans = by_state[k];
+                cand_count++;
+            }
+        }
+
+        qsort(cands, cand_count, sizeof(flux_fsm_hsm_cand_t), flux_fsm_hsm_cand_cmp);
+
+        int closed = 0;
+        for (size_t k = 0; k < cand_count; k++) {
+            if (k > 0 && cands[k].event != cands[k - 1].event) {
+                closed = 0;
+            }
+            /* 同一事件中，无守卫的候选之后的外层候选不可达 */
+            if (closed) {
+                continue;
+            }
+
+            const flux_fsm_transition_t* t = &hsm->trans[cands[k].trans];
+            rc = flux_fsm_hsm_emit(hsm, &b, (int)leaf, t);
+            if (rc != FLUX_FSM_OK) {
+                goto done;
+            }
+            closed = !t->guard;
+        }
+    }
+
+    rc = FLUX_FSM_ERROR;
+    hsm->flat = flux_fsm_create(initial_leaf, hsm->context);
+    if (!hsm->flat ||
+        flux_fsm_add_transitions(hsm->flat, b.rows, b.row_count) != FLUX_FSM_OK ||
+        flux_fsm_seal(hsm->flat) != FLUX_FSM_OK) {
+        goto done;
+    }
+
+    if (b.row_count == 0 && flux_fsm_hsm_grow((void**)&b.first, &b.first_cap, 1, sizeof(uint32_t)) != 0) {
+        goto done;
+    }
+    b.first[b.row_count] = (uint32_t)b.step_count;
+
+    hsm->step_first = b.first;
+    hsm->step_exits = b.exits;
+    hsm->steps = b.steps;
+    b.first = NULL;
+    b.exits = NULL;
+    b.steps = NULL;
+    rc = FLUX_FSM_OK;
+
+done:
+    if (rc != FLUX_FSM_OK) {
+        flux_fsm_hsm_clear_build(hsm);
+    }
+    free(by_first);
+    free(by_state);
+    free(cands);
+    free(b.rows);
+    free(b.first);
+    free(b.exits);
+    free(b.steps);
+    return rc;
+}
+
+/**
+ * @brief 进入初始状态配置：按由外向内的顺序执行初始叶状态及其祖先的进入处理器
+ * @note 未构建时先构建；启动后不能再修改状态与转移
+ */
+flux_fsm_rc_t flux_fsm_hsm_start(flux_fsm_hsm_t* hsm) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (hsm->started) {
+        return FLUX_FSM_ERROR;
+    }
+
+    if (!hsm->flat) {
+        flux_fsm_rc_t rc = flux_fsm_hsm_build(hsm);
+        if (rc != FLUX_FSM_OK) {
+            return rc;
+        }
+    }
+
+    int leaf = hsm->flat->current_state;
+    int depth = hsm->nodes[leaf].depth;
+
+    /* 由叶向根逐层回溯，按深度从 0 开始依次执行 */
+    for (int d = 0; d <= depth; d++) {
+        int s = leaf;
+        for (int k = depth; k > d; k--) {
+            s = hsm->nodes[s].parent;
+        }
+        if (hsm->nodes[s].entry) {
+            hsm->nodes[s].entry(hsm->context, s);
+        }
+    }
+
+    hsm->started = 1;
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 处理事件
+ * @param hsm 已启动的层次状态机
+ * @param event 待处理事件
+ * @return 成功返回 FLUX_FSM_OK；当前叶状态及其祖先均无此事件的转移返回
+ *         FLUX_FSM_ERROR；所有候选守卫均失败返回 FLUX_FSM_GUARD_FAIL
+ * @note 一次索引查找定位候选行，执行顺序为：守卫、退出处理器（由内向外）、
+ *       转移动作、进入处理器（由外向内）
+ */
+flux_fsm_rc_t flux_fsm_hsm_process_event(flux_fsm_hsm_t* hsm, flux_fsm_event_t event) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (!hsm->started) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_t* flat = hsm->flat;
+    int idx = flux_fsm_find_transition(flat, event);
+    if (idx < 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    int leaf = flat->current_state;
+    flux_fsm_transition_t t;
+
+    for (size_t i = (size_t)idx; flux_fsm_get_transition(flat, i, &t) == FLUX_FSM_OK; i++) {
+        if (t.from != leaf || t.event != event) {
+            break;
+        }
+        if (t.guard && !t.guard(hsm->context)) {
+            continue;
+        }
+
+        const int* steps = hsm->steps + hsm->step_first[i];
+        uint32_t count = hsm->step_first[i + 1] - hsm->step_first[i];
+        uint32_t exits = hsm->step_exits[i];
+
+        for (uint32_t k = 0; k < exits; k++) {
+            if (hsm->nodes[steps[k]].exit) {
+                hsm->nodes[steps[k]].exit(hsm->context, steps[k]);
+            }
+        }
+
+        if (t.action) {
+            t.action(hsm->context);
+        }
+
+        for (uint32_t k = exits; k < count; k++) {
+            if (hsm->nodes[steps[k]].entry) {
+                hsm->nodes[steps[k]].entry(hsm->context, steps[k]);
+            }
+        }
+
+        flux_fsm_set_state(flat, t.to);
+        return FLUX_FSM_OK;
+    }
+
+    return FLUX_FSM_GUARD_FAIL;
+}
+
+/**
+ * @brief 返回当前叶状态；未启动时返回初始状态
+ */
+int flux_fsm_hsm_get_state(const flux_fsm_hsm_t* hsm) {
+    if (!hsm) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    return hsm->started ? hsm->flat->current_state : hsm->initial_state;
+}
+
+/**
+ * @brief 判断 state 是否为当前叶状态或其祖先
+ */
+int flux_fsm_hsm_in_state(const flux_fsm_hsm_t* hsm, int state) {
+    if (!hsm || !hsm->started) {
+        return 0;
+    }
+
+    for (int s = hsm->flat->current_state; s != FLUX_FSM_HSM_ROOT; s = hsm->nodes[s].parent) {
+        if (s == state) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 获取展开后的等效转移表，用于可视化、导出等只读工具
+ */
+const flux_fsm_t* flux_fsm_hsm_table(const flux_fsm_hsm_t* hsm) {
+    return hsm ? hsm->flat : NULL;
+}
+
+#endif /* FLUX_FSM_HAVE_HIERARCHICAL */
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_parallel.h"
+
+#if defined(FLUX_FSM_HAVE_PARALLEL)
+
+/**
+ * @struct flux_fsm_parallel_s
+ * @brief 并行状态机
+ *
+ * @var regions 区域数组，不持有区域本身
+ * @var keys 有序去重的事件键
+ * @var first 每个事件在 members 中的起始位置（共 key_count + 1 项）
+ * @var members 可响应各事件的区域序号，同一事件内升序
+ * @var candidates 处理事件时的候选区域，容量为 count
+ * @var pending 每个区域本次待执行的转移序号
+ * @var versions 建立索引时各区域的转移表版本号，不一致时在处理事件前重建
+ * @var generation 上次核对版本号时的全局转移表代数，未变化时跳过逐区域比较
+ */
+struct flux_fsm_parallel_s {
+    flux_fsm_t** regions;
+    size_t count;
+    flux_fsm_resolver_pt resolver;
+    void* resolver_data;
+    flux_fsm_event_t* keys;
+    size_t key_count;
+    size_t* first;
+    size_t* members;
+    size_t* candidates;
+    int* pending;
+    uint32_t* versions;
+    uint32_t generation;
+};
+
+typedef struct {
+    flux_fsm_event_t event;
+    size_t region;
+} flux_fsm_parallel_pair_t;
+
+static int flux_fsm_parallel_pair_cmp(const void* a, const void* b) {
+    const flux_fsm_parallel_pair_t* pa = a;
+    const flux_fsm_parallel_pair_t* pb = b;
+
+    if (pa->event != pb->event) {
+        return pa->event < pb->event ? -1 : 1;
+    }
+    return pa->region < pb->region ? -1 : (pa->region > pb->region);
+}
+
+static void flux_fsm_parallel_clear_index(flux_fsm_parallel_t* par) {
+    free(par->keys);
+    free(par->first);
+    free(par->members);
+    par->keys = NULL;
+    par->first = NULL;
+    par->members = NULL;
+    par->key_count = 0;
+}
+
+/**
+ * @brief 创建并行状态机并建立事件索引
+ * @param regions 区域数组，复制指针；区域由调用方创建与销毁，生命周期须长于并行状态机
+ * @param count 区域数量
+ * @return 成功返回实例指针，失败返回 NULL
+ */
+flux_fsm_parallel_t* flux_fsm_parallel_create(flux_fsm_t* const* regions, size_t count) {
+    if (!regions || !count) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!regions[i]) {
+            return NULL;
+        }
+    }
+
+    flux_fsm_parallel_t* par = calloc(1, sizeof(flux_fsm_parallel_t));
+    if (!par) {
+        return NULL;
+    }
+
+    par->regions = malloc(count * sizeof(flux_fsm_t*));
+    par->candidates = malloc(count * sizeof(size_t));
+    par->pending = malloc(count * sizeof(int));
+    par->versions = malloc(count * sizeof(uint32_t));
+    if (!par->regions || !par->candidates || !par->pending || !par->versions) {
+        flux_fsm_parallel_destroy(par);
+        return NULL;
+    }
+
+    memcpy(par->regions, regions, count * sizeof(flux_fsm_t*));
+    par->count = count;
+
+    if (flux_fsm_parallel_rebuild(par) != FLUX_FSM_OK) {
+        flux_fsm_parallel_destroy(par);
+        return NULL;
+    }
+
+    return par;
+}
+
+void flux_fsm_parallel_destroy(flux_fsm_parallel_t* par) {
+    if (!par) {
+        return;
+    }
+
+    flux_fsm_parallel_clear_index(par);
+    free(par->regions);
+    free(par->candidates);
+    free(par->pending);
+    free(par->versions);
+    free(par);
+}
+
+/**
+ * @brief 根据各区域当前的转移表重建 事件 -> 区域 索引
+ * @param par 并行状态机
+ * @return 成功返回 FLUX_FSM_OK，内存不足返回 FLUX_FSM_ERROR 且保留原索引
+ * @note 创建时自动调用；处理事件时若发现区域的转移表版本变化也会自动重建，
+ *       显式调用可把重建开销移出事件路径
+ */
+flux_fsm_rc_t flux_fsm_parallel_rebuild(flux_fsm_parallel_t* par) {
+    if (!par) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    uint32_t generation = flux_fsm_generation();
+    size_t total = 0;
+    for (size_t r = 0; r < par->count; r++) {
+        total += par->regions[r]->transition_count;
+    }
+
+    flux_fsm_parallel_pair_t* pairs = malloc((total ? total : 1) * sizeof(flux_fsm_parallel_pair_t));
+    if (!pairs) {
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t n = 0;
+    for (size_t r = 0; r < par->count; r++) {
+        flux_fsm_transition_t t;
+        for (size_t i = 0; flux_fsm_get_transition(par->regions[r], i, &t) == FLUX_FSM_OK; i++) {
+            pairs[n].event = t.event;
+            pairs[n].region = r;
+            n++;
+        }
+    }
+
+    qsort(pairs, n, sizeof(flux_fsm_parallel_pair_t), flux_fsm_parallel_pair_cmp);
+
+    /* 去重 (事件, 区域)，并统计不同事件数 */
+    size_t unique = 0;
+    size_t key_count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (unique && pairs[unique - 1].event == pairs[i].event
+            && pairs[unique - 1].region == pairs[i].region) {
+            continue;
+        }
+        if (!unique || pairs[unique - 1].event != pairs[i].event) {
+            key_count++;
+        }
+        pairs[unique++] = pairs[i];
+    }
+
+    flux_fsm_event_t* keys = malloc((key_count ? key_count : 1) * sizeof(flux_fsm_event_t));
+    size_t* first = malloc((key_count + 1) * sizeof(size_t));
+    size_t* members = malloc((unique ? unique : 1) * sizeof(size_t));
+    if (!keys || !first || !members) {
+        free(keys);
+        free(first);
+        free(members);
+        free(pairs);
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t k = 0;
+    for (size_t i = 0; i < unique; i++) {
+        if (i == 0 || pairs[i - 1].event != pairs[i].event) {
+            keys[k] = pairs[i].event;
+            first[k] = i;
+            k++;
+        }
+        members[i] = pairs[i].region;
+    }
+    first[key_count] = unique;
+    free(pairs);
+
+    par->generation = generation;
+    for (size_t r = 0; r < par->count; r++) {
+        par->versions[r] = par->regions[r]->version;
+    }
+
+    flux_fsm_parallel_clear_index(par);
+    par->keys = keys;
+    par->first = first;
+    par->members = members;
+    par->key_count = key_count;
+
+    return FLUX_FSM_OK;
+}
+
+/* 代数变化后逐区域比较版本号，仅在区域添加过转移时重建 */
+static flux_fsm_rc_t flux_fsm_parallel_refresh(flux_fsm_parallel_t* par, uint32_t generation) {
+    for (size_t r = 0; r < par->count; r++) {
+        if (par->versions[r] != par->regions[r]->version) {
+            return flux_fsm_parallel_rebuild(par);
+        }
+    }
+
+    par->generation = generation;
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 设置冲突解决器，NULL 表示所有可响应的区域按序号顺序依次执行
+ */
+void flux_fsm_parallel_set_resolver(flux_fsm_parallel_t* par, flux_fsm_resolver_pt resolver, void* data) {
+    if (!par) {
+        return;
+    }
+
+    par->resolver = resolver;
+    par->resolver_data = data;
+}
+
+/**
+ * @brief 将事件广播到所有可响应的区域
+ * @param par 并行状态机
+ * @param event 待处理事件
+ * @param fired 输出完成转移的区域数，可为 NULL
+ * @return 至少一个区域完成转移返回 FLUX_FSM_OK；没有区域存在匹配转移返回
+ *         FLUX_FSM_ERROR；存在匹配转移但守卫均失败返回 FLUX_FSM_GUARD_FAIL；
+ *         冲突解决器返回 0 视为丢弃该事件，返回 FLUX_FSM_OK
+ * @note 先在所有候选区域中查找转移，再经冲突解决器执行，因此一个区域的
+ *       动作不会影响同一事件中其他区域的候选判定；守卫在执行时求值
+ */
+flux_fsm_rc_t flux_fsm_parallel_process_event(flux_fsm_parallel_t* par, flux_fsm_event_t event,
+    size_t* fired)
+{
+    if (fired) {
+        *fired = 0;
+    }
+    if (!par) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    /* 全局代数未变时各区域转移表必然未变，热路径只读一个字 */
+    uint32_t generation = flux_fsm_generation();
+    if (generation != par->generation) {
+        flux_fsm_rc_t rc = flux_fsm_parallel_refresh(par, generation);
+        if (rc != FLUX_FSM_OK) {
+            return rc;
+        }
+    }
+
+    /* 二分查找事件键 */
+    size_t lo = 0;
+    size_t hi = par->key_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (par->keys[mid] < event) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == par->key_count || par->keys[lo] != event) {
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t n = 0;
+    for (size_t i = par->first[lo]; i < par->first[lo + 1]; i++) {
+        size_t r = par->members[i];
+        int idx = flux_fsm_find_transition(par->regions[r], event);
+        if (idx >= 0) {
+            par->pending[r] = idx;
+            par->candidates[n++] = r;
+        }
+    }
+    if (n == 0) {
+        return FLUX_FSM_ERROR;
+    }
+
+    if (n > 1 && par->resolver) {
+        size_t keep = par->resolver(par->resolver_data, event, par->candidates, n);
+        n = keep < n ? keep : n;
+    }
+
+    size_t ok = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t r = par->candidates[i];
+        if (flux_fsm_exec_transition(par->regions[r], par->pending[r]) == FLUX_FSM_OK) {
+            ok++;
+        }
+    }
+
+    if (fired) {
+        *fired = ok;
+    }
+
+    return ok || n == 0 ? FLUX_FSM_OK : FLUX_FSM_GUARD_FAIL;
+}
+
+size_t flux_fsm_parallel_count(const flux_fsm_parallel_t* par) {
+    return par ? par->count : 0;
+}
+
+flux_fsm_t* flux_fsm_parallel_region(const flux_fsm_parallel_t* par, size_t i) {
+    if (!par || i >= par->count) {
+        return NULL;
+    }
+    return par->regions[i];
+}
+
+#endif /* FLUX_FSM_HAVE_PARALLEL */
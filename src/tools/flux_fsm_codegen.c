@@ -0,0 +1,687 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flux_fsm_codegen.h"
+
+/* 一条转移，回调以名称表示，NULL 表示无 */
+typedef struct {
+    int from;
+    int event;
+    int to;
+    char* guard;
+    char* action;
+    size_t seq;
+} flux_fsm_codegen_row_t;
+
+typedef struct {
+    int state;
+    char* name;
+} flux_fsm_codegen_handler_t;
+
+struct flux_fsm_codegen_s {
+    int initial_state;
+    flux_fsm_codegen_row_t* rows;
+    size_t row_count;
+    size_t row_capacity;
+    flux_fsm_codegen_handler_t* handlers;
+    size_t handler_count;
+    size_t handler_capacity;
+};
+
+static char* flux_fsm_codegen_strdup(const char* s, size_t len) {
+    char* p = malloc(len + 1);
+    if (p) {
+        memcpy(p, s, len);
+        p[len] = '\0';
+    }
+    return p;
+}
+
+static int flux_fsm_codegen_is_ident(const char* s) {
+    if (!s || !(isalpha((unsigned char)*s) || *s == '_')) {
+        return 0;
+    }
+    for (s++; *s; s++) {
+        if (!(isalnum((unsigned char)*s) || *s == '_')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int flux_fsm_codegen_grow(void** p, size_t* cap, size_t need, size_t elem) {
+    if (need <= *cap) {
+        return 0;
+    }
+
+    size_t n = *cap ? *cap * 2 : 16;
+    while (n < need) {
+        n *= 2;
+    }
+
+    void* np = realloc(*p, n * elem);
+    if (!np) {
+        return -1;
+    }
+    *p = np;
+    *cap = n;
+    return 0;
+}
+
+/* 添加转移，名称被复制 */
+static int flux_fsm_codegen_add_row(flux_fsm_codegen_t* gen, int from, int event, int to,
+    const char* guard, const char* action)
+{
+    if (flux_fsm_codegen_grow((void**)&gen->rows, &gen->row_capacity, gen->row_count + 1,
+                              sizeof(flux_fsm_codegen_row_t)) != 0) {
+        return -1;
+    }
+
+    flux_fsm_codegen_row_t* row = &gen->rows[gen->row_count];
+    row->from = from;
+    row->event = event;
+    row->to = to;
+    row->guard = guard ? flux_fsm_codegen_strdup(guard, strlen(guard)) : NULL;
+    row->action = action ? flux_fsm_codegen_strdup(action, strlen(action)) : NULL;
+    row->seq = gen->row_count;
+    gen->row_count++;
+
+    if ((guard && !row->guard) || (action && !row->action)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* 设置状态处理器，同一状态重复设置时后者生效 */
+static int flux_fsm_codegen_set_handler(flux_fsm_codegen_t* gen, int state, const char* name) {
+    char* copy = flux_fsm_codegen_strdup(name, strlen(name));
+    if (!copy) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < gen->handler_count; i++) {
+        if (gen->handlers[i].state == state) {
+            free(gen->handlers[i].name);
+            gen->handlers[i].name = copy;
+            return 0;
+        }
+    }
+
+    if (flux_fsm_codegen_grow((void**)&gen->handlers, &gen->handler_capacity,
+                              gen->handler_count + 1, sizeof(flux_fsm_codegen_handler_t)) != 0) {
+        free(copy);
+        return -1;
+    }
+
+    gen->handlers[gen->handler_count].state = state;
+    gen->handlers[gen->handler_count].name = copy;
+    gen->handler_count++;
+    return 0;
+}
+
+static const char* flux_fsm_codegen_handler_of(const flux_fsm_codegen_t* gen, int state) {
+    for (size_t i = 0; i < gen->handler_count; i++) {
+        if (gen->handlers[i].state == state) {
+            return gen->handlers[i].name;
+        }
+    }
+    return NULL;
+}
+
+void flux_fsm_codegen_destroy(flux_fsm_codegen_t* gen) {
+    if (!gen) {
+        return;
+    }
+
+    for (size_t i = 0; i < gen->row_count; i++) {
+        free(gen->rows[i].guard);
+        free(gen->rows[i].action);
+    }
+    for (size_t i = 0; i < gen->handler_count; i++) {
+        free(gen->handlers[i].name);
+    }
+    free(gen->rows);
+    free(gen->handlers);
+    free(gen);
+}
+
+/**
+ * @brief 由状态机与符号表构造生成器输入
+ * @param fsm 状态机，以其当前状态作为初始状态
+ * @param symbols 符号表
+ * @param n 符号数量
+ * @return 成功返回生成器输入；存在未登记或名称非法的回调时返回 NULL
+ */
+flux_fsm_codegen_t* flux_fsm_codegen_from_fsm(const flux_fsm_t* fsm,
+    const flux_fsm_symbol_t* symbols, size_t n)
+{
+    if (!fsm || (!symbols && n)) {
+        return NULL;
+    }
+
+    flux_fsm_codegen_t* gen = calloc(1, sizeof(flux_fsm_codegen_t));
+    if (!gen) {
+        return NULL;
+    }
+    gen->initial_state = fsm->current_state;
+
+    flux_fsm_transition_t t;
+    for (size_t i = 0; flux_fsm_get_transition(fsm, i, &t) == FLUX_FSM_OK; i++) {
+        const char* guard = NULL;
+        const char* action = NULL;
+
+        for (size_t k = 0; k < n; k++) {
+            if (t.guard && symbols[k].guard == t.guard) {
+                guard = symbols[k].name;
+            }
+            if (t.action && symbols[k].action == t.action) {
+                action = symbols[k].name;
+            }
+        }
+
+        if ((t.guard && !flux_fsm_codegen_is_ident(guard)) ||
+            (t.action && !flux_fsm_codegen_is_ident(action)) ||
+            flux_fsm_codegen_add_row(gen, t.from, t.event, t.to, guard, action) != 0) {
+            flux_fsm_codegen_destroy(gen);
+            return NULL;
+        }
+    }
+
+    for (size_t s = 0; s < fsm->handler_count; s++) {
+        if (!fsm->handlers[s]) {
+            continue;
+        }
+
+        const char* name = NULL;
+        for (size_t k = 0; k < n; k++) {
+            if (symbols[k].handler == fsm->handlers[s]) {
+                name = symbols[k].name;
+            }
+        }
+
+        if (!flux_fsm_codegen_is_ident(name) ||
+            flux_fsm_codegen_set_handler(gen, (int)s, name) != 0) {
+            flux_fsm_codegen_destroy(gen);
+            return NULL;
+        }
+    }
+
+    return gen;
+}
+
+static int flux_fsm_codegen_parse_int(const char* tok, int* out) {
+    if (!tok) {
+        return -1;
+    }
+
+    char* end;
+    errno = 0;
+    long v = strtol(tok, &end, 0);
+    if (errno || *end || end == tok || v < INT_MIN || v > INT_MAX) {
+        return -1;
+    }
+
+    *out = (int)v;
+    return 0;
+}
+
+/* 可选回调名，"-" 表示无 */
+static int flux_fsm_codegen_parse_name(const char* tok, const char** out) {
+    if (!tok || strcmp(tok, "-") == 0) {
+        *out = NULL;
+        return 0;
+    }
+    if (!flux_fsm_codegen_is_ident(tok)) {
+        return -1;
+    }
+
+    *out = tok;
+    return 0;
+}
+
+#define FLUX_FSM_CODEGEN_MAX_TOKENS  7
+
+static int flux_fsm_codegen_parse_line(flux_fsm_codegen_t* gen, char* line) {
+    char* hash = strchr(line, '#');
+    if (hash) {
+        *hash = '\0';
+    }
+
+    char* tok[FLUX_FSM_CODEGEN_MAX_TOKENS] = {0};
+    size_t n = 0;
+    for (char* p = line; *p; ) {
+        while (*p && isspace((unsigned char)*p)) {
+            *p++ = '\0';
+        }
+        if (!*p) {
+            break;
+        }
+        if (n == FLUX_FSM_CODEGEN_MAX_TOKENS) {
+            return -1;
+        }
+        tok[n++] = p;
+        while (*p && !isspace((unsigned char)*p)) {
+            p++;
+        }
+    }
+
+    if (n == 0) {
+        return 0;
+    }
+
+    if (strcmp(tok[0], "initial") == 0 && n == 2) {
+        return flux_fsm_codegen_parse_int(tok[1], &gen->initial_state);
+    }
+
+    if (strcmp(tok[0], "transition") == 0 && n >= 4 && n <= 6) {
+        int from, event, to;
+        const char* guard;
+        const char* action;
+        if (flux_fsm_codegen_parse_int(tok[1], &from) != 0 ||
+            flux_fsm_codegen_parse_int(tok[2], &event) != 0 ||
+            flux_fsm_codegen_parse_int(tok[3], &to) != 0 ||
+            flux_fsm_codegen_parse_name(tok[4], &guard) != 0 ||
+            flux_fsm_codegen_parse_name(tok[5], &action) != 0) {
+            return -1;
+        }
+        return flux_fsm_codegen_add_row(gen, from, event, to, guard, action);
+    }
+
+    if (strcmp(tok[0], "handler") == 0 && n == 3) {
+        int state;
+        if (flux_fsm_codegen_parse_int(tok[1], &state) != 0 || state < 0 ||
+            !flux_fsm_codegen_is_ident(tok[2])) {
+            return -1;
+        }
+        return flux_fsm_codegen_set_handler(gen, state, tok[2]);
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 解析定义文本
+ * @param text 以 '\0' 结尾的定义文本
+ * @param error_line 失败时输出出错的行号（从 1 开始），可为 NULL
+ * @return 成功返回生成器输入，语法错误或内存不足返回 NULL
+ */
+flux_fsm_codegen_t* flux_fsm_codegen_parse(const char* text, size_t* error_line) {
+    if (error_line) {
+        *error_line = 0;
+    }
+    if (!text) {
+        return NULL;
+    }
+
+    flux_fsm_codegen_t* gen = calloc(1, sizeof(flux_fsm_codegen_t));
+    if (!gen) {
+        return NULL;
+    }
+
+    size_t lineno = 0;
+    const char* p = text;
+    while (*p) {
+        const char* eol = strchr(p, '\n');
+        size_t len = eol ? (size_t)(eol - p) : strlen(p);
+        lineno++;
+
+        char* line = flux_fsm_codegen_strdup(p, len);
+        int rc = line ? flux_fsm_codegen_parse_line(gen, line) : -1;
+        free(line);
+
+        if (rc != 0) {
+            if (error_line) {
+                *error_line = lineno;
+            }
+            flux_fsm_codegen_destroy(gen);
+            return NULL;
+        }
+
+        p += len;
+        if (*p) {
+            p++;
+        }
+    }
+
+    return gen;
+}
+
+/**
+ * @brief 读取并解析定义文件
+ * @param filename 文件路径
+ * @param error_line 同 flux_fsm_codegen_parse；文件无法读取时为 0
+ */
+flux_fsm_codegen_t* flux_fsm_codegen_load(const char* filename, size_t* error_line) {
+    if (error_line) {
+        *error_line = 0;
+    }
+    if (!filename) {
+        return NULL;
+    }
+
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    char* text = malloc((size_t)size + 1);
+    if (!text || fread(text, 1, (size_t)size, file) != (size_t)size) {
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    text[size] = '\0';
+    fclose(file);
+
+    flux_fsm_codegen_t* gen = flux_fsm_codegen_parse(text, error_line);
+    free(text);
+    return gen;
+}
+
+/**
+ * @brief 按定义创建状态机，回调名称经符号表解析为函数指针
+ * @param gen 生成器输入
+ * @param symbols 符号表
+ * @param n 符号数量
+ * @param context 状态上下文指针
+ * @return 成功返回未封存的状态机，存在未登记的名称时返回 NULL
+ * @note 与生成的分派函数行为一致，可用于对照测试与基准测试
+ */
+flux_fsm_t* flux_fsm_codegen_instantiate(const flux_fsm_codegen_t* gen,
+    const flux_fsm_symbol_t* symbols, size_t n, void* context)
+{
+    if (!gen || (!symbols && n)) {
+        return NULL;
+    }
+
+    flux_fsm_t* fsm = flux_fsm_create(gen->initial_state, context);
+    if (!fsm) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < gen->row_count; i++) {
+        const flux_fsm_codegen_row_t* row = &gen->rows[i];
+        flux_fsm_transition_t t = {row->from, row->event, row->to, NULL, NULL};
+
+        for (size_t k = 0; k < n; k++) {
+            if (row->guard && symbols[k].guard && strcmp(symbols[k].name, row->guard) == 0) {
+                t.guard = symbols[k].guard;
+            }
+            if (row->action && symbols[k].action && strcmp(symbols[k].name, row->action) == 0) {
+                t.action = symbols[k].action;
+            }
+        }
+
+        if ((row->guard && !t.guard) || (row->action && !t.action) ||
+            flux_fsm_add_transition(fsm, &t) != FLUX_FSM_OK) {
+            flux_fsm_destroy(fsm);
+            return NULL;
+        }
+    }
+
+    for (size_t i = 0; i < gen->handler_count; i++) {
+        flux_fsm_handler_pt handler = NULL;
+        for (size_t k = 0; k < n; k++) {
+            if (symbols[k].handler && strcmp(symbols[k].name, gen->handlers[i].name) == 0) {
+                handler = symbols[k].handler;
+            }
+        }
+
+        if (!handler || flux_fsm_add_handler(fsm, gen->handlers[i].state, handler) != FLUX_FSM_OK) {
+            flux_fsm_destroy(fsm);
+            return NULL;
+        }
+    }
+
+    return fsm;
+}
+
+static int flux_fsm_codegen_row_cmp(const void* a, const void* b) {
+    const flux_fsm_codegen_row_t* ra = *(const flux_fsm_codegen_row_t* const*)a;
+    const flux_fsm_codegen_row_t* rb = *(const flux_fsm_codegen_row_t* const*)b;
+
+    if (ra->from != rb->from) {
+        return ra->from < rb->from ? -1 : 1;
+    }
+    if (ra->event != rb->event) {
+        return ra->event < rb->event ? -1 : 1;
+    }
+    return ra->seq < rb->seq ? -1 : (ra->seq > rb->seq);
+}
+
+/* 回调角色，三者签名互不兼容 */
+enum {
+    FLUX_FSM_CODEGEN_GUARD,
+    FLUX_FSM_CODEGEN_ACTION,
+    FLUX_FSM_CODEGEN_HANDLER
+};
+
+/**
+ * @brief 登记回调名称及其角色
+ * @return 新名称返回 1，同一角色已登记返回 0，已以其他角色登记返回 -1
+ */
+static int flux_fsm_codegen_declare(const char** names, int* roles, size_t* n,
+    const char* name, int role)
+{
+    for (size_t i = 0; i < *n; i++) {
+        if (strcmp(names[i], name) == 0) {
+            return roles[i] == role ? 0 : -1;
+        }
+    }
+
+    names[*n] = name;
+    roles[*n] = role;
+    (*n)++;
+    return 1;
+}
+
+/**
+ * @brief 输出 switch 分派源码
+ * @param gen 生成器输入
+ * @param prefix 生成符号的前缀，须为合法标识符，NULL 表示 "fsm"
+ * @param out 输出流
+ * @return 成功返回 FLUX_FSM_OK
+ * @note 生成函数 <prefix>_dispatch(int* state, void* ctx, flux_fsm_event_t event)，
+ *       外层按状态、内层按事件 switch，守卫、动作与处理器直接调用，
+ *       语义与 flux_fsm_process_event 一致：同一 (状态, 事件) 只有最先添加的
+ *       转移生效，守卫失败不改变状态。默认为外部链接；在包含生成文件前将
+ *       <PREFIX>_DISPATCH_LINKAGE 定义为 static inline，可让编译器内联分派与回调。
+ *       同一名称用作守卫、动作、处理器中的两种时签名冲突，返回 FLUX_FSM_ERROR
+ *       且不输出任何内容
+ */
+flux_fsm_rc_t flux_fsm_codegen_write(const flux_fsm_codegen_t* gen, const char* prefix, FILE* out) {
+    if (!gen || !out) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    if (!prefix) {
+        prefix = "fsm";
+    }
+    if (!flux_fsm_codegen_is_ident(prefix)) {
+        return FLUX_FSM_ERROR;
+    }
+
+    size_t plen = strlen(prefix);
+    size_t max_names = gen->row_count * 2 + gen->handler_count + 1;
+    char* upper = flux_fsm_codegen_strdup(prefix, plen);
+    const flux_fsm_codegen_row_t** order = malloc((gen->row_count ? gen->row_count : 1) * sizeof(*order));
+    const char** names = malloc(max_names * sizeof(*names));
+    int* roles = malloc(max_names * sizeof(*roles));
+    if (!upper || !order || !names || !roles) {
+        free(upper);
+        free(order);
+        free(names);
+        free(roles);
+        return FLUX_FSM_ERROR;
+    }
+    for (size_t i = 0; i < plen; i++) {
+        upper[i] = (char)toupper((unsigned char)upper[i]);
+    }
+
+    /* 先按角色登记全部回调名称，冲突时不输出 */
+    size_t name_count = 0;
+    int conflict = 0;
+    for (size_t i = 0; i < gen->row_count; i++) {
+        if (gen->rows[i].guard) {
+            conflict |= flux_fsm_codegen_declare(names, roles, &name_count,
+                                                 gen->rows[i].guard, FLUX_FSM_CODEGEN_GUARD) < 0;
+        }
+    }
+    for (size_t i = 0; i < gen->row_count; i++) {
+        if (gen->rows[i].action) {
+            conflict |= flux_fsm_codegen_declare(names, roles, &name_count,
+                                                 gen->rows[i].action, FLUX_FSM_CODEGEN_ACTION) < 0;
+        }
+    }
+    for (size_t i = 0; i < gen->handler_count; i++) {
+        conflict |= flux_fsm_codegen_declare(names, roles, &name_count,
+                                             gen->handlers[i].name, FLUX_FSM_CODEGEN_HANDLER) < 0;
+    }
+    if (conflict) {
+        free(upper);
+        free(order);
+        free(names);
+        free(roles);
+        return FLUX_FSM_ERROR;
+    }
+
+    fprintf(out, "/*\n * Generated by flux_fsm_codegen. Do not edit.\n */\n\n");
+    fprintf(out, "#include \"flux_fsm_core.h\"\n\n");
+    fprintf(out, "#ifndef %s_DISPATCH_LINKAGE\n#define %s_DISPATCH_LINKAGE\n#endif\n\n", upper, upper);
+    fprintf(out, "#define %s_INITIAL_STATE  %d\n\n", upper, gen->initial_state);
+
+    /* 回调声明，每个名称一次 */
+    for (size_t i = 0; i < name_count; i++) {
+        if (roles[i] == FLUX_FSM_CODEGEN_GUARD) {
+            fprintf(out, "int %s(void* ctx);\n", names[i]);
+        } else if (roles[i] == FLUX_FSM_CODEGEN_ACTION) {
+            fprintf(out, "void %s(void* ctx);\n", names[i]);
+        } else {
+            fprintf(out, "void %s(void* ctx, flux_fsm_event_t event);\n", names[i]);
+        }
+    }
+    if (name_count) {
+        fprintf(out, "\n");
+    }
+
+    for (size_t i = 0; i < gen->row_count; i++) {
+        order[i] = &gen->rows[i];
+    }
+    qsort(order, gen->row_count, sizeof(*order), flux_fsm_codegen_row_cmp);
+
+    fprintf(out, "%s_DISPATCH_LINKAGE flux_fsm_rc_t %s_dispatch(int* state, void* ctx, flux_fsm_event_t event)\n{\n",
+            upper, prefix);
+    fprintf(out, "    (void)ctx;\n    (void)event;\n\n");
+    fprintf(out, "    switch (*state) {\n");
+
+    for (size_t i = 0; i < gen->row_count; i++) {
+        const flux_fsm_codegen_row_t* row = order[i];
+        int first_of_state = i == 0 || order[i - 1]->from != row->from;
+
+        /* 同一 (状态, 事件) 的后续转移不可达 */
+        if (!first_of_state && order[i - 1]->event == row->event) {
+            continue;
+        }
+
+        if (first_of_state) {
+            fprintf(out, "    case %d:\n        switch (event) {\n", row->from);
+        }
+
+        fprintf(out, "        case %d:\n", row->event);
+        if (row->guard) {
+            fprintf(out, "            if (!%s(ctx)) {\n                return FLUX_FSM_GUARD_FAIL;\n            }\n",
+                    row->guard);
+        }
+        if (row->action) {
+            fprintf(out, "            %s(ctx);\n", row->action);
+        }
+        const char* handler = flux_fsm_codegen_handler_of(gen, row->from);
+        if (handler) {
+            fprintf(out, "            %s(ctx, event);\n", handler);
+        }
+        fprintf(out, "            *state = %d;\n            return FLUX_FSM_OK;\n", row->to);
+
+        if (i + 1 == gen->row_count || order[i + 1]->from != row->from) {
+            fprintf(out, "        default:\n            break;\n        }\n        break;\n");
+        }
+    }
+
+    fprintf(out, "    default:\n        break;\n    }\n\n    return FLUX_FSM_ERROR;\n}\n");
+
+    free(upper);
+    free(order);
+    free(names);
+    free(roles);
+
+    return ferror(out) ? FLUX_FSM_ERROR : FLUX_FSM_OK;
+}
+
+/* 生成分派源码字符串，由 flux_fsm_codegen_free 释放 */
+char* flux_fsm_codegen_generate(const flux_fsm_codegen_t* gen, const char* prefix) {
+    if (!gen) {
+        return NULL;
+    }
+
+    FILE* temp_file = tmpfile();
+    if (!temp_file) {
+        return NULL;
+    }
+
+    if (flux_fsm_codegen_write(gen, prefix, temp_file) != FLUX_FSM_OK) {
+        fclose(temp_file);
+        return NULL;
+    }
+
+    fseek(temp_file, 0, SEEK_END);
+    long size = ftell(temp_file);
+    fseek(temp_file, 0, SEEK_SET);
+
+    char* source = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (!source || fread(source, 1, (size_t)size, temp_file) != (size_t)size) {
+        free(source);
+        fclose(temp_file);
+        return NULL;
+    }
+    source[size] = '\0';
+
+    fclose(temp_file);
+    return source;
+}
+
+void flux_fsm_codegen_free(char* source) {
+    free(source);
+}
+
+/* 将分派源码写入文件，成功返回 0 */
+int flux_fsm_codegen_export(const flux_fsm_codegen_t* gen, const char* prefix, const char* filename) {
+    if (!gen || !filename) {
+        return -1;
+    }
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        return -1;
+    }
+
+    flux_fsm_rc_t rc = flux_fsm_codegen_write(gen, prefix, file);
+    if (fclose(file) != 0 || rc != FLUX_FSM_OK) {
+        remove(filename);
+        return -1;
+    }
+
+    return 0;
+}
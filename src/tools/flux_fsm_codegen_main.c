@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "flux_fsm_codegen.h"
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-p prefix] [-o output.c] definition\n", argv0);
+}
+
+/* 定义文件 -> switch 分派源码，未指定 -o 时输出到标准输出 */
+int main(int argc, char** argv) {
+    const char* prefix = NULL;
+    const char* output = NULL;
+    const char* input = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            prefix = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!input) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t line = 0;
+    flux_fsm_codegen_t* gen = flux_fsm_codegen_load(input, &line);
+    if (!gen) {
+        if (line) {
+            fprintf(stderr, "%s:%zu: invalid definition\n", input, line);
+        } else {
+            fprintf(stderr, "%s: cannot read definition\n", input);
+        }
+        return 1;
+    }
+
+    int rc = output
+        ? flux_fsm_codegen_export(gen, prefix, output)
+        : (flux_fsm_codegen_write(gen, prefix, stdout) == FLUX_FSM_OK ? 0 : -1);
+    flux_fsm_codegen_destroy(gen);
+
+    if (rc != 0) {
+        fprintf(stderr, "%s: code generation failed\n", output ? output : "stdout");
+        return 1;
+    }
+
+    return 0;
+}
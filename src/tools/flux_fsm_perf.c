@@ -2,6 +2,142 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdarg.h>
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+#define flux_fsm_hist_load(p)     atomic_load_explicit((p), memory_order_relaxed)
+#define flux_fsm_hist_store(p, v) atomic_store_explicit((p), (v), memory_order_relaxed)
+#define flux_fsm_hist_add(p, v)   atomic_fetch_add_explicit((p), (v), memory_order_relaxed)
+#define flux_fsm_hist_cas(p, e, v)                                                 \
+    atomic_compare_exchange_weak_explicit((p), (e), (v), memory_order_relaxed,     \
+                                          memory_order_relaxed)
+#else
+#define flux_fsm_hist_load(p)     (*(p))
+#define flux_fsm_hist_store(p, v) (*(p) = (v))
+#define flux_fsm_hist_add(p, v)   (*(p) += (v))
+
+static inline int flux_fsm_hist_cas(uint64_t* p, uint64_t* expected, uint64_t v) {
+    if (*p != *expected) {
+        *expected = *p;
+        return 0;
+    }
+    *p = v;
+    return 1;
+}
+#endif
+
+/* 线性区间上限：小于该值的取值各占一个桶 */
+#define FLUX_FSM_HIST_LINEAR  (2u << FLUX_FSM_HIST_SUB_BITS)
+
+static inline unsigned flux_fsm_hist_msb(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - (unsigned)__builtin_clzll(v);
+#else
+    unsigned n = 0;
+    while (v >>= 1) {
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* 取值 -> 桶序号：高位所在的 2 的幂区间再按次高 SUB_BITS 位线性细分 */
+static inline size_t flux_fsm_hist_index(uint64_t v) {
+    if (v < FLUX_FSM_HIST_LINEAR) {
+        return (size_t)v;
+    }
+    if (v >> FLUX_FSM_HIST_MAX_BITS) {
+        return FLUX_FSM_HIST_BUCKETS - 1;
+    }
+
+    unsigned shift = flux_fsm_hist_msb(v) - FLUX_FSM_HIST_SUB_BITS;
+    return ((size_t)shift << FLUX_FSM_HIST_SUB_BITS) + (size_t)(v >> shift);
+}
+
+/* 桶内最大取值，即与桶内任意取值等价的最大值 */
+static inline uint64_t flux_fsm_hist_upper(size_t idx) {
+    if (idx < FLUX_FSM_HIST_LINEAR) {
+        return idx;
+    }
+
+    unsigned shift = (unsigned)(idx >> FLUX_FSM_HIST_SUB_BITS) - 1;
+    uint64_t mant = (idx & ((1u << FLUX_FSM_HIST_SUB_BITS) - 1)) + (1u << FLUX_FSM_HIST_SUB_BITS);
+    return ((mant + 1) << shift) - 1;
+}
+
+void flux_fsm_hist_init(flux_fsm_hist_t* hist) {
+    memset(hist, 0, sizeof(flux_fsm_hist_t));
+}
+
+/**
+ * @brief 记录一个取值（纳秒）
+ * @note 无锁：一次桶计数与一次总和的宽松原子加法，仅在刷新最大值时 CAS
+ */
+void flux_fsm_hist_record(flux_fsm_hist_t* hist, uint64_t ns) {
+    flux_fsm_hist_add(&hist->buckets[flux_fsm_hist_index(ns)], 1);
+    flux_fsm_hist_add(&hist->sum, ns);
+
+    uint64_t max = flux_fsm_hist_load(&hist->max);
+    while (ns > max && !flux_fsm_hist_cas(&hist->max, &max, ns)) {
+    }
+}
+
+/**
+ * @brief 复制直方图，可与记录并发进行
+ * @note count 由各桶求和得到，与桶计数始终一致；并发记录时 sum 与 max
+ *       可能比桶计数多含或少含正在进行的记录
+ */
+void flux_fsm_hist_snapshot(const flux_fsm_hist_t* hist, flux_fsm_hist_snapshot_t* out) {
+    out->count = 0;
+    for (size_t i = 0; i < FLUX_FSM_HIST_BUCKETS; i++) {
+        out->buckets[i] = flux_fsm_hist_load(&hist->buckets[i]);
+        out->count += out->buckets[i];
+    }
+    out->sum = flux_fsm_hist_load(&hist->sum);
+    out->max = flux_fsm_hist_load(&hist->max);
+}
+
+/* 将 src 并入 dst，例如合并多个线程或多个采样周期的快照 */
+void flux_fsm_hist_merge(flux_fsm_hist_snapshot_t* dst, const flux_fsm_hist_snapshot_t* src) {
+    for (size_t i = 0; i < FLUX_FSM_HIST_BUCKETS; i++) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+/**
+ * @brief 百分位数查询
+ * @param percentile 0 - 100，例如 99.9
+ * @return 不小于该比例记录的最小桶的上界（不超过记录的最大值），无记录返回 0
+ */
+uint64_t flux_fsm_hist_percentile(const flux_fsm_hist_snapshot_t* snap, double percentile) {
+    if (snap->count == 0) {
+        return 0;
+    }
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)snap->count + 0.999999);
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < FLUX_FSM_HIST_BUCKETS; i++) {
+        seen += snap->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = flux_fsm_hist_upper(i);
+            /* 末桶容纳全部被截断的取值，其上界以记录的最大值为准 */
+            return upper < snap->max && i < FLUX_FSM_HIST_BUCKETS - 1 ? upper : snap->max;
+        }
+    }
+    return snap->max;
+}
 
 void flux_fsm_perf_init(flux_fsm_perf_t* perf) {
     memset(perf, 0, sizeof(flux_fsm_perf_t));
@@ -16,11 +152,22 @@ void flux_fsm_perf_reset(flux_fsm_perf_t* perf) {
     perf->total_time = 0.0;
     perf->avg_transition_time = 0.0;
     perf->max_transition_time = 0.0;
+    perf->cache_hits = 0;
+    perf->cache_misses = 0;
+    flux_fsm_hist_init(&perf->latency);
+    flux_fsm_hist_init(&perf->guard_time);
+    flux_fsm_hist_init(&perf->action_time);
+    flux_fsm_hist_init(&perf->handler_time);
+    memset(perf->trans, 0, sizeof(perf->trans));
+    flux_fsm_hist_store(&perf->trans_dropped, 0);
 }
 
+/* transition_time 以毫秒计，同时按纳秒记入延迟直方图 */
 void flux_fsm_perf_update(flux_fsm_perf_t* perf, double transition_time) {
     perf->transitions++;
     perf->total_time += transition_time;
+    flux_fsm_hist_record(&perf->latency,
+        transition_time > 0.0 ? (uint64_t)(transition_time * 1e6) : 0);
     
     if (transition_time > perf->max_transition_time) {
         perf->max_transition_time = transition_time;
@@ -28,9 +175,254 @@ void flux_fsm_perf_update(flux_fsm_perf_t* perf, double transition_time) {
     perf->avg_transition_time = perf->total_time / perf->transitions;
 }
 
-const char* flux_fsm_perf_to_json(const flux_fsm_perf_t* perf) {
-    static char json_buffer[2048];
-    snprintf(json_buffer, sizeof(json_buffer),
+/* 从状态机采集运行期计数（热点缓存命中/未命中），覆盖之前的采样值 */
+void flux_fsm_perf_collect(flux_fsm_perf_t* perf, const flux_fsm_t* fsm) {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    if (flux_fsm_cache_stats(fsm, &hits, &misses) == FLUX_FSM_OK) {
+        perf->cache_hits = (unsigned long)hits;
+        perf->cache_misses = (unsigned long)misses;
+    }
+}
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+/*
+ * 从核心的线程计数器采集全部线程合并后的事件计数与耗时（毫秒），
+ * 覆盖之前的采样值；计数需先由 flux_fsm_counters_enable 开启
+ */
+void flux_fsm_perf_collect_counters(flux_fsm_perf_t* perf) {
+    flux_fsm_counters_t c;
+    flux_fsm_counters_read(&c);
+
+    perf->events = (unsigned long)c.events;
+    perf->transitions = (unsigned long)c.transitions;
+    perf->guard_failures = (unsigned long)c.guard_failures;
+    perf->invalid_events = (unsigned long)c.invalid_events;
+    perf->invalid_states = (unsigned long)c.invalid_states;
+    perf->total_time = (double)c.total_ns / 1e6;
+    perf->max_transition_time = (double)c.max_ns / 1e6;
+    perf->avg_transition_time = c.events ? perf->total_time / (double)c.events : 0.0;
+}
+
+static void flux_fsm_perf_on_phase(void* data, const flux_fsm_phase_t* phase) {
+    flux_fsm_perf_record_phases(data, phase->from, phase->event, phase->rc,
+        phase->guard_ns, phase->action_ns, phase->handler_ns);
+}
+
+/**
+ * @brief 接收核心的阶段计时，此后每次转移的耗时记入 perf 的直方图与转移明细
+ * @note 同一时刻只能挂接一个 perf；detach 后须待事件线程静止再释放 perf
+ */
+void flux_fsm_perf_attach(flux_fsm_perf_t* perf) {
+    perf->sink.handler = flux_fsm_perf_on_phase;
+    perf->sink.data = perf;
+    flux_fsm_phases_attach(&perf->sink);
+}
+
+void flux_fsm_perf_detach(flux_fsm_perf_t* perf) {
+    (void)perf;
+    flux_fsm_phases_attach(NULL);
+}
+#endif
+
+static inline uint64_t flux_fsm_perf_key(int from, int event) {
+    return ((uint64_t)(uint32_t)from << 32 | (uint32_t)event) + 1;
+}
+
+/* 开放寻址查找 (from, event) 的槽位，create 时以 CAS 占用空槽，表满返回 NULL */
+static flux_fsm_perf_trans_t* flux_fsm_perf_slot(flux_fsm_perf_t* perf, uint64_t key, int create) {
+    uint64_t h = key * 0x9e3779b97f4a7c15ull;
+    size_t mask = FLUX_FSM_PERF_TRANSITIONS - 1;
+
+    for (size_t n = 0, i = (size_t)(h >> 32); n < FLUX_FSM_PERF_TRANSITIONS; n++, i++) {
+        flux_fsm_perf_trans_t* t = &perf->trans[i & mask];
+        uint64_t cur = flux_fsm_hist_load(&t->key);
+
+        if (cur == 0 && create) {
+            if (flux_fsm_hist_cas(&t->key, &cur, key)) {
+                return t;
+            }
+        }
+        if (cur == key) {
+            return t;
+        }
+        if (cur == 0) {
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 记录一次转移的阶段耗时（纳秒），可从多个线程并发调用
+ * @note 成功的转移以三段之和记入 latency；守卫失败只记入 guard_time。
+ *       转移明细表满时新的 (from, event) 只计入 trans_dropped
+ */
+void flux_fsm_perf_record_phases(flux_fsm_perf_t* perf, int from, int event, flux_fsm_rc_t rc,
+    uint64_t guard_ns, uint64_t action_ns, uint64_t handler_ns)
+{
+    flux_fsm_hist_record(&perf->guard_time, guard_ns);
+    if (rc == FLUX_FSM_OK) {
+        flux_fsm_hist_record(&perf->action_time, action_ns);
+        flux_fsm_hist_record(&perf->handler_time, handler_ns);
+        flux_fsm_hist_record(&perf->latency, guard_ns + action_ns + handler_ns);
+    }
+
+    uint64_t key = flux_fsm_perf_key(from, event);
+    flux_fsm_perf_trans_t* t = key ? flux_fsm_perf_slot(perf, key, 1) : NULL;
+    if (!t) {
+        flux_fsm_hist_add(&perf->trans_dropped, 1);
+        return;
+    }
+
+    flux_fsm_hist_add(&t->count, 1);
+    if (rc != FLUX_FSM_OK) {
+        flux_fsm_hist_add(&t->guard_failures, 1);
+    }
+    flux_fsm_hist_add(&t->guard_ns, guard_ns);
+    flux_fsm_hist_add(&t->action_ns, action_ns);
+    flux_fsm_hist_add(&t->handler_ns, handler_ns);
+}
+
+static void flux_fsm_perf_breakdown(const flux_fsm_perf_trans_t* t, uint64_t key,
+    flux_fsm_perf_breakdown_t* out)
+{
+    key -= 1;
+    out->from = (int)(uint32_t)(key >> 32);
+    out->event = (int)(uint32_t)key;
+    out->count = flux_fsm_hist_load(&t->count);
+    out->guard_failures = flux_fsm_hist_load(&t->guard_failures);
+    out->guard_ns = flux_fsm_hist_load(&t->guard_ns);
+    out->action_ns = flux_fsm_hist_load(&t->action_ns);
+    out->handler_ns = flux_fsm_hist_load(&t->handler_ns);
+}
+
+/**
+ * @brief 读取 (from, event) 转移的阶段耗时明细
+ * @return 有记录返回 FLUX_FSM_OK，否则返回 FLUX_FSM_INVALID_EVENT
+ */
+flux_fsm_rc_t flux_fsm_perf_transition(const flux_fsm_perf_t* perf, int from, int event,
+    flux_fsm_perf_breakdown_t* out)
+{
+    uint64_t key = flux_fsm_perf_key(from, event);
+    const flux_fsm_perf_trans_t* t = key
+        ? flux_fsm_perf_slot((flux_fsm_perf_t*)perf, key, 0) : NULL;
+
+    if (!t) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+    flux_fsm_perf_breakdown(t, key, out);
+    return FLUX_FSM_OK;
+}
+
+/**
+ * @brief 初始化写入器
+ * @param buf 调用方提供的缓冲区
+ * @param write 缓冲区满或 flush 时的输出回调，NULL 表示只写入 buf，
+ *        超出部分截断但仍计入 total
+ */
+void flux_fsm_writer_init(flux_fsm_writer_t* w, char* buf, size_t size,
+    flux_fsm_write_pt write, void* data)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->total = 0;
+    w->error = 0;
+    w->write = write;
+    w->data = data;
+    if (size) {
+        buf[0] = '\0';
+    }
+}
+
+/* 将缓冲内容交给输出回调，无回调时为空操作 */
+flux_fsm_rc_t flux_fsm_writer_flush(flux_fsm_writer_t* w) {
+    if (w->write && w->len) {
+        if (w->write(w->data, w->buf, w->len) != w->len) {
+            w->error = 1;
+        }
+        w->len = 0;
+    }
+    return w->error ? FLUX_FSM_ERROR : FLUX_FSM_OK;
+}
+
+/**
+ * @brief 追加格式化文本
+ * @note 单次输出须小于缓冲区；有回调时先清空缓冲再重试，否则截断
+ */
+void flux_fsm_writer_printf(flux_fsm_writer_t* w, const char* fmt, ...) {
+    va_list args;
+    int n;
+
+    if (w->error) {
+        return;
+    }
+
+    va_start(args, fmt);
+    n = vsnprintf(w->buf + w->len, w->size - w->len, fmt, args);
+    va_end(args);
+    if (n < 0) {
+        w->error = 1;
+        return;
+    }
+
+    if (w->len + (size_t)n < w->size) {
+        w->len += (size_t)n;
+        w->total += (size_t)n;
+        return;
+    }
+
+    if (!w->write) {
+        w->total += (size_t)n;
+        w->len = w->size ? w->size - 1 : 0;
+        return;
+    }
+
+    w->buf[w->len] = '\0';
+    if (flux_fsm_writer_flush(w) != FLUX_FSM_OK) {
+        return;
+    }
+
+    va_start(args, fmt);
+    n = vsnprintf(w->buf, w->size, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= w->size) {
+        w->error = 1;
+        return;
+    }
+    w->len = (size_t)n;
+    w->total += (size_t)n;
+}
+
+static void flux_fsm_perf_json_hist(flux_fsm_writer_t* w, const char* name,
+    const flux_fsm_hist_t* hist, const char* tail)
+{
+    flux_fsm_hist_snapshot_t snap;
+
+    flux_fsm_hist_snapshot(hist, &snap);
+    flux_fsm_writer_printf(w,
+        "    \"%s\": {\"count\": %llu, \"p50\": %llu, \"p90\": %llu, "
+        "\"p99\": %llu, \"p999\": %llu, \"max\": %llu}%s\n",
+        name,
+        (unsigned long long)snap.count,
+        (unsigned long long)flux_fsm_hist_percentile(&snap, 50.0),
+        (unsigned long long)flux_fsm_hist_percentile(&snap, 90.0),
+        (unsigned long long)flux_fsm_hist_percentile(&snap, 99.0),
+        (unsigned long long)flux_fsm_hist_percentile(&snap, 99.9),
+        (unsigned long long)snap.max,
+        tail);
+}
+
+/**
+ * @brief 以 JSON 写出性能数据，延迟与阶段耗时的百分位数以纳秒计
+ * @note 不分配堆内存，只读取 perf；可与记录并发进行
+ */
+flux_fsm_rc_t flux_fsm_perf_write_json(const flux_fsm_perf_t* perf, flux_fsm_writer_t* w) {
+    const char* sep = "";
+
+    flux_fsm_writer_printf(w,
         "{\n"
         "  \"transitions\": %lu,\n"
         "  \"events\": %lu,\n"
@@ -39,8 +431,10 @@ const char* flux_fsm_perf_to_json(const flux_fsm_perf_t* perf) {
         "  \"invalid_states\": %lu,\n"
         "  \"total_time\": %.3f,\n"
         "  \"avg_transition_time\": %.3f,\n"
-        "  \"max_transition_time\": %.3f\n"
-        "}",
+        "  \"max_transition_time\": %.3f,\n"
+        "  \"cache_hits\": %lu,\n"
+        "  \"cache_misses\": %lu,\n"
+        "  \"latency_ns\": {\n",
         perf->transitions,
         perf->events,
         perf->guard_failures,
@@ -48,10 +442,273 @@ const char* flux_fsm_perf_to_json(const flux_fsm_perf_t* perf) {
         perf->invalid_states,
         perf->total_time,
         perf->avg_transition_time,
-        perf->max_transition_time);
+        perf->max_transition_time,
+        perf->cache_hits,
+        perf->cache_misses);
+
+    flux_fsm_perf_json_hist(w, "transition", &perf->latency, ",");
+    flux_fsm_perf_json_hist(w, "guard", &perf->guard_time, ",");
+    flux_fsm_perf_json_hist(w, "action", &perf->action_time, ",");
+    flux_fsm_perf_json_hist(w, "handler", &perf->handler_time, "");
+    flux_fsm_writer_printf(w, "  },\n  \"transition_phases\": [");
+
+    for (size_t i = 0; i < FLUX_FSM_PERF_TRANSITIONS; i++) {
+        flux_fsm_perf_breakdown_t b;
+        uint64_t key = flux_fsm_hist_load(&perf->trans[i].key);
+
+        if (!key) {
+            continue;
+        }
+        flux_fsm_perf_breakdown(&perf->trans[i], key, &b);
+        flux_fsm_writer_printf(w,
+            "%s\n    {\"from\": %d, \"event\": %d, \"count\": %llu, \"guard_failures\": %llu, "
+            "\"guard_ns\": %llu, \"action_ns\": %llu, \"handler_ns\": %llu}",
+            sep, b.from, b.event,
+            (unsigned long long)b.count,
+            (unsigned long long)b.guard_failures,
+            (unsigned long long)b.guard_ns,
+            (unsigned long long)b.action_ns,
+            (unsigned long long)b.handler_ns);
+        sep = ",";
+    }
+
+    flux_fsm_writer_printf(w, "%s],\n  \"transition_phases_dropped\": %llu\n}",
+        *sep ? "\n  " : "",
+        (unsigned long long)flux_fsm_hist_load(&perf->trans_dropped));
+    return flux_fsm_writer_flush(w);
+}
+
+/**
+ * @brief 将 JSON 写入调用方的缓冲区
+ * @return 完整输出的长度（不含结尾 0），不小于 size 时输出被截断，
+ *         与 snprintf 相同
+ */
+size_t flux_fsm_perf_format_json(const flux_fsm_perf_t* perf, char* buf, size_t size) {
+    flux_fsm_writer_t w;
+
+    flux_fsm_writer_init(&w, buf, size, NULL, NULL);
+    flux_fsm_perf_write_json(perf, &w);
+    return w.total;
+}
+
+/* 兼容接口：结果位于线程私有的缓冲区，在同一线程下次调用前有效 */
+const char* flux_fsm_perf_to_json(const flux_fsm_perf_t* perf) {
+    static _Thread_local char json_buffer[16384];
+
+    flux_fsm_perf_format_json(perf, json_buffer, sizeof(json_buffer));
     return json_buffer;
 }
 
+static void flux_fsm_prom_header(flux_fsm_writer_t* w, const char* name,
+    const char* type, const char* help)
+{
+    flux_fsm_writer_printf(w, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void flux_fsm_prom_counter(flux_fsm_writer_t* w, const char* name,
+    const char* help, unsigned long long value)
+{
+    flux_fsm_prom_header(w, name, "counter", help);
+    flux_fsm_writer_printf(w, "%s %llu\n", name, value);
+}
+
+/* 延迟直方图以 summary 写出，单位换算为秒 */
+static void flux_fsm_prom_summary(flux_fsm_writer_t* w, const char* name,
+    const char* label, const flux_fsm_hist_t* hist)
+{
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    flux_fsm_hist_snapshot_t snap;
+
+    flux_fsm_hist_snapshot(hist, &snap);
+    for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+        flux_fsm_writer_printf(w, "%s{%s%squantile=\"%g\"} %.9g\n",
+            name, label, *label ? "," : "", quantiles[i],
+            (double)flux_fsm_hist_percentile(&snap, quantiles[i] * 100.0) / 1e9);
+    }
+    flux_fsm_writer_printf(w, "%s_sum%s%s%s %.9g\n%s_count%s%s%s %llu\n",
+        name, *label ? "{" : "", label, *label ? "}" : "", (double)snap.sum / 1e9,
+        name, *label ? "{" : "", label, *label ? "}" : "", (unsigned long long)snap.count);
+}
+
+/**
+ * @brief 以 Prometheus 文本格式写出汇总计数、延迟分位数、各状态与各转移的计数
+ * @note 各状态与各转移的序列来自阶段明细，只在 flux_fsm_perf_attach 之后
+ *       （或调用方自行 flux_fsm_perf_record_phases）才有数据；明细表只容纳
+ *       FLUX_FSM_PERF_TRANSITIONS 个 (from, event)，表满后的转移不计入各状态
+ *       序列，而是计入 flux_fsm_transitions_dropped_total，该值非 0 时应调大
+ *       FLUX_FSM_PERF_TRANSITIONS。不分配堆内存，只做宽松读取，不阻塞正在
+ *       记录的事件线程
+ */
+flux_fsm_rc_t flux_fsm_perf_write_prometheus(const flux_fsm_perf_t* perf, flux_fsm_writer_t* w) {
+    flux_fsm_perf_breakdown_t b;
+    /* 按两个最宽的 int 取长度，标签不会被截断 */
+    char label[sizeof("from=\"-2147483648\",event=\"-2147483648\"")];
+
+    flux_fsm_prom_counter(w, "flux_fsm_events_total", "Events processed.", perf->events);
+    flux_fsm_prom_counter(w, "flux_fsm_transitions_total", "Transitions completed.",
+        perf->transitions);
+    flux_fsm_prom_counter(w, "flux_fsm_guard_failures_total", "Transitions rejected by a guard.",
+        perf->guard_failures);
+    flux_fsm_prom_counter(w, "flux_fsm_invalid_events_total", "Events without a matching transition.",
+        perf->invalid_events);
+    flux_fsm_prom_counter(w, "flux_fsm_invalid_states_total", "Events in an invalid state.",
+        perf->invalid_states);
+    flux_fsm_prom_counter(w, "flux_fsm_cache_hits_total", "Transition cache hits.",
+        perf->cache_hits);
+    flux_fsm_prom_counter(w, "flux_fsm_cache_misses_total", "Transition cache misses.",
+        perf->cache_misses);
+    flux_fsm_prom_counter(w, "flux_fsm_transitions_dropped_total",
+        "Phase records not broken down per state because the transition table was full.",
+        (unsigned long long)flux_fsm_hist_load(&perf->trans_dropped));
+
+    flux_fsm_prom_header(w, "flux_fsm_transition_latency_seconds", "summary",
+        "Latency of completed transitions.");
+    flux_fsm_prom_summary(w, "flux_fsm_transition_latency_seconds", "", &perf->latency);
+
+    flux_fsm_prom_header(w, "flux_fsm_phase_latency_seconds", "summary",
+        "Time spent in guards, actions and state handlers.");
+    flux_fsm_prom_summary(w, "flux_fsm_phase_latency_seconds", "phase=\"guard\"", &perf->guard_time);
+    flux_fsm_prom_summary(w, "flux_fsm_phase_latency_seconds", "phase=\"action\"", &perf->action_time);
+    flux_fsm_prom_summary(w, "flux_fsm_phase_latency_seconds", "phase=\"handler\"", &perf->handler_time);
+
+    flux_fsm_prom_header(w, "flux_fsm_state_transitions_total", "counter",
+        "Completed transitions out of each state.");
+    for (size_t i = 0; i < FLUX_FSM_PERF_TRANSITIONS; i++) {
+        uint64_t key = flux_fsm_hist_load(&perf->trans[i].key);
+        uint64_t sum = 0;
+        size_t j;
+
+        if (!key) {
+            continue;
+        }
+        flux_fsm_perf_breakdown(&perf->trans[i], key, &b);
+        int from = b.from;
+
+        /* 每个源状态只在其第一个槽位处汇总一次 */
+        for (j = 0; j < i; j++) {
+            uint64_t k = flux_fsm_hist_load(&perf->trans[j].key);
+            if (k && (int)(uint32_t)((k - 1) >> 32) == from) {
+                break;
+            }
+        }
+        if (j < i) {
+            continue;
+        }
+
+        for (j = i; j < FLUX_FSM_PERF_TRANSITIONS; j++) {
+            uint64_t k = flux_fsm_hist_load(&perf->trans[j].key);
+            if (k && (int)(uint32_t)((k - 1) >> 32) == from) {
+                flux_fsm_perf_breakdown(&perf->trans[j], k, &b);
+                sum += b.count - b.guard_failures;
+            }
+        }
+        flux_fsm_writer_printf(w, "flux_fsm_state_transitions_total{state=\"%d\"} %llu\n",
+            from, (unsigned long long)sum);
+    }
+
+    /* 同一指标的样本须连续出现，故每个指标单独遍历一次明细 */
+    for (int family = 0; family < 3; family++) {
+        static const char* const names[] = {
+            "flux_fsm_transition_calls_total",
+            "flux_fsm_transition_guard_failures_total",
+            "flux_fsm_transition_phase_seconds_total"
+        };
+        static const char* const helps[] = {
+            "Transition attempts by source state and event.",
+            "Guard rejections by source state and event.",
+            "Cumulative phase time by source state and event."
+        };
+
+        flux_fsm_prom_header(w, names[family], "counter", helps[family]);
+        for (size_t i = 0; i < FLUX_FSM_PERF_TRANSITIONS; i++) {
+            uint64_t key = flux_fsm_hist_load(&perf->trans[i].key);
+
+            if (!key) {
+                continue;
+            }
+            flux_fsm_perf_breakdown(&perf->trans[i], key, &b);
+            snprintf(label, sizeof(label), "from=\"%d\",event=\"%d\"", b.from, b.event);
+
+            if (family == 0) {
+                flux_fsm_writer_printf(w, "%s{%s} %llu\n", names[family], label,
+                    (unsigned long long)b.count);
+            } else if (family == 1) {
+                flux_fsm_writer_printf(w, "%s{%s} %llu\n", names[family], label,
+                    (unsigned long long)b.guard_failures);
+            } else {
+                flux_fsm_writer_printf(w,
+                    "%s{%s,phase=\"guard\"} %.9g\n"
+                    "%s{%s,phase=\"action\"} %.9g\n"
+                    "%s{%s,phase=\"handler\"} %.9g\n",
+                    names[family], label, (double)b.guard_ns / 1e9,
+                    names[family], label, (double)b.action_ns / 1e9,
+                    names[family], label, (double)b.handler_ns / 1e9);
+            }
+        }
+    }
+
+    return flux_fsm_writer_flush(w);
+}
+
+/* 状态机在指标中的标识：trace_id，未设置时为结构体地址 */
+static unsigned long long flux_fsm_prom_machine(uint32_t trace_id, const void* m) {
+    return trace_id ? (unsigned long long)trace_id : (unsigned long long)(uintptr_t)m;
+}
+
+/**
+ * @brief 以 Prometheus 文本格式写出每个状态机的当前状态与缓存命中计数
+ * @note 当前状态与缓存计数均以宽松原子方式读取，采集线程可在事件线程运行时
+ *       调用，不阻塞事件线程；各值分别读取，彼此之间不保证是同一时刻的快照。
+ *       缓存的启用与关闭须与导出错开
+ */
+flux_fsm_rc_t flux_fsm_perf_write_machines(const flux_fsm_t* const* fsms, size_t n,
+    flux_fsm_writer_t* w)
+{
+    flux_fsm_prom_header(w, "flux_fsm_machine_state", "gauge", "Current state of each machine.");
+    for (size_t i = 0; i < n; i++) {
+        flux_fsm_writer_printf(w, "flux_fsm_machine_state{machine=\"%llu\"} %d\n",
+            flux_fsm_prom_machine(fsms[i]->trace_id, fsms[i]), flux_fsm_get_state(fsms[i]));
+    }
+
+    for (int misses = 0; misses < 2; misses++) {
+        const char* name = misses ? "flux_fsm_machine_cache_misses_total"
+                                  : "flux_fsm_machine_cache_hits_total";
+
+        flux_fsm_prom_header(w, name, "counter", misses
+            ? "Transition cache misses of each machine."
+            : "Transition cache hits of each machine.");
+        for (size_t i = 0; i < n; i++) {
+            uint64_t count[2];
+
+            if (flux_fsm_cache_stats(fsms[i], &count[0], &count[1]) == FLUX_FSM_OK) {
+                flux_fsm_writer_printf(w, "%s{machine=\"%llu\"} %llu\n", name,
+                    flux_fsm_prom_machine(fsms[i]->trace_id, fsms[i]),
+                    (unsigned long long)count[misses]);
+            }
+        }
+    }
+
+    return flux_fsm_writer_flush(w);
+}
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+/**
+ * @brief 以 Prometheus 文本格式写出线程安全实例的当前状态
+ * @note 状态以原子读取获得，可在事件线程运行时由采集线程调用
+ */
+flux_fsm_rc_t flux_fsm_perf_write_ts(const flux_fsm_ts_t* const* ts, size_t n,
+    flux_fsm_writer_t* w)
+{
+    flux_fsm_prom_header(w, "flux_fsm_machine_state", "gauge", "Current state of each machine.");
+    for (size_t i = 0; i < n; i++) {
+        flux_fsm_writer_printf(w, "flux_fsm_machine_state{machine=\"%llu\"} %d\n",
+            flux_fsm_prom_machine(ts[i]->trace_id, ts[i]), flux_fsm_ts_get_state(ts[i]));
+    }
+
+    return flux_fsm_writer_flush(w);
+}
+#endif
+
 void flux_fsm_perf_output(const flux_fsm_perf_t* perf) {
     if (perf->transitions > 0) {
         printf("%s\n", flux_fsm_perf_to_json(perf));
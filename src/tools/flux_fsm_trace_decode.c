@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flux_fsm_trace.h"
+
+/**
+ * @struct flux_fsm_trace_file_t
+ * @brief 已读入内存的追踪文件及其读取位置
+ *
+ * @var next 下一条待输出记录的序号
+ * @var end 已写入的记录总数
+ */
+typedef struct {
+    flux_fsm_trace_header_t header;
+    flux_fsm_trace_record_t* records;
+    uint64_t next;
+    uint64_t end;
+} flux_fsm_trace_file_t;
+
+static const char* flux_fsm_trace_rc_name(int32_t rc) {
+    switch (rc) {
+    case FLUX_FSM_OK:            return "OK";
+    case FLUX_FSM_ERROR:         return "ERROR";
+    case FLUX_FSM_GUARD_FAIL:    return "GUARD_FAIL";
+    case FLUX_FSM_INVALID_EVENT: return "INVALID_EVENT";
+    case FLUX_FSM_INVALID_STATE: return "INVALID_STATE";
+    default:                     return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief 读入并校验一个追踪文件
+ * @note 槽位已回绕时，最早的槽位可能正被写入时进程退出，因此跳过它
+ */
+static flux_fsm_rc_t flux_fsm_trace_load(const char* filename, flux_fsm_trace_file_t* file) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_trace_header_t* h = &file->header;
+    if (fread(h, sizeof(*h), 1, f) != 1
+        || memcmp(h->magic, FLUX_FSM_TRACE_MAGIC, sizeof(FLUX_FSM_TRACE_MAGIC)) != 0
+        || h->version != FLUX_FSM_TRACE_VERSION
+        || h->record_size != sizeof(flux_fsm_trace_record_t)
+        || h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0
+        || h->capacity > SIZE_MAX / sizeof(flux_fsm_trace_record_t)) {
+        fclose(f);
+        return FLUX_FSM_ERROR;
+    }
+
+    file->records = malloc((size_t)h->capacity * sizeof(flux_fsm_trace_record_t));
+    if (!file->records
+        || fread(file->records, sizeof(flux_fsm_trace_record_t), (size_t)h->capacity, f)
+           != (size_t)h->capacity) {
+        free(file->records);
+        file->records = NULL;
+        fclose(f);
+        return FLUX_FSM_ERROR;
+    }
+    fclose(f);
+
+    file->end = h->head;
+    file->next = h->head >= h->capacity ? h->head - h->capacity + 1 : 0;
+
+    return FLUX_FSM_OK;
+}
+
+static const flux_fsm_trace_record_t* flux_fsm_trace_at(const flux_fsm_trace_file_t* file, uint64_t i) {
+    return &file->records[i & (file->header.capacity - 1)];
+}
+
+static int64_t flux_fsm_trace_ns(const flux_fsm_trace_file_t* file, const flux_fsm_trace_record_t* rec) {
+    const flux_fsm_trace_header_t* h = &file->header;
+    return h->ns_base + (int64_t)((double)(int64_t)(rec->ticks - h->tick_base) * h->ns_per_tick);
+}
+
+static void flux_fsm_trace_print(FILE* out, int format, int first,
+    const flux_fsm_trace_file_t* file, const flux_fsm_trace_record_t* rec)
+{
+    int64_t ns = flux_fsm_trace_ns(file, rec);
+    const char* rc = flux_fsm_trace_rc_name(rec->rc);
+
+    if (format == FLUX_FSM_TRACE_JSON) {
+        fprintf(out, "%s\n  {\"time_ns\": %" PRId64 ", \"pid\": %" PRIu32 ", \"thread\": %" PRIu32
+                ", \"machine\": %" PRIu64 ", \"from\": %" PRId32 ", \"event\": %" PRId32
+                ", \"to\": %" PRId32 ", \"rc\": \"%s\"}",
+                first ? "" : ",", ns, file->header.pid, file->header.thread,
+                rec->machine, rec->from, rec->event, rec->to, rc);
+        return;
+    }
+
+    time_t sec = (time_t)(ns / 1000000000);
+    struct tm lt;
+    char time_str[32];
+    localtime_r(&sec, &lt);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &lt);
+
+    fprintf(out, "%s.%09" PRId64 " [%" PRIu32 ":%" PRIu32 "] ",
+            time_str, ns % 1000000000, file->header.pid, file->header.thread);
+    if (rec->machine > UINT32_MAX) {
+        fprintf(out, "machine=0x%" PRIx64, rec->machine);
+    } else {
+        fprintf(out, "machine=%" PRIu64, rec->machine);
+    }
+    fprintf(out, " %" PRId32 " --%" PRId32 "--> %" PRId32 " %s\n",
+            rec->from, rec->event, rec->to, rc);
+}
+
+/**
+ * @brief 解码追踪文件
+ * @param files 文件路径数组，通常为同一次追踪中各线程的文件
+ * @param n 文件数量
+ * @param format FLUX_FSM_TRACE_TEXT 每行一条；FLUX_FSM_TRACE_JSON 输出对象数组
+ * @param out 输出流
+ * @return 成功返回 FLUX_FSM_OK，任一文件格式不符返回 FLUX_FSM_ERROR 且不输出
+ * @note 多个文件按换算后的墙钟时间归并，同一文件内保持写入顺序
+ */
+flux_fsm_rc_t flux_fsm_trace_decode(const char* const* files, size_t n, int format, FILE* out) {
+    if (!files || !n || !out) {
+        return FLUX_FSM_INVALID_EVENT;
+    }
+
+    flux_fsm_trace_file_t* loaded = calloc(n, sizeof(flux_fsm_trace_file_t));
+    if (!loaded) {
+        return FLUX_FSM_ERROR;
+    }
+
+    flux_fsm_rc_t rc = FLUX_FSM_OK;
+    for (size_t i = 0; i < n && rc == FLUX_FSM_OK; i++) {
+        rc = files[i] ? flux_fsm_trace_load(files[i], &loaded[i]) : FLUX_FSM_INVALID_EVENT;
+    }
+
+    if (rc == FLUX_FSM_OK) {
+        if (format == FLUX_FSM_TRACE_JSON) {
+            fputs("[", out);
+        }
+
+        /* 文件数通常等于线程数，逐条选取最早的记录即可 */
+        for (int first = 1; ; first = 0) {
+            const flux_fsm_trace_file_t* pick = NULL;
+            int64_t best = 0;
+            size_t pick_i = 0;
+
+            for (size_t i = 0; i < n; i++) {
+                if (loaded[i].next == loaded[i].end) {
+                    continue;
+                }
+                int64_t ns = flux_fsm_trace_ns(&loaded[i], flux_fsm_trace_at(&loaded[i], loaded[i].next));
+                if (!pick || ns < best) {
+                    pick = &loaded[i];
+                    pick_i = i;
+                    best = ns;
+                }
+            }
+            if (!pick) {
+                break;
+            }
+
+            flux_fsm_trace_print(out, format, first, pick, flux_fsm_trace_at(pick, pick->next));
+            loaded[pick_i].next++;
+        }
+
+        if (format == FLUX_FSM_TRACE_JSON) {
+            fputs("\n]\n", out);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        free(loaded[i].records);
+    }
+    free(loaded);
+
+    return rc;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "flux_fsm_trace.h"
+
+static void usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [-j] [-o output] trace...\n", argv0);
+}
+
+/* 追踪文件 -> 文本或 JSON，多个文件按时间归并，未指定 -o 时输出到标准输出 */
+int main(int argc, char** argv) {
+    int format = FLUX_FSM_TRACE_TEXT;
+    const char* output = NULL;
+    int first = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0) {
+            format = FLUX_FSM_TRACE_JSON;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argv[i][0] != '-') {
+            first = i;
+            break;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!first) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "%s: cannot open output\n", output);
+        return 1;
+    }
+
+    flux_fsm_rc_t rc = flux_fsm_trace_decode((const char* const*)&argv[first],
+                                             (size_t)(argc - first), format, out);
+    if (out != stdout && fclose(out) != 0) {
+        rc = FLUX_FSM_ERROR;
+    }
+
+    if (rc != FLUX_FSM_OK) {
+        fprintf(stderr, "invalid or unreadable trace file\n");
+        return 1;
+    }
+
+    return 0;
+}
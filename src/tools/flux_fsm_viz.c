@@ -17,7 +17,9 @@ flux_fsm_viz_validation_result_t flux_fsm_viz_validate(const flux_fsm_t* fsm) {
 
     /* 检查状态转换完整性 */
     for (size_t i = 0; i < fsm->transition_count; ++i) {
-        const flux_fsm_transition_t* t = &fsm->transitions[i];
+        flux_fsm_transition_t trans;
+        const flux_fsm_transition_t* t = &trans;
+        flux_fsm_get_transition(fsm, i, &trans);
         
         if (t->from < 0 || t->from >= (int)fsm->state_count) {
             result.error_code = 2;
@@ -35,6 +37,57 @@ flux_fsm_viz_validation_result_t flux_fsm_viz_validate(const flux_fsm_t* fsm) {
     return result;
 }
 
+/* 权重 [0, 1] 映射为由蓝（冷）到红（热）的 HSV 颜色 */
+static void flux_fsm_viz_heat_color(char* buf, size_t size, double w, double saturation) {
+    if (w > 1.0) {
+        w = 1.0;
+    }
+    snprintf(buf, size, "%.3f %.3f 1.000", 0.667 * (1.0 - w), saturation);
+}
+
+/*
+ * 以剖析数据输出节点与边：节点标注累计停留时间并按其占比填色，
+ * 边标注转移命中次数，颜色与线宽按命中次数相对最大值缩放
+ */
+static void flux_fsm_viz_heatmap(FILE* out, flux_fsm_t* fsm) {
+    uint64_t max_hits = 0;
+    uint64_t max_dwell = 0;
+    char color[32];
+
+    for (size_t i = 0; i < fsm->transition_count; ++i) {
+        uint64_t hits = flux_fsm_profile_hits(fsm, i);
+        if (hits > max_hits) {
+            max_hits = hits;
+        }
+    }
+    for (size_t i = 0; i < fsm->state_count; ++i) {
+        uint64_t dwell = flux_fsm_profile_dwell_ns(fsm, (int)i);
+        if (dwell > max_dwell) {
+            max_dwell = dwell;
+        }
+    }
+
+    for (size_t i = 0; i < fsm->state_count; ++i) {
+        uint64_t dwell = flux_fsm_profile_dwell_ns(fsm, (int)i);
+        double w = max_dwell ? (double)dwell / (double)max_dwell : 0.0;
+
+        flux_fsm_viz_heat_color(color, sizeof(color), w, 0.5);
+        fprintf(out, "    %zu [label=\"%zu\\n%.3f ms\", style=filled, fillcolor=\"%s\"];\n",
+                i, i, (double)dwell / 1e6, color);
+    }
+
+    for (size_t i = 0; i < fsm->transition_count; ++i) {
+        flux_fsm_transition_t t;
+        uint64_t hits = flux_fsm_profile_hits(fsm, i);
+        double w = max_hits ? (double)hits / (double)max_hits : 0.0;
+
+        flux_fsm_get_transition(fsm, i, &t);
+        flux_fsm_viz_heat_color(color, sizeof(color), w, 1.0);
+        fprintf(out, "    %d -> %d [label=\"%llu\", penwidth=%.1f, color=\"%s\"];\n",
+                t.from, t.to, (unsigned long long)hits, 1.0 + 4.0 * w, color);
+    }
+}
+
 /* 生成 FSM 的可视化图表 */
 char* flux_fsm_viz_generate(flux_fsm_t* fsm, flux_fsm_viz_config_t* cfg) {
     if (!fsm || !cfg) {
@@ -72,15 +125,21 @@ char* flux_fsm_viz_generate(flux_fsm_t* fsm, flux_fsm_viz_config_t* cfg) {
         fprintf(temp_file, "    edge [style=%s];\n", cfg->edge_style);
     }
 
-    /* 添加状态节点 */
-    for (size_t i = 0; i < fsm->state_count; ++i) {
-        fprintf(temp_file, "    %zu;\n", i);
-    }
+    if (cfg->heatmap && fsm->profile) {
+        flux_fsm_viz_heatmap(temp_file, fsm);
+    } else {
+        /* 添加状态节点 */
+        for (size_t i = 0; i < fsm->state_count; ++i) {
+            fprintf(temp_file, "    %zu;\n", i);
+        }
 
-    /* 添加状态转换 */
-    for (size_t i = 0; i < fsm->transition_count; ++i) {
-        const flux_fsm_transition_t* t = &fsm->transitions[i];
-        fprintf(temp_file, "    %d -> %d;\n", t->from, t->to);
+        /* 添加状态转换 */
+        for (size_t i = 0; i < fsm->transition_count; ++i) {
+            flux_fsm_transition_t trans;
+            const flux_fsm_transition_t* t = &trans;
+            flux_fsm_get_transition(fsm, i, &trans);
+            fprintf(temp_file, "    %d -> %d;\n", t->from, t->to);
+        }
     }
 
     fprintf(temp_file, "}\n");
@@ -3,9 +3,18 @@
  */
 
 #include <unity.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
 #include "../../include/flux_fsm_core.h"
 #include "../../include/flux_fsm_event.h"
 #include "../../include/flux_fsm_log.h"
+#include "../../include/flux_fsm_queue.h"
 
 flux_fsm_t* fsm;
 flux_fsm_log_t* flux_fsm_log;
@@ -118,6 +127,1077 @@ void test_flux_fsm_handler(void) {
     TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_exec_transition(fsm, trans_idx));
 }
 
+void test_flux_fsm_seal(void) {
+    /* 稠密与稀疏事件混合，并包含重复 (状态, 事件) */
+    for (int s = 0; s < 40; s++) {
+        for (int k = 0; k < 6; k++) {
+            flux_fsm_transition_t trans = {
+                .from = s,
+                .event = (s % 2) ? k : k * 1000,
+                .to = (s + k + 1) % 40,
+                .guard = NULL,
+                .action = NULL
+            };
+            TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &trans));
+        }
+        flux_fsm_transition_t dup = { s, 0, STATE_INIT, NULL, NULL };
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &dup));
+    }
+
+    int expected[40][8];
+    for (int s = 0; s < 40; s++) {
+        fsm->current_state = s;
+        for (int k = 0; k < 8; k++) {
+            expected[s][k] = flux_fsm_find_transition(fsm, (s % 2) ? k : k * 1000);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(fsm));
+    TEST_ASSERT_NOT_NULL(fsm->index);
+    for (int s = 0; s < 40; s++) {
+        fsm->current_state = s;
+        for (int k = 0; k < 8; k++) {
+            TEST_ASSERT_EQUAL_INT(expected[s][k],
+                flux_fsm_find_transition(fsm, (s % 2) ? k : k * 1000));
+        }
+    }
+
+    /* 封存后继续添加转移，索引自动重建 */
+    flux_fsm_transition_t late = { 45, EVENT_STOP, STATE_DONE, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &late));
+    TEST_ASSERT_NULL(fsm->index);
+    fsm->current_state = 45;
+    TEST_ASSERT_EQUAL_INT(40 * 7, flux_fsm_find_transition(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(-1, flux_fsm_find_transition(fsm, EVENT_START));
+    TEST_ASSERT_NOT_NULL(fsm->index);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(STATE_DONE, flux_fsm_get_state(fsm));
+}
+
+void test_flux_fsm_def_shared(void) {
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    TEST_ASSERT_NOT_NULL(def);
+
+    flux_fsm_transition_t start = { STATE_INIT, EVENT_START, STATE_WORK, test_guard, test_action };
+    flux_fsm_transition_t stop = { STATE_WORK, EVENT_STOP, STATE_DONE, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &start));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &stop));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_handler(def, STATE_WORK, test_handler));
+
+    /* 未封存的定义不能实例化 */
+    flux_fsm_inst_t insts[4];
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_inst_init(&insts[0], def, STATE_INIT, &ctx));
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_seal(def));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_def_add_transition(def, &start));
+
+    test_context_t ctxs[4];
+    for (int i = 0; i < 4; i++) {
+        ctxs[i].value = i;
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_inst_init(&insts[i], def, STATE_INIT, &ctxs[i]));
+    }
+
+    /* 定义的引用由实例持有，释放创建者引用后仍然有效 */
+    flux_fsm_def_release(def);
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_GUARD_FAIL, flux_fsm_inst_process_event(&insts[0], EVENT_START));
+    TEST_ASSERT_EQUAL_INT(STATE_INIT, flux_fsm_inst_get_state(&insts[0]));
+    for (int i = 1; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_inst_process_event(&insts[i], EVENT_START));
+        TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_inst_get_state(&insts[i]));
+        TEST_ASSERT_EQUAL_INT(i + 1, ctxs[i].value);
+    }
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_inst_process_event(&insts[2], EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(STATE_DONE, flux_fsm_inst_get_state(&insts[2]));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_inst_process_event(&insts[2], EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_inst_get_state(&insts[1]));
+
+    for (int i = 0; i < 4; i++) {
+        flux_fsm_inst_fini(&insts[i]);
+    }
+}
+
+static int pool_cleanups;
+
+static void test_pool_cleanup(void* data) {
+    (void)data;
+    pool_cleanups++;
+}
+
+void test_flux_fsm_pool(void) {
+    flux_fsm_pool_t* pool = flux_fsm_pool_create(1024);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    /* 对齐分配与大块分配 */
+    unsigned char* first = flux_fsm_palloc(pool, 3);
+    TEST_ASSERT_NOT_NULL(first);
+    void* aligned = flux_fsm_palloc(pool, sizeof(double));
+    TEST_ASSERT_EQUAL_INT(0, (size_t)aligned % _Alignof(max_align_t));
+    TEST_ASSERT_NOT_NULL(flux_fsm_palloc(pool, 64 * 1024));
+
+    /* 大量池状态机跨越多个块 */
+    flux_fsm_transition_t start = { STATE_INIT, EVENT_START, STATE_WORK, NULL, test_action };
+    flux_fsm_transition_t stop = { STATE_WORK, EVENT_STOP, STATE_DONE, NULL, NULL };
+    flux_fsm_t* machines[64];
+    for (int i = 0; i < 64; i++) {
+        machines[i] = flux_fsm_create_from_pool(pool, STATE_INIT, &ctx);
+        TEST_ASSERT_NOT_NULL(machines[i]);
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(machines[i], &start));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(machines[i], &stop));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_handler(machines[i], STATE_WORK, test_handler));
+        if (i % 2) {
+            TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(machines[i]));
+        }
+    }
+    for (int i = 0; i < 64; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(machines[i], EVENT_START));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(machines[i], EVENT_STOP));
+        TEST_ASSERT_EQUAL_INT(STATE_DONE, flux_fsm_get_state(machines[i]));
+        flux_fsm_destroy(machines[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(65, ctx.value);
+
+    /* 池实例在重置时释放定义引用 */
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &stop));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_seal(def));
+    flux_fsm_inst_t* inst = flux_fsm_inst_create_from_pool(pool, def, STATE_WORK, &ctx);
+    TEST_ASSERT_NOT_NULL(inst);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_inst_process_event(inst, EVENT_STOP));
+
+    pool_cleanups = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_pool_cleanup_add(pool, test_pool_cleanup, NULL));
+
+    /* 重置后首块从头复用 */
+    flux_fsm_pool_reset(pool);
+    TEST_ASSERT_EQUAL_INT(1, pool_cleanups);
+    TEST_ASSERT_EQUAL_PTR(first, flux_fsm_palloc(pool, 3));
+
+    flux_fsm_def_release(def);
+    flux_fsm_pool_destroy(pool);
+}
+
+void test_flux_fsm_bulk_load(void) {
+    flux_fsm_transition_t table[300];
+    for (int i = 0; i < 300; i++) {
+        table[i] = (flux_fsm_transition_t){ i, EVENT_START, i + 1, NULL, NULL };
+    }
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_reserve(fsm, 100, 4));
+    TEST_ASSERT_TRUE(fsm->transition_capacity >= 100);
+    TEST_ASSERT_TRUE(fsm->handler_capacity >= 4);
+    TEST_ASSERT_EQUAL_INT(0, fsm->handler_count);
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transitions(fsm, table, 200));
+    for (int i = 200; i < 300; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &table[i]));
+    }
+    TEST_ASSERT_EQUAL_INT(300, fsm->transition_count);
+    TEST_ASSERT_TRUE(fsm->transition_capacity >= 300 && fsm->transition_capacity < 600);
+    TEST_ASSERT_EQUAL_INT(301, fsm->state_count);
+
+    /* 处理器表按状态号增长，新槽位为空 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_handler(fsm, 9, test_handler));
+    TEST_ASSERT_EQUAL_INT(10, fsm->handler_count);
+    TEST_ASSERT_NULL(fsm->handlers[5]);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE, flux_fsm_add_handler(fsm, -1, test_handler));
+
+    for (int i = 0; i < 300; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+    }
+    TEST_ASSERT_EQUAL_INT(300, flux_fsm_get_state(fsm));
+}
+
+void test_flux_fsm_process_events(void) {
+    flux_fsm_transition_t table[] = {
+        { STATE_INIT, EVENT_START, STATE_WORK, NULL, test_action },
+        { STATE_WORK, EVENT_STOP, STATE_INIT, NULL, NULL }
+    };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transitions(fsm, table, 2));
+
+    flux_fsm_event_t events[] = { EVENT_START, EVENT_STOP, EVENT_STOP, EVENT_START };
+    flux_fsm_rc_t results[4];
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_events(fsm, events, 4, results));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, results[0]);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, results[1]);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, results[2]);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, results[3]);
+    TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_get_state(fsm));
+    TEST_ASSERT_EQUAL_INT(3, ctx.value);
+
+    /* 多状态机并行数组，含重复出现的状态机 */
+    enum { N = 100 };
+    flux_fsm_t* machines[N];
+    flux_fsm_t* targets[N + 1];
+    flux_fsm_event_t fan[N + 1];
+    for (int i = 0; i < N; i++) {
+        machines[i] = flux_fsm_create(STATE_INIT, &ctx);
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transitions(machines[i], table, 2));
+        if (i % 3 == 0) {
+            TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(machines[i]));
+        }
+        targets[i] = machines[i];
+        fan[i] = EVENT_START;
+    }
+    targets[N] = machines[7];
+    fan[N] = EVENT_STOP;
+
+    ctx.value = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_events_multi(targets, fan, N + 1, NULL));
+    TEST_ASSERT_EQUAL_INT(N, ctx.value);
+    for (int i = 0; i < N; i++) {
+        TEST_ASSERT_EQUAL_INT(i == 7 ? STATE_INIT : STATE_WORK, flux_fsm_get_state(machines[i]));
+        flux_fsm_destroy(machines[i]);
+    }
+}
+
+#define QUEUE_PRODUCERS  4
+#define QUEUE_PER_THREAD 5000
+
+static int queue_last_seq[QUEUE_PRODUCERS];
+static int queue_order_ok;
+static int queue_seen;
+
+/* 事件编码为 producer * QUEUE_PER_THREAD + seq，检查每个生产者内部有序 */
+static void queue_order_handler(void* context, int event) {
+    (void)context;
+    int producer = event / QUEUE_PER_THREAD;
+    int seq = event % QUEUE_PER_THREAD;
+    if (seq != queue_last_seq[producer] + 1) {
+        queue_order_ok = 0;
+    }
+    queue_last_seq[producer] = seq;
+    queue_seen++;
+}
+
+static void* queue_producer(void* arg) {
+    int producer = (int)(size_t)arg;
+    for (int seq = 0; seq < QUEUE_PER_THREAD; seq++) {
+        while (flux_fsm_post_event(fsm, producer * QUEUE_PER_THREAD + seq) != FLUX_FSM_OK) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_flux_fsm_queue(void) {
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_EVENT, flux_fsm_post_event(fsm, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_queue_init(fsm, 200));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_queue_init(fsm, 200));
+
+    /* 有界：容量取整为 256 */
+    for (int i = 0; i < 256; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_post_event(fsm, EVENT_STOP));
+    }
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_post_event(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(256, flux_fsm_pending(fsm));
+    TEST_ASSERT_EQUAL_INT(256, flux_fsm_drain(fsm, 0));
+    TEST_ASSERT_EQUAL_INT(0, flux_fsm_pending(fsm));
+
+    for (int e = 0; e < QUEUE_PRODUCERS * QUEUE_PER_THREAD; e++) {
+        flux_fsm_transition_t loop = { STATE_INIT, e, STATE_INIT, NULL, NULL };
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &loop));
+    }
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(fsm));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_handler(fsm, STATE_INIT, queue_order_handler));
+
+    for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+        queue_last_seq[i] = -1;
+    }
+    queue_order_ok = 1;
+    queue_seen = 0;
+
+    pthread_t threads[QUEUE_PRODUCERS];
+    for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+        pthread_create(&threads[i], NULL, queue_producer, (void*)(size_t)i);
+    }
+
+    /* 当前线程作为唯一消费者，与生产者并发排空 */
+    size_t drained = 0;
+    while (drained < QUEUE_PRODUCERS * QUEUE_PER_THREAD) {
+        drained += flux_fsm_drain(fsm, 64);
+    }
+    for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, flux_fsm_drain(fsm, 0));
+    TEST_ASSERT_EQUAL_INT(QUEUE_PRODUCERS * QUEUE_PER_THREAD, queue_seen);
+    TEST_ASSERT_TRUE(queue_order_ok);
+}
+
+#define TS_STATES   8
+#define TS_THREADS  4
+#define TS_PER_THREAD 20000
+
+static flux_fsm_ts_t ts_machine;
+static atomic_int ts_actions;
+
+static void ts_action(void* context) {
+    (void)context;
+    atomic_fetch_add_explicit(&ts_actions, 1, memory_order_relaxed);
+}
+
+static void* ts_worker(void* arg) {
+    (void)arg;
+    for (int i = 0; i < TS_PER_THREAD; i++) {
+        flux_fsm_ts_process_event(&ts_machine, EVENT_START);
+    }
+    return NULL;
+}
+
+void test_flux_fsm_ts(void) {
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    for (int s = 0; s < TS_STATES; s++) {
+        flux_fsm_transition_t next = { s, EVENT_START, (s + 1) % TS_STATES, NULL, ts_action };
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &next));
+    }
+    flux_fsm_transition_t stop = { 0, EVENT_STOP, TS_STATES, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &stop));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_seal(def));
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_ts_init(&ts_machine, def, 0, NULL));
+    flux_fsm_def_release(def);
+    atomic_init(&ts_actions, 0);
+
+    /* 基于过期的观察状态提交失败，状态不变 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_ts_try_event(&ts_machine, 0, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE, flux_fsm_ts_try_event(&ts_machine, 0, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(1, flux_fsm_ts_get_state(&ts_machine));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_ts_process_event(&ts_machine, EVENT_STOP));
+
+    pthread_t threads[TS_THREADS];
+    for (int i = 0; i < TS_THREADS; i++) {
+        pthread_create(&threads[i], NULL, ts_worker, NULL);
+    }
+    for (int i = 0; i < TS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* 每个事件恰好提交一次：总步数与动作次数均确定 */
+    int total = 1 + TS_THREADS * TS_PER_THREAD;
+    TEST_ASSERT_EQUAL_INT(total, atomic_load(&ts_actions));
+    TEST_ASSERT_EQUAL_INT(total % TS_STATES, flux_fsm_ts_get_state(&ts_machine));
+
+    flux_fsm_ts_fini(&ts_machine);
+}
+
+void test_flux_fsm_compact(void) {
+    TEST_ASSERT_EQUAL_INT(8, sizeof(flux_fsm_compact_t));
+
+    flux_fsm_transition_t start = { STATE_INIT, EVENT_START, STATE_WORK, test_guard, test_action };
+    flux_fsm_transition_t stop = { STATE_WORK, EVENT_STOP, STATE_DONE, test_guard, test_action };
+    flux_fsm_transition_t reset = { STATE_DONE, EVENT_START, STATE_INIT, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &start));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &stop));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &reset));
+
+    /* 超出 16 位的取值无法压缩，状态机保持不变 */
+    flux_fsm_transition_t wide = { STATE_DONE, 70000, STATE_INIT, NULL, NULL };
+    flux_fsm_t* wide_fsm = flux_fsm_create(STATE_INIT, &ctx);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(wide_fsm, &start));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(wide_fsm, &wide));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_compact(wide_fsm));
+    TEST_ASSERT_NULL(wide_fsm->compact);
+    TEST_ASSERT_EQUAL_INT(0, wide_fsm->callback_count);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(wide_fsm, EVENT_START));
+    flux_fsm_destroy(wide_fsm);
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_compact(fsm));
+    TEST_ASSERT_NULL(fsm->transitions);
+    TEST_ASSERT_NOT_NULL(fsm->compact);
+    TEST_ASSERT_EQUAL_INT(1, fsm->callback_count);
+
+    flux_fsm_transition_t t;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_get_transition(fsm, 1, &t));
+    TEST_ASSERT_EQUAL_INT(STATE_WORK, t.from);
+    TEST_ASSERT_EQUAL_INT(EVENT_STOP, t.event);
+    TEST_ASSERT_EQUAL_INT(STATE_DONE, t.to);
+    TEST_ASSERT_TRUE(t.guard == test_guard);
+    TEST_ASSERT_TRUE(t.action == test_action);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_get_transition(fsm, 3, &t));
+
+    /* 压缩后仍可追加转移；新转移同样受 16 位限制 */
+    flux_fsm_transition_t skip = { STATE_INIT, EVENT_STOP, STATE_DONE, NULL, test_action };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &skip));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_add_transition(fsm, &wide));
+    TEST_ASSERT_EQUAL_INT(4, fsm->transition_count);
+    TEST_ASSERT_EQUAL_INT(2, fsm->callback_count);
+
+    for (int sealed = 0; sealed < 2; sealed++) {
+        ctx.value = 1;
+        fsm->current_state = STATE_INIT;
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+        TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_get_state(fsm));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+        TEST_ASSERT_EQUAL_INT(STATE_DONE, flux_fsm_get_state(fsm));
+        TEST_ASSERT_EQUAL_INT(3, ctx.value);
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+        TEST_ASSERT_EQUAL_INT(STATE_DONE, flux_fsm_get_state(fsm));
+        TEST_ASSERT_EQUAL_INT(4, ctx.value);
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_event(fsm, EVENT_STOP));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(fsm));
+    }
+
+    /* 共享定义：封存前压缩，实例照常运行 */
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &start));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_compact(def));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_seal(def));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_def_compact(def));
+
+    flux_fsm_inst_t inst;
+    ctx.value = 1;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_inst_init(&inst, def, STATE_INIT, &ctx));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_inst_process_event(&inst, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_inst_get_state(&inst));
+    TEST_ASSERT_EQUAL_INT(2, ctx.value);
+    flux_fsm_inst_fini(&inst);
+    flux_fsm_def_release(def);
+}
+
+void test_flux_fsm_scan(void) {
+    /* 未封存：查找走键列扫描，覆盖向量块内各个位置与尾部 */
+    for (int i = 0; i < 203; i++) {
+        flux_fsm_transition_t t = { i % 7, i, (i + 1) % 7, NULL, NULL };
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &t));
+    }
+
+    /* 低 16 位相同的键：必须核对完整的 (from, event) */
+    flux_fsm_transition_t alias_event = { 3, 65536 + 10, 5, NULL, NULL };
+    flux_fsm_transition_t alias_from = { 65536 + 3, 10, 6, NULL, NULL };
+    flux_fsm_transition_t dup = { 3, 10, 4, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &alias_event));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &alias_from));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &dup));
+
+    for (int i = 0; i < 203; i++) {
+        fsm->current_state = i % 7;
+        TEST_ASSERT_EQUAL_INT(i, flux_fsm_find_transition(fsm, i));
+        fsm->current_state = (i + 1) % 7;
+        TEST_ASSERT_EQUAL_INT(-1, flux_fsm_find_transition(fsm, i));
+    }
+
+    fsm->current_state = 3;
+    TEST_ASSERT_EQUAL_INT(10, flux_fsm_find_transition(fsm, 10));
+    TEST_ASSERT_EQUAL_INT(203, flux_fsm_find_transition(fsm, 65536 + 10));
+    fsm->current_state = 65536 + 3;
+    TEST_ASSERT_EQUAL_INT(204, flux_fsm_find_transition(fsm, 10));
+    TEST_ASSERT_EQUAL_INT(-1, flux_fsm_find_transition(fsm, 11));
+
+    /* 负状态在封存后仍走线性查找 */
+    flux_fsm_transition_t any = { FLUX_FSM_ANY_STATE, 7, 0, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &any));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(fsm));
+    fsm->current_state = FLUX_FSM_ANY_STATE;
+    TEST_ASSERT_EQUAL_INT(206, flux_fsm_find_transition(fsm, 7));
+    TEST_ASSERT_EQUAL_INT(-1, flux_fsm_find_transition(fsm, 7 + 65536));
+}
+
+static int filter_guard_calls;
+
+static int filter_guard(void* context) {
+    (void)context;
+    filter_guard_calls++;
+    return 1;
+}
+
+void test_flux_fsm_event_filter(void) {
+    flux_fsm_transition_t start = { STATE_INIT, EVENT_START, STATE_WORK, filter_guard, NULL };
+    flux_fsm_transition_t tick = { STATE_WORK, 64 + EVENT_STOP, STATE_WORK, filter_guard, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &start));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &tick));
+    TEST_ASSERT_TRUE(fsm->event_mask_capacity > STATE_WORK);
+
+    /* 当前状态下无效的事件被位图直接拒绝 */
+    filter_guard_calls = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_event(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(-1, flux_fsm_find_transition(fsm, 99));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(1, filter_guard_calls);
+
+    /* 位图按 event & 63 取位：同位不同值的事件仍由查找判定 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_event(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, 64 + EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_get_state(fsm));
+
+    /* 没有出边的状态拒绝一切事件；位图随后续转移增量更新 */
+    fsm->current_state = STATE_DONE;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_event(fsm, EVENT_START));
+    flux_fsm_transition_t reset = { STATE_DONE, EVENT_START, STATE_INIT, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &reset));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(STATE_INIT, flux_fsm_get_state(fsm));
+
+    /* 超出位图范围的状态不过滤，照常查找 */
+    flux_fsm_transition_t far = { FLUX_FSM_EVENT_MASK_STATES + 1, EVENT_STOP, STATE_INIT, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &far));
+    TEST_ASSERT_TRUE(fsm->event_mask_capacity <= FLUX_FSM_EVENT_MASK_STATES);
+    fsm->current_state = FLUX_FSM_EVENT_MASK_STATES + 1;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_event(fsm, EVENT_START));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(STATE_INIT, flux_fsm_get_state(fsm));
+}
+
+void test_flux_fsm_cache(void) {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_cache_stats(fsm, &hits, &misses));
+
+    flux_fsm_transition_t start = { STATE_INIT, EVENT_START, STATE_WORK, NULL, NULL };
+    flux_fsm_transition_t back = { STATE_WORK, EVENT_STOP, STATE_INIT, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &start));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &back));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_cache_enable(fsm, 5));
+
+    /* 首轮未命中，之后全部命中 */
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+    }
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_cache_stats(fsm, &hits, &misses));
+    TEST_ASSERT_EQUAL_INT(18, hits);
+    TEST_ASSERT_EQUAL_INT(2, misses);
+
+    /* 位图拒绝的事件不经过缓存 */
+    flux_fsm_transition_t tick = { STATE_WORK, EVENT_START, STATE_WORK, NULL, NULL };
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_process_event(fsm, 2));
+
+    /* 添加转移使缓存失效：同一 (状态, 事件) 重新查找 */
+    fsm->current_state = STATE_WORK;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(fsm, &tick));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_cache_stats(fsm, &hits, &misses));
+    TEST_ASSERT_EQUAL_INT(18, hits);
+    TEST_ASSERT_EQUAL_INT(3, misses);
+
+    /* 封存后缓存在索引之前生效 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(fsm));
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_START));
+        TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_get_state(fsm));
+    }
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_cache_stats(fsm, &hits, &misses));
+    TEST_ASSERT_EQUAL_INT(19, hits);
+    TEST_ASSERT_EQUAL_INT(5, misses);
+
+    flux_fsm_cache_disable(fsm);
+    TEST_ASSERT_NULL(fsm->cache);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_process_event(fsm, EVENT_STOP));
+}
+
+#define IMAGE_STATES  10000
+#define IMAGE_EVENTS  5
+#define IMAGE_FILE    "test_fsm_image.bin"
+
+void test_flux_fsm_image(void) {
+    static const flux_fsm_symbol_t symbols[] = {
+        {"test_guard", test_guard, NULL, NULL},
+        {"test_action", NULL, test_action, NULL},
+        {"test_handler", NULL, NULL, test_handler},
+    };
+
+    /* 50k 条转移 */
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    for (int s = 0; s < IMAGE_STATES; s++) {
+        for (int e = 0; e < IMAGE_EVENTS; e++) {
+            flux_fsm_transition_t t = {s, e, (s * 7 + e) % IMAGE_STATES,
+                                       e == 1 ? test_guard : NULL, e == 2 ? test_action : NULL};
+            TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_add_transition(def, &t));
+        }
+    }
+    flux_fsm_def_add_handler(def, 3, test_handler);
+
+    /* 未封存的定义不能保存 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_def_save(def, IMAGE_FILE, symbols, 3));
+    flux_fsm_def_seal(def);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_def_save(def, IMAGE_FILE, symbols, 2));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_save(def, IMAGE_FILE, symbols, 3));
+
+    /* 缺少符号时无法加载 */
+    TEST_ASSERT_NULL(flux_fsm_def_map(IMAGE_FILE, symbols, 1));
+
+    flux_fsm_def_t* mapped = flux_fsm_def_map(IMAGE_FILE, symbols, 3);
+    TEST_ASSERT_NOT_NULL(mapped);
+
+    const flux_fsm_t* table = flux_fsm_def_table(mapped);
+    TEST_ASSERT_EQUAL_size_t(IMAGE_STATES * IMAGE_EVENTS, table->transition_count);
+    TEST_ASSERT_TRUE(table->sealed);
+
+    flux_fsm_transition_t a, b;
+    flux_fsm_get_transition(flux_fsm_def_table(def), 12347, &a);
+    flux_fsm_get_transition(table, 12347, &b);
+    TEST_ASSERT_EQUAL_INT(a.from, b.from);
+    TEST_ASSERT_EQUAL_INT(a.to, b.to);
+    TEST_ASSERT_TRUE(a.guard == b.guard && a.action == b.action);
+
+    /* 两个定义上的实例对同一事件序列给出相同结果 */
+    test_context_t c1 = {0};
+    test_context_t c2 = {0};
+    flux_fsm_inst_t built;
+    flux_fsm_inst_t loaded;
+    flux_fsm_inst_init(&built, def, 0, &c1);
+    flux_fsm_inst_init(&loaded, mapped, 0, &c2);
+
+    for (int i = 0; i < 20000; i++) {
+        flux_fsm_event_t e = (i * 31 + i / 7) % (IMAGE_EVENTS + 1);
+        TEST_ASSERT_EQUAL_INT(flux_fsm_inst_process_event(&built, e),
+                              flux_fsm_inst_process_event(&loaded, e));
+        TEST_ASSERT_EQUAL_INT(flux_fsm_inst_get_state(&built), flux_fsm_inst_get_state(&loaded));
+    }
+    TEST_ASSERT_EQUAL_INT(c1.value, c2.value);
+
+    flux_fsm_inst_fini(&built);
+    flux_fsm_inst_fini(&loaded);
+    flux_fsm_def_release(mapped);
+    flux_fsm_def_release(def);
+
+    /* 格式不符的文件 */
+    FILE* f = fopen(IMAGE_FILE, "wb");
+    char junk[256] = "not an image";
+    fwrite(junk, 1, sizeof(junk), f);
+    fclose(f);
+    TEST_ASSERT_NULL(flux_fsm_def_map(IMAGE_FILE, symbols, 3));
+
+    /* 逐字节损坏小映像：要么拒绝加载，要么加载后分派不越界 */
+    def = flux_fsm_def_create();
+    flux_fsm_transition_t small[] = {
+        {0, 0, 1, test_guard, NULL},
+        {0, 1, 2, NULL, test_action},
+        {1, 0, 2, NULL, NULL},
+        {1, 40, 0, NULL, NULL},
+        {2, 2, 0, test_guard, test_action},
+    };
+    flux_fsm_def_add_transitions(def, small, 5);
+    flux_fsm_def_add_handler(def, 2, test_handler);
+    flux_fsm_def_seal(def);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_def_save(def, IMAGE_FILE, symbols, 3));
+    flux_fsm_def_release(def);
+
+    f = fopen(IMAGE_FILE, "rb");
+    unsigned char image[4096];
+    size_t size = fread(image, 1, sizeof(image), f);
+    fclose(f);
+    TEST_ASSERT_TRUE(size > 0 && size < sizeof(image));
+
+    size_t rejected = 0;
+    for (size_t i = 0; i < size; i++) {
+        image[i] ^= 0xff;
+        f = fopen(IMAGE_FILE, "wb");
+        fwrite(image, 1, size, f);
+        fclose(f);
+        image[i] ^= 0xff;
+
+        mapped = flux_fsm_def_map(IMAGE_FILE, symbols, 3);
+        if (!mapped) {
+            rejected++;
+            continue;
+        }
+
+        test_context_t c = {1};
+        flux_fsm_inst_init(&loaded, mapped, 0, &c);
+        for (int e = 0; e < 64; e++) {
+            flux_fsm_inst_process_event(&loaded, e % 3 ? e % 3 : 40);
+        }
+        flux_fsm_inst_fini(&loaded);
+        flux_fsm_def_release(mapped);
+    }
+    TEST_ASSERT_TRUE(rejected > 0);
+
+    /* 转移行的目标状态被改写：区间仍合法，但哈希不符 */
+    flux_fsm_compact_t row = {1, 0, 2, 0};
+    size_t at = 0;
+    while (at + sizeof(row) <= size && memcmp(image + at, &row, sizeof(row)) != 0) {
+        at++;
+    }
+    TEST_ASSERT_TRUE(at + sizeof(row) <= size);
+
+    image[at + offsetof(flux_fsm_compact_t, to)] ^= 1;
+    f = fopen(IMAGE_FILE, "wb");
+    fwrite(image, 1, size, f);
+    fclose(f);
+    TEST_ASSERT_NULL(flux_fsm_def_map(IMAGE_FILE, symbols, 3));
+    remove(IMAGE_FILE);
+}
+
+#define SNAPSHOT_FILE "test_fsm_snapshot.bin"
+#define SNAPSHOT_COUNT 10000
+
+void test_flux_fsm_snapshot(void) {
+    flux_fsm_transition_t ring[] = {
+        {0, 1, 1, NULL, NULL},
+        {1, 1, 2, NULL, NULL},
+        {2, 1, 0, NULL, NULL},
+    };
+    flux_fsm_transition_t pair[] = {
+        {0, 2, 1, NULL, NULL},
+        {1, 2, 0, NULL, NULL},
+    };
+
+    flux_fsm_def_t* a = flux_fsm_def_create();
+    flux_fsm_def_t* b = flux_fsm_def_create();
+    flux_fsm_def_add_transitions(a, ring, 3);
+    flux_fsm_def_add_transitions(b, pair, 2);
+
+    /* 未封存的定义没有哈希 */
+    TEST_ASSERT_EQUAL_UINT64(0, flux_fsm_def_hash(a));
+    flux_fsm_def_seal(a);
+    flux_fsm_def_seal(b);
+    TEST_ASSERT_NOT_EQUAL(0, flux_fsm_def_hash(a));
+    TEST_ASSERT_NOT_EQUAL(flux_fsm_def_hash(a), flux_fsm_def_hash(b));
+
+    /* 结构相同的定义哈希相同 */
+    flux_fsm_def_t* a2 = flux_fsm_def_create();
+    flux_fsm_def_add_transitions(a2, ring, 3);
+    flux_fsm_def_seal(a2);
+    TEST_ASSERT_EQUAL_UINT64(flux_fsm_def_hash(a), flux_fsm_def_hash(a2));
+
+    flux_fsm_inst_t* src = malloc(SNAPSHOT_COUNT * sizeof(flux_fsm_inst_t));
+    flux_fsm_inst_t* dst = malloc(SNAPSHOT_COUNT * sizeof(flux_fsm_inst_t));
+    uint64_t* ids = malloc(SNAPSHOT_COUNT * sizeof(uint64_t));
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    TEST_ASSERT_NOT_NULL(ids);
+
+    for (size_t i = 0; i < SNAPSHOT_COUNT; i++) {
+        int odd = (i / 3) % 2;
+        flux_fsm_inst_init(&src[i], odd ? b : a, 0, NULL);
+        flux_fsm_inst_init(&dst[i], odd ? b : a2, 0, NULL);
+        for (size_t k = 0; k < i % 5; k++) {
+            flux_fsm_inst_process_event(&src[i], odd ? 2 : 1);
+        }
+        ids[i] = 1000 + i * 17;
+    }
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_snapshot_save(SNAPSHOT_FILE, src, SNAPSHOT_COUNT, ids));
+
+    /* 实例数量不一致 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE,
+                          flux_fsm_snapshot_restore(SNAPSHOT_FILE, dst, SNAPSHOT_COUNT - 1, ids));
+
+    /* 实例标识不一致 */
+    ids[4321]++;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE,
+                          flux_fsm_snapshot_restore(SNAPSHOT_FILE, dst, SNAPSHOT_COUNT, ids));
+    ids[4321]--;
+
+    /* 定义哈希不一致，失败时实例保持不变 */
+    flux_fsm_def_t* saved = dst[SNAPSHOT_COUNT - 1].def;
+    dst[SNAPSHOT_COUNT - 1].def = saved == b ? a : b;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE,
+                          flux_fsm_snapshot_restore(SNAPSHOT_FILE, dst, SNAPSHOT_COUNT, ids));
+    dst[SNAPSHOT_COUNT - 1].def = saved;
+    for (size_t i = 0; i < SNAPSHOT_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT(0, dst[i].current_state);
+    }
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_snapshot_restore(SNAPSHOT_FILE, dst, SNAPSHOT_COUNT, ids));
+    for (size_t i = 0; i < SNAPSHOT_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT(src[i].current_state, dst[i].current_state);
+    }
+    remove(SNAPSHOT_FILE);
+
+    /* 不带标识的内存缓冲区 */
+    size_t size = flux_fsm_snapshot_size(src, 64, NULL);
+    TEST_ASSERT_TRUE(size > 0 && size < flux_fsm_snapshot_size(src, 64, ids));
+
+    uint64_t buf[128];
+    TEST_ASSERT_TRUE(size <= sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_snapshot_encode(buf, size - 1, src, 64, NULL));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_snapshot_encode(buf, size, src, 64, NULL));
+
+    /* 快照中没有标识时无法按标识核对 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE, flux_fsm_snapshot_decode(buf, size, dst, 64, ids));
+
+    for (size_t i = 0; i < 64; i++) {
+        flux_fsm_inst_process_event(&src[i], 1);
+    }
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_snapshot_decode(buf, size, src, 64, NULL));
+    for (size_t i = 0; i < 64; i++) {
+        TEST_ASSERT_EQUAL_INT(dst[i].current_state, src[i].current_state);
+    }
+
+    /* 格式不符 */
+    memset(buf, 0, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_snapshot_decode(buf, size, dst, 64, NULL));
+
+    for (size_t i = 0; i < SNAPSHOT_COUNT; i++) {
+        flux_fsm_inst_fini(&src[i]);
+        flux_fsm_inst_fini(&dst[i]);
+    }
+    free(src);
+    free(dst);
+    free(ids);
+    flux_fsm_def_release(a);
+    flux_fsm_def_release(a2);
+    flux_fsm_def_release(b);
+}
+
+#define LOG_FILE "test_fsm_async.log"
+#define LOG_THREADS 4
+#define LOG_MESSAGES 20000
+
+static flux_fsm_log_t* async_log;
+
+static void* log_writer(void* arg) {
+    int id = (int)(size_t)arg;
+    for (int i = 0; i < LOG_MESSAGES; i++) {
+        flux_fsm_log_info(async_log, "t%d %d", id, i);
+        flux_fsm_log_debug(async_log, "filtered %d", i);
+    }
+    return NULL;
+}
+
+/* 统计日志行数，并校验每个线程内的记录保持顺序 */
+static int count_log_lines(int* next) {
+    FILE* f = fopen(LOG_FILE, "r");
+    TEST_ASSERT_NOT_NULL(f);
+
+    char line[256];
+    int lines = 0;
+    while (fgets(line, sizeof(line), f)) {
+        int id, seq;
+        const char* msg = strstr(line, "[INFO] ");
+        TEST_ASSERT_NOT_NULL(msg);
+        TEST_ASSERT_EQUAL_INT(2, sscanf(msg, "[INFO] t%d %d", &id, &seq));
+        TEST_ASSERT_TRUE(id >= 0 && id < LOG_THREADS);
+        TEST_ASSERT_TRUE(seq >= next[id]);
+        next[id] = seq + 1;
+        lines++;
+    }
+    fclose(f);
+    return lines;
+}
+
+void test_flux_fsm_log_async(void) {
+    pthread_t threads[LOG_THREADS];
+
+    /* 阻塞策略：不丢记录 */
+    remove(LOG_FILE);
+    async_log = flux_fsm_log_create_async(LOG_FILE, FLUX_FSM_LOG_INFO, FLUX_FSM_LOG_BLOCK);
+    TEST_ASSERT_NOT_NULL(async_log);
+
+    for (int i = 0; i < LOG_THREADS; i++) {
+        pthread_create(&threads[i], NULL, log_writer, (void*)(size_t)i);
+    }
+    for (int i = 0; i < LOG_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    flux_fsm_log_flush(async_log);
+    TEST_ASSERT_EQUAL_UINT64(0, flux_fsm_log_dropped(async_log));
+
+    int next[LOG_THREADS] = {0};
+    TEST_ASSERT_EQUAL_INT(LOG_THREADS * LOG_MESSAGES, count_log_lines(next));
+    for (int i = 0; i < LOG_THREADS; i++) {
+        TEST_ASSERT_EQUAL_INT(LOG_MESSAGES, next[i]);
+    }
+
+    /* 退出线程的环形缓冲区被复用 */
+    pthread_create(&threads[0], NULL, log_writer, (void*)(size_t)0);
+    pthread_join(threads[0], NULL);
+    flux_fsm_log_destroy(async_log);
+
+    /* 丢弃策略：写入行数与丢弃计数之和等于总数 */
+    remove(LOG_FILE);
+    async_log = flux_fsm_log_create_async(LOG_FILE, FLUX_FSM_LOG_INFO, FLUX_FSM_LOG_DROP);
+    TEST_ASSERT_NOT_NULL(async_log);
+
+    for (int i = 0; i < LOG_THREADS; i++) {
+        pthread_create(&threads[i], NULL, log_writer, (void*)(size_t)i);
+    }
+    for (int i = 0; i < LOG_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    uint64_t dropped = flux_fsm_log_dropped(async_log);
+    flux_fsm_log_destroy(async_log);
+
+    memset(next, 0, sizeof(next));
+    TEST_ASSERT_EQUAL_UINT64(LOG_THREADS * LOG_MESSAGES, count_log_lines(next) + dropped);
+    remove(LOG_FILE);
+}
+
+static int log_side_effects;
+
+static int log_arg(void) {
+    return ++log_side_effects;
+}
+
+void test_flux_fsm_log_level(void) {
+    flux_fsm_log_t* log = flux_fsm_log_create(LOG_FILE, FLUX_FSM_LOG_WARN);
+    TEST_ASSERT_NOT_NULL(log);
+
+    /* 低于运行时级别的调用不求值参数，也不调用 flux_fsm_log_write */
+    log_side_effects = 0;
+    flux_fsm_log_debug(log, "debug %d", log_arg());
+    flux_fsm_log_info(log, "info %d", log_arg());
+    TEST_ASSERT_EQUAL_INT(0, log_side_effects);
+
+    flux_fsm_log_error(log, "error %d", log_arg());
+    TEST_ASSERT_EQUAL_INT(1, log_side_effects);
+
+    /* NULL 日志同样被跳过 */
+    flux_fsm_log_t* none = NULL;
+    flux_fsm_log_error(none, "error %d", log_arg());
+    TEST_ASSERT_EQUAL_INT(1, log_side_effects);
+
+    flux_fsm_log_destroy(log);
+
+    FILE* f = fopen(LOG_FILE, "r");
+    TEST_ASSERT_NOT_NULL(f);
+    char line[256];
+    int lines = 0;
+    while (fgets(line, sizeof(line), f)) {
+        TEST_ASSERT_NOT_NULL(strstr(line, "[ERROR] error 1"));
+        lines++;
+    }
+    fclose(f);
+    TEST_ASSERT_EQUAL_INT(1, lines);
+    remove(LOG_FILE);
+}
+
+#define COUNTER_THREADS 4
+#define COUNTER_ROUNDS 10000
+
+static int counter_guard(void* context) {
+    (void)context;
+    return 0;
+}
+
+static void* counter_worker(void* arg) {
+    (void)arg;
+    flux_fsm_transition_t trans[] = {
+        {0, 1, 1, NULL, NULL},
+        {1, 1, 0, NULL, NULL},
+        {0, 2, 1, counter_guard, NULL},
+    };
+    flux_fsm_t* m = flux_fsm_create(0, NULL);
+    flux_fsm_add_transitions(m, trans, 3);
+
+    /* 每轮：一次守卫失败、两次成功转移、一次无匹配，结束时回到状态 0 */
+    for (int i = 0; i < COUNTER_ROUNDS; i++) {
+        flux_fsm_process_event(m, 2);
+        flux_fsm_process_event(m, 1);
+        flux_fsm_process_event(m, 9);
+        flux_fsm_process_event(m, 1);
+    }
+
+    flux_fsm_destroy(m);
+    return NULL;
+}
+
+void test_flux_fsm_counters(void) {
+    pthread_t threads[COUNTER_THREADS];
+    flux_fsm_counters_t c;
+
+    flux_fsm_counters_enable(1);
+    flux_fsm_counters_reset();
+
+    for (int i = 0; i < COUNTER_THREADS; i++) {
+        pthread_create(&threads[i], NULL, counter_worker, NULL);
+    }
+    for (int i = 0; i < COUNTER_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* 已退出线程的计数仍被合并 */
+    flux_fsm_counters_read(&c);
+    TEST_ASSERT_EQUAL_UINT64(COUNTER_THREADS * COUNTER_ROUNDS * 4, c.events);
+    TEST_ASSERT_EQUAL_UINT64(COUNTER_THREADS * COUNTER_ROUNDS * 2, c.transitions);
+    TEST_ASSERT_EQUAL_UINT64(COUNTER_THREADS * COUNTER_ROUNDS, c.guard_failures);
+    TEST_ASSERT_EQUAL_UINT64(COUNTER_THREADS * COUNTER_ROUNDS, c.invalid_events);
+    TEST_ASSERT_TRUE(c.total_ns > 0 && c.max_ns <= c.total_ns);
+
+    /* 当前线程、exec_transition 与实例路径 */
+    flux_fsm_counters_reset();
+    flux_fsm_add_transition(fsm, &(flux_fsm_transition_t){STATE_INIT, EVENT_START, STATE_WORK, NULL, NULL});
+    flux_fsm_process_event(fsm, EVENT_START);
+    flux_fsm_exec_transition(fsm, 0);
+
+    flux_fsm_def_t* def = flux_fsm_def_create();
+    flux_fsm_def_add_transition(def, &(flux_fsm_transition_t){0, 1, 1, NULL, NULL});
+    flux_fsm_def_seal(def);
+    flux_fsm_inst_t inst;
+    flux_fsm_inst_init(&inst, def, 0, NULL);
+    flux_fsm_inst_process_event(&inst, 1);
+    flux_fsm_inst_process_event(&inst, 1);
+    flux_fsm_inst_fini(&inst);
+    flux_fsm_def_release(def);
+
+    flux_fsm_counters_read(&c);
+    TEST_ASSERT_EQUAL_UINT64(4, c.events);
+    TEST_ASSERT_EQUAL_UINT64(3, c.transitions);
+    TEST_ASSERT_EQUAL_UINT64(1, c.invalid_events);
+
+    /* 关闭后不再计数 */
+    flux_fsm_counters_enable(0);
+    flux_fsm_process_event(fsm, EVENT_START);
+    flux_fsm_counters_read(&c);
+    TEST_ASSERT_EQUAL_UINT64(4, c.events);
+    TEST_ASSERT_FALSE(flux_fsm_counters_enabled());
+
+    flux_fsm_counters_reset();
+    flux_fsm_counters_read(&c);
+    TEST_ASSERT_EQUAL_UINT64(0, c.events);
+}
+
+void test_flux_fsm_profile(void) {
+    flux_fsm_transition_t trans[] = {
+        {STATE_INIT, EVENT_START, STATE_WORK, NULL, NULL},
+        {STATE_WORK, EVENT_STOP, STATE_INIT, NULL, NULL},
+    };
+    struct timespec pause = {0, 200000};
+
+    flux_fsm_add_transitions(fsm, trans, 2);
+    TEST_ASSERT_EQUAL_UINT64(0, flux_fsm_profile_hits(fsm, 0));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_profile_enable(fsm));
+
+    /* 每轮在 STATE_WORK 停留至少 200us */
+    for (int i = 0; i < 10; i++) {
+        flux_fsm_process_event(fsm, EVENT_START);
+        nanosleep(&pause, NULL);
+        flux_fsm_process_event(fsm, EVENT_STOP);
+        flux_fsm_process_event(fsm, EVENT_STOP);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(10, flux_fsm_profile_hits(fsm, 0));
+    TEST_ASSERT_EQUAL_UINT64(10, flux_fsm_profile_hits(fsm, 1));
+    TEST_ASSERT_TRUE(flux_fsm_profile_dwell_ns(fsm, STATE_WORK) >= 2000000);
+    TEST_ASSERT_TRUE(flux_fsm_profile_dwell_ns(fsm, STATE_WORK) > flux_fsm_profile_dwell_ns(fsm, STATE_INIT));
+
+    flux_fsm_exec_transition(fsm, 0);
+    TEST_ASSERT_EQUAL_UINT64(11, flux_fsm_profile_hits(fsm, 0));
+
+    /* 启用后新增的转移与状态 */
+    flux_fsm_add_transition(fsm, &(flux_fsm_transition_t){STATE_WORK, 2, STATE_DONE, NULL, NULL});
+    flux_fsm_process_event(fsm, 2);
+    TEST_ASSERT_EQUAL_UINT64(1, flux_fsm_profile_hits(fsm, 2));
+    TEST_ASSERT_EQUAL_UINT64(0, flux_fsm_profile_hits(fsm, 3));
+    nanosleep(&pause, NULL);
+    TEST_ASSERT_TRUE(flux_fsm_profile_dwell_ns(fsm, STATE_DONE) >= 200000);
+
+    flux_fsm_profile_reset(fsm);
+    TEST_ASSERT_EQUAL_UINT64(0, flux_fsm_profile_hits(fsm, 0));
+    TEST_ASSERT_TRUE(flux_fsm_profile_dwell_ns(fsm, STATE_WORK) == 0);
+
+    /* 转移之外的状态变更：原状态的停留结算，新状态从此刻计时 */
+    nanosleep(&pause, NULL);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_set_state(fsm, STATE_INIT));
+    uint64_t done_ns = flux_fsm_profile_dwell_ns(fsm, STATE_DONE);
+    TEST_ASSERT_TRUE(done_ns >= 200000);
+    nanosleep(&pause, NULL);
+    flux_fsm_process_event(fsm, EVENT_START);
+    TEST_ASSERT_EQUAL_INT(STATE_WORK, flux_fsm_get_state(fsm));
+    TEST_ASSERT_EQUAL_UINT64(done_ns, flux_fsm_profile_dwell_ns(fsm, STATE_DONE));
+    TEST_ASSERT_TRUE(flux_fsm_profile_dwell_ns(fsm, STATE_INIT) >= 200000);
+
+    flux_fsm_profile_disable(fsm);
+    TEST_ASSERT_NULL(fsm->profile);
+    TEST_ASSERT_EQUAL_UINT64(0, flux_fsm_profile_dwell_ns(fsm, STATE_DONE));
+}
+
 int main(void) {
     UNITY_BEGIN();
     
@@ -126,6 +1206,23 @@ int main(void) {
     RUN_TEST(test_flux_fsm_guard_fail);
     RUN_TEST(test_flux_fsm_invalid_event);
     RUN_TEST(test_flux_fsm_handler);
+    RUN_TEST(test_flux_fsm_seal);
+    RUN_TEST(test_flux_fsm_def_shared);
+    RUN_TEST(test_flux_fsm_pool);
+    RUN_TEST(test_flux_fsm_bulk_load);
+    RUN_TEST(test_flux_fsm_process_events);
+    RUN_TEST(test_flux_fsm_queue);
+    RUN_TEST(test_flux_fsm_ts);
+    RUN_TEST(test_flux_fsm_compact);
+    RUN_TEST(test_flux_fsm_scan);
+    RUN_TEST(test_flux_fsm_event_filter);
+    RUN_TEST(test_flux_fsm_cache);
+    RUN_TEST(test_flux_fsm_image);
+    RUN_TEST(test_flux_fsm_snapshot);
+    RUN_TEST(test_flux_fsm_log_async);
+    RUN_TEST(test_flux_fsm_log_level);
+    RUN_TEST(test_flux_fsm_counters);
+    RUN_TEST(test_flux_fsm_profile);
     
     return UNITY_END();
 }
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+/*
+ * 裸机构建（FLUX_FSM_BARE_METAL）下的内存池：所有块与大块分配来自
+ * FLUX_FSM_STATIC_POOL_SIZE 的静态缓冲区，反复重置与乱序销毁不得耗尽空间
+ */
+
+#include <unity.h>
+#include "../../include/flux_fsm_core.h"
+
+#define CYCLES  (FLUX_FSM_STATIC_POOL_SIZE / FLUX_FSM_POOL_SIZE * 4)
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_flux_fsm_static_pool_reset(void) {
+    /* 重置归还的大块位于池的附加块之下 */
+    for (int i = 0; i < CYCLES; i++) {
+        flux_fsm_pool_t* pool = flux_fsm_pool_create(0);
+        TEST_ASSERT_NOT_NULL(pool);
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(pool, FLUX_FSM_POOL_SIZE * 2));
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(pool, FLUX_FSM_POOL_SIZE / 2));
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(pool, FLUX_FSM_POOL_SIZE / 2));
+        TEST_ASSERT_NOT_NULL(flux_fsm_create_from_pool(pool, 0, NULL));
+        flux_fsm_pool_reset(pool);
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(pool, FLUX_FSM_POOL_SIZE * 2));
+        flux_fsm_pool_destroy(pool);
+    }
+}
+
+void test_flux_fsm_static_pool_destroy_order(void) {
+    /* 先创建的池先销毁，空间不在栈顶 */
+    for (int i = 0; i < CYCLES; i++) {
+        flux_fsm_pool_t* a = flux_fsm_pool_create(0);
+        flux_fsm_pool_t* b = flux_fsm_pool_create(0);
+        TEST_ASSERT_NOT_NULL(a);
+        TEST_ASSERT_NOT_NULL(b);
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(a, FLUX_FSM_POOL_SIZE * 2));
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(b, FLUX_FSM_POOL_SIZE - 64));
+        TEST_ASSERT_NOT_NULL(flux_fsm_palloc(a, FLUX_FSM_POOL_SIZE - 64));
+        flux_fsm_pool_destroy(a);
+        flux_fsm_pool_destroy(b);
+    }
+
+    /* 释放的空间已合并，接近整个缓冲区的分配仍然成功 */
+    flux_fsm_pool_t* pool = flux_fsm_pool_create(0);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_NOT_NULL(flux_fsm_palloc(pool, FLUX_FSM_STATIC_POOL_SIZE - FLUX_FSM_POOL_SIZE * 2));
+    TEST_ASSERT_NULL(flux_fsm_palloc(pool, FLUX_FSM_POOL_SIZE * 2));
+    flux_fsm_pool_destroy(pool);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_flux_fsm_static_pool_reset);
+    RUN_TEST(test_flux_fsm_static_pool_destroy_order);
+
+    return UNITY_END();
+}
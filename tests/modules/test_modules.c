@@ -0,0 +1,437 @@
+/*
+ * Copyright (C) 2024 FluxState. All rights reserved.
+ */
+
+#include <unity.h>
+#include <pthread.h>
+#include <sched.h>
+#include "../../include/flux_fsm_core.h"
+#include "../../include/flux_fsm_executor.h"
+#include "../../include/flux_fsm_hierarchical.h"
+#include "../../include/flux_fsm_parallel.h"
+
+#define EXEC_MACHINES    64
+#define EXEC_PRODUCERS   4
+#define EXEC_PER_THREAD  500
+
+/* 每台状态机的上下文：记录每个生产者最后看到的序号 */
+typedef struct {
+    int last_seq[EXEC_PRODUCERS];
+    int seen;
+    int order_ok;
+} exec_context_t;
+
+static flux_fsm_t* machines[EXEC_MACHINES];
+static exec_context_t contexts[EXEC_MACHINES];
+static flux_fsm_executor_t* executor;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/* 事件编码为 producer * EXEC_PER_THREAD + seq */
+static void exec_handler(void* context, int event) {
+    exec_context_t* ctx = context;
+    int producer = event / EXEC_PER_THREAD;
+    int seq = event % EXEC_PER_THREAD;
+    if (seq != ctx->last_seq[producer] + 1) {
+        ctx->order_ok = 0;
+    }
+    ctx->last_seq[producer] = seq;
+    ctx->seen++;
+}
+
+static void* exec_producer(void* arg) {
+    int producer = (int)(size_t)arg;
+    for (int seq = 0; seq < EXEC_PER_THREAD; seq++) {
+        for (int m = 0; m < EXEC_MACHINES; m++) {
+            while (flux_fsm_executor_post(executor, machines[m],
+                       producer * EXEC_PER_THREAD + seq) != FLUX_FSM_OK) {
+                sched_yield();
+            }
+        }
+    }
+    return NULL;
+}
+
+void test_flux_fsm_executor(void) {
+    executor = flux_fsm_executor_create(4, 16);
+    TEST_ASSERT_NOT_NULL(executor);
+    TEST_ASSERT_EQUAL_INT(4, flux_fsm_executor_workers(executor));
+
+    for (int m = 0; m < EXEC_MACHINES; m++) {
+        machines[m] = flux_fsm_create(0, &contexts[m]);
+        TEST_ASSERT_NOT_NULL(machines[m]);
+        for (int e = 0; e < EXEC_PRODUCERS * EXEC_PER_THREAD; e++) {
+            flux_fsm_transition_t loop = { 0, e, 0, NULL, NULL };
+            TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_transition(machines[m], &loop));
+        }
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_add_handler(machines[m], 0, exec_handler));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_seal(machines[m]));
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_queue_init(machines[m], 64));
+
+        for (int p = 0; p < EXEC_PRODUCERS; p++) {
+            contexts[m].last_seq[p] = -1;
+        }
+        contexts[m].seen = 0;
+        contexts[m].order_ok = 1;
+    }
+
+    /* 未创建队列的状态机不能投递 */
+    flux_fsm_t* bare = flux_fsm_create(0, NULL);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_EVENT, flux_fsm_executor_post(executor, bare, 0));
+    flux_fsm_destroy(bare);
+
+    pthread_t threads[EXEC_PRODUCERS];
+    for (int p = 0; p < EXEC_PRODUCERS; p++) {
+        pthread_create(&threads[p], NULL, exec_producer, (void*)(size_t)p);
+    }
+    for (int p = 0; p < EXEC_PRODUCERS; p++) {
+        pthread_join(threads[p], NULL);
+    }
+
+    flux_fsm_executor_wait_idle(executor);
+
+    for (int m = 0; m < EXEC_MACHINES; m++) {
+        TEST_ASSERT_EQUAL_INT(EXEC_PRODUCERS * EXEC_PER_THREAD, contexts[m].seen);
+        TEST_ASSERT_TRUE(contexts[m].order_ok);
+        TEST_ASSERT_EQUAL_INT(0, flux_fsm_pending(machines[m]));
+    }
+
+    /* 空闲后再次投递仍会被调度 */
+    contexts[0].seen = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_executor_post(executor, machines[0], 0));
+    flux_fsm_executor_wait_idle(executor);
+    TEST_ASSERT_EQUAL_INT(1, contexts[0].seen);
+
+    flux_fsm_executor_destroy(executor);
+    for (int m = 0; m < EXEC_MACHINES; m++) {
+        flux_fsm_destroy(machines[m]);
+    }
+}
+
+/* 层次状态机：OP{IDLE, RUN{SLOW, FAST}}, ERR */
+enum { HSM_OP, HSM_IDLE, HSM_RUN, HSM_SLOW, HSM_FAST, HSM_ERR };
+enum { HSM_GO, HSM_UP, HSM_STOP, HSM_FAIL, HSM_RESET, HSM_RESTART, HSM_X, HSM_Y };
+
+/* 进入记为大写字母，退出记为小写字母 */
+static char hsm_trace[64];
+static size_t hsm_trace_len;
+static int hsm_allow;
+
+static void hsm_entry(void* ctx, int state) {
+    (void)ctx;
+    hsm_trace[hsm_trace_len++] = (char)('A' + state);
+    hsm_trace[hsm_trace_len] = '\0';
+}
+
+static void hsm_exit(void* ctx, int state) {
+    (void)ctx;
+    hsm_trace[hsm_trace_len++] = (char)('a' + state);
+    hsm_trace[hsm_trace_len] = '\0';
+}
+
+static int hsm_guard(void* ctx) {
+    (void)ctx;
+    return hsm_allow;
+}
+
+static void hsm_trace_reset(void) {
+    hsm_trace_len = 0;
+    hsm_trace[0] = '\0';
+}
+
+static flux_fsm_hsm_t* hsm_sample(void) {
+    flux_fsm_hsm_t* hsm = flux_fsm_hsm_create(HSM_OP, NULL);
+    TEST_ASSERT_NOT_NULL(hsm);
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_state(hsm, HSM_OP, FLUX_FSM_HSM_ROOT));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_state(hsm, HSM_IDLE, HSM_OP));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_state(hsm, HSM_RUN, HSM_OP));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_state(hsm, HSM_SLOW, HSM_RUN));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_state(hsm, HSM_FAST, HSM_RUN));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_state(hsm, HSM_ERR, FLUX_FSM_HSM_ROOT));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_set_initial(hsm, HSM_OP, HSM_IDLE));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_set_initial(hsm, HSM_RUN, HSM_SLOW));
+
+    for (int s = HSM_OP; s <= HSM_ERR; s++) {
+        flux_fsm_hsm_set_entry(hsm, s, hsm_entry);
+        flux_fsm_hsm_set_exit(hsm, s, hsm_exit);
+    }
+
+    flux_fsm_transition_t trans[] = {
+        {HSM_OP, HSM_FAIL, HSM_ERR, NULL, NULL},
+        {HSM_IDLE, HSM_GO, HSM_RUN, NULL, NULL},
+        {HSM_SLOW, HSM_UP, HSM_FAST, NULL, NULL},
+        {HSM_RUN, HSM_STOP, HSM_IDLE, NULL, NULL},
+        {HSM_RUN, HSM_RESTART, HSM_RUN, NULL, NULL},
+        {HSM_ERR, HSM_RESET, HSM_OP, NULL, NULL},
+        /* 内层守卫失败时交给外层 */
+        {HSM_SLOW, HSM_X, HSM_FAST, hsm_guard, NULL},
+        {HSM_RUN, HSM_X, HSM_IDLE, NULL, NULL},
+        {HSM_IDLE, HSM_Y, HSM_RUN, hsm_guard, NULL},
+    };
+    for (size_t i = 0; i < sizeof(trans) / sizeof(trans[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_add_transition(hsm, &trans[i]));
+    }
+
+    return hsm;
+}
+
+void test_flux_fsm_hsm(void) {
+    flux_fsm_hsm_t* hsm = hsm_sample();
+
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_hsm_process_event(hsm, HSM_GO));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_start(hsm));
+    TEST_ASSERT_EQUAL_STRING("AB", hsm_trace);
+    TEST_ASSERT_EQUAL_INT(HSM_IDLE, flux_fsm_hsm_get_state(hsm));
+
+    /* 启动后定义冻结 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_hsm_add_state(hsm, 9, HSM_OP));
+
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_GO));
+    TEST_ASSERT_EQUAL_STRING("bCD", hsm_trace);
+    TEST_ASSERT_EQUAL_INT(HSM_SLOW, flux_fsm_hsm_get_state(hsm));
+    TEST_ASSERT_TRUE(flux_fsm_hsm_in_state(hsm, HSM_RUN));
+    TEST_ASSERT_TRUE(flux_fsm_hsm_in_state(hsm, HSM_OP));
+    TEST_ASSERT_FALSE(flux_fsm_hsm_in_state(hsm, HSM_IDLE));
+
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_UP));
+    TEST_ASSERT_EQUAL_STRING("dE", hsm_trace);
+
+    /* 自转移按外部转移处理：退出并重新进入 RUN */
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_RESTART));
+    TEST_ASSERT_EQUAL_STRING("ecCD", hsm_trace);
+    TEST_ASSERT_EQUAL_INT(HSM_SLOW, flux_fsm_hsm_get_state(hsm));
+
+    /* STOP 定义在 RUN 上，由叶状态冒泡 */
+    flux_fsm_hsm_process_event(hsm, HSM_UP);
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_STOP));
+    TEST_ASSERT_EQUAL_STRING("ecB", hsm_trace);
+    TEST_ASSERT_EQUAL_INT(HSM_IDLE, flux_fsm_hsm_get_state(hsm));
+
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_FAIL));
+    TEST_ASSERT_EQUAL_STRING("baF", hsm_trace);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_hsm_process_event(hsm, HSM_GO));
+
+    hsm_trace_reset();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_RESET));
+    TEST_ASSERT_EQUAL_STRING("fAB", hsm_trace);
+    TEST_ASSERT_EQUAL_INT(HSM_IDLE, flux_fsm_hsm_get_state(hsm));
+
+    flux_fsm_hsm_destroy(hsm);
+}
+
+void test_flux_fsm_hsm_guard(void) {
+    flux_fsm_hsm_t* hsm = hsm_sample();
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_start(hsm));
+
+    hsm_allow = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_GUARD_FAIL, flux_fsm_hsm_process_event(hsm, HSM_Y));
+    TEST_ASSERT_EQUAL_INT(HSM_IDLE, flux_fsm_hsm_get_state(hsm));
+
+    hsm_allow = 1;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_Y));
+    TEST_ASSERT_EQUAL_INT(HSM_SLOW, flux_fsm_hsm_get_state(hsm));
+
+    /* SLOW 上的守卫通过时优先于外层 RUN 的转移 */
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_X));
+    TEST_ASSERT_EQUAL_INT(HSM_FAST, flux_fsm_hsm_get_state(hsm));
+
+    flux_fsm_hsm_process_event(hsm, HSM_RESTART);
+    hsm_allow = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, HSM_X));
+    TEST_ASSERT_EQUAL_INT(HSM_IDLE, flux_fsm_hsm_get_state(hsm));
+
+    flux_fsm_hsm_destroy(hsm);
+
+    /* 目标复合状态缺少初始子状态 */
+    hsm = flux_fsm_hsm_create(0, NULL);
+    flux_fsm_hsm_add_state(hsm, 0, FLUX_FSM_HSM_ROOT);
+    flux_fsm_hsm_add_state(hsm, 1, FLUX_FSM_HSM_ROOT);
+    flux_fsm_hsm_add_state(hsm, 2, 1);
+    flux_fsm_transition_t t = {0, 0, 1, NULL, NULL};
+    flux_fsm_hsm_add_transition(hsm, &t);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE, flux_fsm_hsm_build(hsm));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_set_initial(hsm, 1, 2));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_build(hsm));
+
+    /* 父链成环 */
+    flux_fsm_hsm_add_state(hsm, 1, 2);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_INVALID_STATE, flux_fsm_hsm_build(hsm));
+    flux_fsm_hsm_destroy(hsm);
+}
+
+#define HSM_DEPTH  12
+
+static int hsm_entries;
+static int hsm_exits;
+
+static void hsm_count_entry(void* ctx, int state) {
+    (void)ctx;
+    (void)state;
+    hsm_entries++;
+}
+
+static void hsm_count_exit(void* ctx, int state) {
+    (void)ctx;
+    (void)state;
+    hsm_exits++;
+}
+
+void test_flux_fsm_hsm_deep(void) {
+    /* 0 ⊃ 1 ⊃ ... ⊃ HSM_DEPTH，另有顶层叶状态 HSM_DEPTH + 1 */
+    int out = HSM_DEPTH + 1;
+    flux_fsm_hsm_t* hsm = flux_fsm_hsm_create(0, NULL);
+
+    for (int s = 0; s <= HSM_DEPTH; s++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK,
+            flux_fsm_hsm_add_state(hsm, s, s ? s - 1 : FLUX_FSM_HSM_ROOT));
+        flux_fsm_hsm_set_entry(hsm, s, hsm_count_entry);
+        flux_fsm_hsm_set_exit(hsm, s, hsm_count_exit);
+    }
+    for (int s = 0; s < HSM_DEPTH; s++) {
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_set_initial(hsm, s, s + 1));
+    }
+    flux_fsm_hsm_add_state(hsm, out, FLUX_FSM_HSM_ROOT);
+    flux_fsm_hsm_set_entry(hsm, out, hsm_count_entry);
+    flux_fsm_hsm_set_exit(hsm, out, hsm_count_exit);
+
+    flux_fsm_transition_t leave = {0, 1, out, NULL, NULL};
+    flux_fsm_transition_t back = {out, 2, 0, NULL, NULL};
+    flux_fsm_hsm_add_transition(hsm, &leave);
+    flux_fsm_hsm_add_transition(hsm, &back);
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_start(hsm));
+    TEST_ASSERT_EQUAL_INT(HSM_DEPTH, flux_fsm_hsm_get_state(hsm));
+    TEST_ASSERT_EQUAL_INT(HSM_DEPTH + 1, hsm_entries);
+
+    /* 展开后每个叶状态一行，分派只需一次查找 */
+    const flux_fsm_t* table = flux_fsm_hsm_table(hsm);
+    TEST_ASSERT_EQUAL_size_t(2, table->transition_count);
+    TEST_ASSERT_TRUE(table->sealed);
+
+    for (int round = 0; round < 3; round++) {
+        hsm_entries = 0;
+        hsm_exits = 0;
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, 1));
+        TEST_ASSERT_EQUAL_INT(out, flux_fsm_hsm_get_state(hsm));
+        TEST_ASSERT_EQUAL_INT(HSM_DEPTH + 1, hsm_exits);
+        TEST_ASSERT_EQUAL_INT(1, hsm_entries);
+
+        TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_hsm_process_event(hsm, 2));
+        TEST_ASSERT_EQUAL_INT(HSM_DEPTH, flux_fsm_hsm_get_state(hsm));
+        TEST_ASSERT_EQUAL_INT(HSM_DEPTH + 2, hsm_exits);
+        TEST_ASSERT_EQUAL_INT(HSM_DEPTH + 2, hsm_entries);
+        TEST_ASSERT_TRUE(flux_fsm_hsm_in_state(hsm, 0));
+    }
+
+    flux_fsm_hsm_destroy(hsm);
+}
+
+#define PAR_REGIONS  24
+#define PAR_ARM      100
+#define PAR_RESET    200
+
+/* 只保留序号最大的候选区域 */
+static size_t par_highest(void* data, flux_fsm_event_t event, size_t* regions, size_t n) {
+    (void)event;
+    (*(int*)data)++;
+    regions[0] = regions[n - 1];
+    return 1;
+}
+
+void test_flux_fsm_parallel(void) {
+    flux_fsm_t* regions[PAR_REGIONS];
+
+    /* 偶数区域响应 ARM，所有区域在状态 1 时响应 RESET */
+    for (int r = 0; r < PAR_REGIONS; r++) {
+        regions[r] = flux_fsm_create(0, NULL);
+        TEST_ASSERT_NOT_NULL(regions[r]);
+        if (r % 2 == 0) {
+            flux_fsm_transition_t arm = {0, PAR_ARM, 1, NULL, NULL};
+            flux_fsm_add_transition(regions[r], &arm);
+        }
+        flux_fsm_transition_t reset = {1, PAR_RESET, 0, NULL, NULL};
+        flux_fsm_add_transition(regions[r], &reset);
+        flux_fsm_seal(regions[r]);
+        flux_fsm_cache_enable(regions[r], 0);
+    }
+
+    flux_fsm_parallel_t* par = flux_fsm_parallel_create(regions, PAR_REGIONS);
+    TEST_ASSERT_NOT_NULL(par);
+    TEST_ASSERT_EQUAL_size_t(PAR_REGIONS, flux_fsm_parallel_count(par));
+    TEST_ASSERT_TRUE(flux_fsm_parallel_region(par, 3) == regions[3]);
+
+    size_t fired = 0;
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_parallel_process_event(par, PAR_ARM, &fired));
+    TEST_ASSERT_EQUAL_size_t(PAR_REGIONS / 2, fired);
+
+    /* 不响应 ARM 的区域未被查找 */
+    for (int r = 0; r < PAR_REGIONS; r++) {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        flux_fsm_cache_stats(regions[r], &hits, &misses);
+        TEST_ASSERT_EQUAL_INT(r % 2 == 0 ? 1 : 0, flux_fsm_get_state(regions[r]));
+        TEST_ASSERT_EQUAL_UINT64(r % 2 == 0 ? 1 : 0, misses);
+    }
+
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_ERROR, flux_fsm_parallel_process_event(par, 12345, &fired));
+    TEST_ASSERT_EQUAL_size_t(0, fired);
+
+    /* 冲突解决器只放行一个区域 */
+    int calls = 0;
+    flux_fsm_parallel_set_resolver(par, par_highest, &calls);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_parallel_process_event(par, PAR_RESET, &fired));
+    TEST_ASSERT_EQUAL_size_t(1, fired);
+    TEST_ASSERT_EQUAL_INT(1, calls);
+    TEST_ASSERT_EQUAL_INT(0, flux_fsm_get_state(regions[PAR_REGIONS - 2]));
+    TEST_ASSERT_EQUAL_INT(1, flux_fsm_get_state(regions[0]));
+
+    /* 新增转移后按版本号自动重建索引 */
+    uint32_t generation = flux_fsm_generation();
+    flux_fsm_transition_t late = {0, 300, 1, NULL, NULL};
+    flux_fsm_add_transition(regions[1], &late);
+    TEST_ASSERT_TRUE(flux_fsm_generation() != generation);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_parallel_process_event(par, 300, NULL));
+    TEST_ASSERT_EQUAL_INT(1, flux_fsm_get_state(regions[1]));
+
+    /* 显式重建后行为不变 */
+    flux_fsm_transition_t later = {1, 301, 0, NULL, NULL};
+    flux_fsm_add_transition(regions[1], &later);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_parallel_rebuild(par));
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_parallel_process_event(par, 301, NULL));
+    TEST_ASSERT_EQUAL_INT(0, flux_fsm_get_state(regions[1]));
+
+    /* 无关状态机添加转移只改变代数，索引照常可用 */
+    flux_fsm_t* other = flux_fsm_create(0, NULL);
+    flux_fsm_add_transition(other, &late);
+    TEST_ASSERT_EQUAL_INT(FLUX_FSM_OK, flux_fsm_parallel_process_event(par, 300, NULL));
+    TEST_ASSERT_EQUAL_INT(1, flux_fsm_get_state(regions[1]));
+    flux_fsm_destroy(other);
+
+    flux_fsm_parallel_destroy(par);
+    for (int r = 0; r < PAR_REGIONS; r++) {
+        flux_fsm_destroy(regions[r]);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_flux_fsm_executor);
+    RUN_TEST(test_flux_fsm_hsm);
+    RUN_TEST(test_flux_fsm_hsm_guard);
+    RUN_TEST(test_flux_fsm_hsm_deep);
+    RUN_TEST(test_flux_fsm_parallel);
+
+    return UNITY_END();
+}
@@ -8,6 +8,16 @@
 #include <time.h>
 #include "flux_fsm_perf.h"
 #include "flux_fsm_viz.h"
+#include "flux_fsm_codegen.h"
+#include "flux_fsm_trace.h"
+
+#if defined(FLUX_FSM_HAVE_TRACE)
+#include <unistd.h>
+#endif
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+#include <pthread.h>
+#endif
 
 /* 测试状态定义 */
 #define STATE_IDLE      0
@@ -49,6 +59,385 @@ void test_perf_stats(void) {
     flux_fsm_perf_reset(&perf);
 }
 
+/* 相对误差不超过直方图精度（1/32） */
+static int hist_close(uint64_t got, uint64_t want) {
+    uint64_t diff = got > want ? got - want : want - got;
+    return diff * 32 <= want;
+}
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+static void* hist_worker(void* arg) {
+    for (uint64_t i = 0; i < 100000; i++) {
+        flux_fsm_hist_record(arg, i % 1000);
+    }
+    return NULL;
+}
+#endif
+
+/* 测试用例：延迟直方图 */
+void test_perf_histogram(void) {
+    static flux_fsm_hist_t hist;
+    static flux_fsm_hist_snapshot_t snap, merged;
+
+    flux_fsm_hist_init(&hist);
+    for (uint64_t v = 1; v <= 100000; v++) {
+        flux_fsm_hist_record(&hist, v);
+    }
+    flux_fsm_hist_snapshot(&hist, &snap);
+
+    printf("p50=%llu p99=%llu p99.9=%llu max=%llu\n",
+           (unsigned long long)flux_fsm_hist_percentile(&snap, 50.0),
+           (unsigned long long)flux_fsm_hist_percentile(&snap, 99.0),
+           (unsigned long long)flux_fsm_hist_percentile(&snap, 99.9),
+           (unsigned long long)snap.max);
+    printf("百分位数测试: %s\n",
+           snap.count == 100000
+           && hist_close(flux_fsm_hist_percentile(&snap, 50.0), 50000)
+           && hist_close(flux_fsm_hist_percentile(&snap, 99.0), 99000)
+           && hist_close(flux_fsm_hist_percentile(&snap, 99.9), 99900)
+           && flux_fsm_hist_percentile(&snap, 100.0) == 100000
+           && flux_fsm_hist_percentile(&snap, 0.0) == 1 ? "通过" : "失败");
+
+    /* 小于 64 的取值精确计数 */
+    flux_fsm_hist_init(&hist);
+    for (uint64_t v = 0; v < 64; v++) {
+        flux_fsm_hist_record(&hist, v);
+    }
+    flux_fsm_hist_record(&hist, (uint64_t)1 << 40);
+    flux_fsm_hist_snapshot(&hist, &snap);
+    printf("精确区间测试: %s\n",
+           flux_fsm_hist_percentile(&snap, 50.0) == 32
+           && flux_fsm_hist_percentile(&snap, 100.0) == (uint64_t)1 << 40 ? "通过" : "失败");
+
+    /* 快照合并 */
+    memset(&merged, 0, sizeof(merged));
+    flux_fsm_hist_merge(&merged, &snap);
+    flux_fsm_hist_merge(&merged, &snap);
+    printf("快照合并测试: %s\n",
+           merged.count == 130 && merged.sum == 2 * snap.sum
+           && flux_fsm_hist_percentile(&merged, 50.0) == 32 ? "通过" : "失败");
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+    /* 多线程并发记录不丢失 */
+    pthread_t threads[4];
+
+    flux_fsm_hist_init(&hist);
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, hist_worker, &hist);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    flux_fsm_hist_snapshot(&hist, &snap);
+    printf("并发记录测试: %s\n",
+           snap.count == 400000 && snap.max == 999 ? "通过" : "失败");
+#endif
+}
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+static int phase_allow;
+static volatile unsigned phase_sink;
+
+static int phase_guard(void* ctx) {
+    (void)ctx;
+    return phase_allow;
+}
+
+static void phase_action(void* ctx) {
+    (void)ctx;
+    for (unsigned i = 0; i < 2000; i++) {
+        phase_sink += i;
+    }
+}
+
+static void phase_handler(void* ctx, flux_fsm_event_t event) {
+    (void)ctx;
+    (void)event;
+    for (unsigned i = 0; i < 1000; i++) {
+        phase_sink += i;
+    }
+}
+
+/* 测试用例：转移阶段耗时明细 */
+void test_perf_phases(void) {
+    static flux_fsm_perf_t perf;
+    flux_fsm_perf_breakdown_t start, stop;
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+
+    flux_fsm_transition_t transitions[] = {
+        {STATE_IDLE, EVENT_START, STATE_RUNNING, phase_guard, NULL},
+        {STATE_RUNNING, EVENT_STOP, STATE_IDLE, NULL, phase_action}
+    };
+    flux_fsm_add_transitions(fsm, transitions, 2);
+    flux_fsm_add_handler(fsm, STATE_RUNNING, phase_handler);
+
+    flux_fsm_perf_init(&perf);
+    flux_fsm_perf_attach(&perf);
+    for (int i = 0; i < 1000; i++) {
+        phase_allow = 0;
+        flux_fsm_process_event(fsm, EVENT_START);
+        phase_allow = 1;
+        flux_fsm_process_event(fsm, EVENT_START);
+        flux_fsm_process_event(fsm, EVENT_STOP);
+    }
+    flux_fsm_perf_detach(&perf);
+    flux_fsm_process_event(fsm, EVENT_START);
+
+    printf("%s\n", flux_fsm_perf_to_json(&perf));
+    printf("阶段明细测试: %s\n",
+           flux_fsm_perf_transition(&perf, STATE_IDLE, EVENT_START, &start) == FLUX_FSM_OK
+           && flux_fsm_perf_transition(&perf, STATE_RUNNING, EVENT_STOP, &stop) == FLUX_FSM_OK
+           && start.count == 2000 && start.guard_failures == 1000
+           && stop.count == 1000 && stop.guard_failures == 0
+           && stop.action_ns > 0 && stop.handler_ns > 0
+           && flux_fsm_get_state(fsm) == STATE_RUNNING
+           && flux_fsm_perf_transition(&perf, STATE_RUNNING, EVENT_PAUSE, &start)
+              == FLUX_FSM_INVALID_EVENT ? "通过" : "失败");
+
+    flux_fsm_destroy(fsm);
+}
+#endif
+
+/* 流式写入的收集端 */
+typedef struct {
+    char buf[32768];
+    size_t len;
+    int calls;
+} export_sink_t;
+
+static size_t export_collect(void* data, const char* buf, size_t len) {
+    export_sink_t* sink = data;
+
+    if (sink->len + len >= sizeof(sink->buf)) {
+        return 0;
+    }
+    memcpy(sink->buf + sink->len, buf, len);
+    sink->len += len;
+    sink->buf[sink->len] = '\0';
+    sink->calls++;
+    return len;
+}
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+static void* export_json_worker(void* arg) {
+    return (void*)flux_fsm_perf_to_json(arg);
+}
+
+#define SCRAPE_EVENTS 20000
+
+typedef struct {
+    flux_fsm_t* fsm;
+    atomic_int done;
+} scrape_target_t;
+
+/* 事件线程：在 RUNNING 与 PAUSED 之间往复 */
+static void* scrape_event_worker(void* arg) {
+    scrape_target_t* t = arg;
+
+    for (int i = 0; i < SCRAPE_EVENTS; i++) {
+        flux_fsm_process_event(t->fsm, i & 1 ? EVENT_RESUME : EVENT_PAUSE);
+    }
+    atomic_store(&t->done, 1);
+    return NULL;
+}
+
+static size_t export_discard(void* data, const char* buf, size_t len) {
+    (void)data;
+    (void)buf;
+    return len;
+}
+#endif
+
+/* 测试用例：无堆分配的 JSON 与 Prometheus 导出 */
+void test_perf_export(void) {
+    static flux_fsm_perf_t perf;
+    static export_sink_t sink;
+    static char full[16384];
+    char small[64];
+    char chunk[256];
+    flux_fsm_writer_t w;
+
+    flux_fsm_perf_init(&perf);
+    for (int i = 1; i <= 100; i++) {
+        flux_fsm_perf_update(&perf, (double)i / 1000.0);
+    }
+    flux_fsm_perf_record_phases(&perf, STATE_IDLE, EVENT_START, FLUX_FSM_OK, 100, 200, 300);
+    flux_fsm_perf_record_phases(&perf, STATE_IDLE, EVENT_START, FLUX_FSM_GUARD_FAIL, 100, 0, 0);
+    flux_fsm_perf_record_phases(&perf, STATE_IDLE, EVENT_STOP, FLUX_FSM_OK, 10, 20, 30);
+    flux_fsm_perf_record_phases(&perf, STATE_RUNNING, EVENT_STOP, FLUX_FSM_OK, 10, 20, 30);
+
+    /* 调用方缓冲区：返回完整长度，不足时截断 */
+    size_t need = flux_fsm_perf_format_json(&perf, full, sizeof(full));
+    size_t cut = flux_fsm_perf_format_json(&perf, small, sizeof(small));
+    printf("缓冲区导出测试: %s\n",
+           need == strlen(full) && cut == need
+           && strlen(small) == sizeof(small) - 1
+           && strncmp(small, full, sizeof(small) - 1) == 0 ? "通过" : "失败");
+
+    /* 流式写入：小缓冲区分多次输出，结果与一次性输出相同 */
+    sink.len = 0;
+    sink.calls = 0;
+    flux_fsm_writer_init(&w, chunk, sizeof(chunk), export_collect, &sink);
+    printf("流式导出测试: %s\n",
+           flux_fsm_perf_write_json(&perf, &w) == FLUX_FSM_OK
+           && sink.len == need && strcmp(sink.buf, full) == 0 && sink.calls > 1 ? "通过" : "失败");
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+    /* 兼容接口的缓冲区按线程区分 */
+    pthread_t thread;
+    void* other = NULL;
+
+    pthread_create(&thread, NULL, export_json_worker, &perf);
+    pthread_join(thread, &other);
+    printf("线程私有缓冲测试: %s\n",
+           other && other != (void*)flux_fsm_perf_to_json(&perf) ? "通过" : "失败");
+#endif
+
+    /* Prometheus 文本格式 */
+    sink.len = 0;
+    flux_fsm_writer_init(&w, chunk, sizeof(chunk), export_collect, &sink);
+    flux_fsm_rc_t rc = flux_fsm_perf_write_prometheus(&perf, &w);
+    printf("%s", sink.buf);
+    printf("Prometheus 导出测试: %s\n",
+           rc == FLUX_FSM_OK
+           && strstr(sink.buf, "# TYPE flux_fsm_transition_latency_seconds summary\n")
+           && strstr(sink.buf, "flux_fsm_transition_latency_seconds_count 103\n")
+           && strstr(sink.buf, "flux_fsm_state_transitions_total{state=\"0\"} 2\n")
+           && strstr(sink.buf, "flux_fsm_state_transitions_total{state=\"1\"} 1\n")
+           && strstr(sink.buf, "flux_fsm_transition_guard_failures_total{from=\"0\",event=\"0\"} 1\n")
+           && strstr(sink.buf, "flux_fsm_transition_phase_seconds_total{from=\"0\",event=\"0\",phase=\"action\"} 2e-07\n")
+           ? "通过" : "失败");
+
+    /* 每个状态机的当前状态 */
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+    flux_fsm_add_transition(fsm, &(flux_fsm_transition_t){STATE_IDLE, EVENT_START, STATE_RUNNING, NULL, NULL});
+    flux_fsm_process_event(fsm, EVENT_START);
+    fsm->trace_id = 42;
+    const flux_fsm_t* machines[] = { fsm };
+
+    sink.len = 0;
+    flux_fsm_writer_init(&w, chunk, sizeof(chunk), export_collect, &sink);
+    printf("状态机导出测试: %s\n",
+           flux_fsm_perf_write_machines(machines, 1, &w) == FLUX_FSM_OK
+           && strstr(sink.buf, "flux_fsm_machine_state{machine=\"42\"} 1\n") ? "通过" : "失败");
+
+    flux_fsm_destroy(fsm);
+
+#if defined(FLUX_FSM_HAVE_ATOMIC)
+    /* 采集线程在事件线程运行时导出每机指标 */
+    static scrape_target_t target;
+    target.fsm = flux_fsm_create(STATE_RUNNING, NULL);
+    flux_fsm_add_transition(target.fsm, &(flux_fsm_transition_t){STATE_RUNNING, EVENT_PAUSE, STATE_PAUSED, NULL, NULL});
+    flux_fsm_add_transition(target.fsm, &(flux_fsm_transition_t){STATE_PAUSED, EVENT_RESUME, STATE_RUNNING, NULL, NULL});
+    flux_fsm_cache_enable(target.fsm, 16);
+    atomic_init(&target.done, 0);
+    machines[0] = target.fsm;
+
+    int scrapes = 0;
+    flux_fsm_rc_t scrape_rc = FLUX_FSM_OK;
+    pthread_create(&thread, NULL, scrape_event_worker, &target);
+    while (!atomic_load(&target.done)) {
+        flux_fsm_writer_init(&w, chunk, sizeof(chunk), export_discard, NULL);
+        if (flux_fsm_perf_write_machines(machines, 1, &w) != FLUX_FSM_OK) {
+            scrape_rc = FLUX_FSM_ERROR;
+        }
+        scrapes++;
+    }
+    pthread_join(thread, NULL);
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    flux_fsm_cache_stats(target.fsm, &hits, &misses);
+    printf("并发采集测试: %s\n",
+           scrape_rc == FLUX_FSM_OK && scrapes > 0 && hits + misses == SCRAPE_EVENTS
+           && flux_fsm_get_state(target.fsm) == STATE_RUNNING ? "通过" : "失败");
+    flux_fsm_destroy(target.fsm);
+#endif
+
+    /* 明细表满后的 (from, event) 单独计数 */
+    flux_fsm_perf_reset(&perf);
+    for (int i = 0; i < FLUX_FSM_PERF_TRANSITIONS + 6; i++) {
+        flux_fsm_perf_record_phases(&perf, i, EVENT_START, FLUX_FSM_OK, 0, 0, 0);
+    }
+    sink.len = 0;
+    flux_fsm_writer_init(&w, chunk, sizeof(chunk), export_collect, &sink);
+    flux_fsm_perf_write_prometheus(&perf, &w);
+    printf("明细溢出导出测试: %s\n",
+           strstr(sink.buf, "flux_fsm_transitions_dropped_total 6\n") ? "通过" : "失败");
+
+    /* 最宽的状态与事件号，标签完整且引号闭合 */
+    flux_fsm_perf_reset(&perf);
+    flux_fsm_perf_record_phases(&perf, -2147483647 - 1, -1000000000, FLUX_FSM_OK, 0, 0, 0);
+    sink.len = 0;
+    flux_fsm_writer_init(&w, chunk, sizeof(chunk), export_collect, &sink);
+    flux_fsm_perf_write_prometheus(&perf, &w);
+    printf("宽标签导出测试: %s\n",
+           strstr(sink.buf, "flux_fsm_transition_calls_total"
+                  "{from=\"-2147483648\",event=\"-1000000000\"} 1\n") ? "通过" : "失败");
+}
+
+/* 测试用例：热点缓存计数采集 */
+void test_perf_cache(void) {
+    flux_fsm_perf_t perf;
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+
+    flux_fsm_transition_t transitions[] = {
+        {STATE_IDLE, EVENT_START, STATE_RUNNING, NULL, NULL},
+        {STATE_RUNNING, EVENT_PAUSE, STATE_PAUSED, NULL, NULL},
+        {STATE_PAUSED, EVENT_RESUME, STATE_RUNNING, NULL, NULL},
+        {STATE_RUNNING, EVENT_STOP, STATE_IDLE, NULL, NULL}
+    };
+    flux_fsm_add_transitions(fsm, transitions, sizeof(transitions) / sizeof(transitions[0]));
+    flux_fsm_cache_enable(fsm, 0);
+
+    /* 偏斜的事件分布：大部分时间在运行与暂停之间切换 */
+    flux_fsm_process_event(fsm, EVENT_START);
+    for (int i = 0; i < 100; i++) {
+        flux_fsm_process_event(fsm, EVENT_PAUSE);
+        flux_fsm_process_event(fsm, EVENT_RESUME);
+    }
+    flux_fsm_process_event(fsm, EVENT_STOP);
+
+    flux_fsm_perf_init(&perf);
+    flux_fsm_perf_collect(&perf, fsm);
+    printf("Cache Hits: %lu, Misses: %lu\n", perf.cache_hits, perf.cache_misses);
+    printf("%s\n", flux_fsm_perf_to_json(&perf));
+
+    flux_fsm_destroy(fsm);
+}
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+/* 测试用例：核心线程计数器采集 */
+void test_perf_counters(void) {
+    flux_fsm_perf_t perf;
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+
+    flux_fsm_transition_t transitions[] = {
+        {STATE_IDLE, EVENT_START, STATE_RUNNING, NULL, NULL},
+        {STATE_RUNNING, EVENT_STOP, STATE_IDLE, NULL, NULL}
+    };
+    flux_fsm_add_transitions(fsm, transitions, 2);
+
+    flux_fsm_counters_enable(1);
+    flux_fsm_counters_reset();
+    for (int i = 0; i < 500; i++) {
+        flux_fsm_process_event(fsm, EVENT_START);
+        flux_fsm_process_event(fsm, EVENT_STOP);
+    }
+    flux_fsm_process_event(fsm, EVENT_PAUSE);
+    flux_fsm_counters_enable(0);
+
+    flux_fsm_perf_init(&perf);
+    flux_fsm_perf_collect_counters(&perf);
+    printf("%s\n", flux_fsm_perf_to_json(&perf));
+    printf("计数采集测试: %s\n",
+           perf.events == 1001 && perf.transitions == 1000 && perf.invalid_events == 1
+           && perf.avg_transition_time > 0.0 ? "通过" : "失败");
+
+    flux_fsm_destroy(fsm);
+}
+#endif
+
 /* 测试用例：状态图可视化 */
 void test_visualization(void) {
     flux_fsm_t fsm;
@@ -82,8 +471,46 @@ void test_visualization(void) {
     const char* dot_content = flux_fsm_viz_generate(&fsm, &viz_config);
     printf("Generated DOT Content:\n%s\n", dot_content);
     
-    /* 导出为SVG文件 */
-    flux_fsm_viz_export(&fsm, "test_fsm.svg");
+    /* 导出到临时目录，检查后删除，不在工作目录留下文件 */
+    char path[256];
+    const char* dir = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/test_fsm.svg", dir && *dir ? dir : "/tmp");
+    printf("可视化导出测试: %s\n", flux_fsm_viz_export(&fsm, path) == 0 ? "通过" : "失败");
+    remove(path);
+}
+
+/* 测试用例：剖析热力图 */
+void test_visualization_heatmap(void) {
+    flux_fsm_viz_config_t viz_config;
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+
+    flux_fsm_transition_t transitions[] = {
+        {STATE_IDLE, EVENT_START, STATE_RUNNING, NULL, NULL},
+        {STATE_RUNNING, EVENT_PAUSE, STATE_PAUSED, NULL, NULL},
+        {STATE_PAUSED, EVENT_RESUME, STATE_RUNNING, NULL, NULL},
+        {STATE_RUNNING, EVENT_STOP, STATE_STOPPED, NULL, NULL}
+    };
+    flux_fsm_add_transitions(fsm, transitions, 4);
+    flux_fsm_profile_enable(fsm);
+
+    flux_fsm_process_event(fsm, EVENT_START);
+    for (int i = 0; i < 9; i++) {
+        flux_fsm_process_event(fsm, EVENT_PAUSE);
+        flux_fsm_process_event(fsm, EVENT_RESUME);
+    }
+    flux_fsm_process_event(fsm, EVENT_STOP);
+
+    flux_fsm_viz_init(&viz_config);
+    viz_config.heatmap = 1;
+    char* dot = flux_fsm_viz_generate(fsm, &viz_config);
+    printf("%s", dot ? dot : "");
+    printf("热力图测试: %s\n",
+           dot && strstr(dot, "1 -> 2 [label=\"9\", penwidth=5.0, color=\"0.000 1.000 1.000\"]")
+           && strstr(dot, "0 -> 1 [label=\"1\"")
+           && strstr(dot, "3 [label=\"3\\n") ? "通过" : "失败");
+
+    flux_fsm_viz_free(dot);
+    flux_fsm_destroy(fsm);
 }
 
 /* 测试用例：状态机验证 */
@@ -103,6 +530,161 @@ void test_validation(void) {
     printf("有效状态机测试: %s\n", result.error_code ? "失败" : "通过");
 }
 
+/* 代码生成用的回调 */
+static int codegen_guard(void* ctx) {
+    (void)ctx;
+    return 1;
+}
+
+static void codegen_action(void* ctx) {
+    (void)ctx;
+}
+
+/* 测试用例：switch 分派代码生成 */
+void test_codegen(void) {
+    static const flux_fsm_symbol_t symbols[] = {
+        {"codegen_guard", codegen_guard, NULL, NULL},
+        {"codegen_action", NULL, codegen_action, NULL},
+    };
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+
+    flux_fsm_transition_t transitions[] = {
+        {STATE_IDLE, EVENT_START, STATE_RUNNING, codegen_guard, codegen_action},
+        {STATE_RUNNING, EVENT_PAUSE, STATE_PAUSED, NULL, NULL},
+        {STATE_RUNNING, EVENT_PAUSE, STATE_STOPPED, NULL, NULL},
+        {STATE_PAUSED, EVENT_RESUME, STATE_RUNNING, NULL, codegen_action}
+    };
+    flux_fsm_add_transitions(fsm, transitions, sizeof(transitions) / sizeof(transitions[0]));
+
+    /* 由状态机与符号表生成 */
+    flux_fsm_codegen_t* gen = flux_fsm_codegen_from_fsm(fsm, symbols, 2);
+    char* source = flux_fsm_codegen_generate(gen, "door");
+    printf("Generated Dispatch:\n%s\n", source ? source : "(null)");
+    printf("直接调用守卫测试: %s\n",
+           source && strstr(source, "if (!codegen_guard(ctx))") ? "通过" : "失败");
+    printf("重复转移裁剪测试: %s\n",
+           source && !strstr(source, "*state = 3;") ? "通过" : "失败");
+    flux_fsm_codegen_free(source);
+    flux_fsm_codegen_destroy(gen);
+
+    /* 未登记的回调无法生成 */
+    gen = flux_fsm_codegen_from_fsm(fsm, symbols, 1);
+    printf("未登记符号测试: %s\n", gen ? "失败" : "通过");
+    flux_fsm_codegen_destroy(gen);
+    flux_fsm_destroy(fsm);
+
+    /* 定义文本解析与实例化 */
+    size_t line = 0;
+    gen = flux_fsm_codegen_parse("initial 0\n"
+                                 "transition 0 0 1 codegen_guard codegen_action # 启动\n"
+                                 "transition 1 3 0\n", &line);
+    fsm = flux_fsm_codegen_instantiate(gen, symbols, 2, NULL);
+    int ok = fsm && flux_fsm_process_event(fsm, EVENT_START) == FLUX_FSM_OK
+             && flux_fsm_get_state(fsm) == STATE_RUNNING;
+    printf("定义文件实例化测试: %s\n", ok ? "通过" : "失败");
+    flux_fsm_destroy(fsm);
+    flux_fsm_codegen_destroy(gen);
+
+    gen = flux_fsm_codegen_parse("initial 0\ntransition 0 x 1\n", &line);
+    printf("语法错误行号测试: %s\n", !gen && line == 2 ? "通过" : "失败");
+
+    /* 同一名称在同一角色中只声明一次，跨角色签名冲突时拒绝生成 */
+    gen = flux_fsm_codegen_parse("initial 0\n"
+                                 "transition 0 0 1 check -\n"
+                                 "transition 1 0 0 check -\n"
+                                 "handler 1 on_enter\n"
+                                 "handler 0 on_enter\n", &line);
+    source = flux_fsm_codegen_generate(gen, "dup");
+    ok = source && strstr(source, "int check(void* ctx);")
+         && !strstr(strstr(source, "int check(void* ctx);") + 1, "int check(void* ctx);")
+         && strstr(source, "void on_enter(void* ctx, flux_fsm_event_t event);");
+    flux_fsm_codegen_free(source);
+    flux_fsm_codegen_destroy(gen);
+
+    gen = flux_fsm_codegen_parse("initial 0\n"
+                                 "transition 0 0 1 check -\n"
+                                 "handler 1 check\n", &line);
+    source = flux_fsm_codegen_generate(gen, "clash");
+    printf("回调角色冲突测试: %s\n", ok && gen && !source ? "通过" : "失败");
+    flux_fsm_codegen_free(source);
+    flux_fsm_codegen_destroy(gen);
+}
+
+#if defined(FLUX_FSM_HAVE_TRACE)
+/* 测试用例：二进制转移追踪与解码 */
+void test_trace(void) {
+    char path[256];
+    snprintf(path, sizeof(path), "test_trace.%ld.0.trace", (long)getpid());
+    const char* files[] = {path};
+
+    flux_fsm_t* fsm = flux_fsm_create(STATE_IDLE, NULL);
+    flux_fsm_transition_t transitions[] = {
+        {STATE_IDLE, EVENT_START, STATE_RUNNING, NULL, NULL},
+        {STATE_RUNNING, EVENT_STOP, STATE_IDLE, NULL, NULL},
+    };
+    flux_fsm_add_transitions(fsm, transitions, 2);
+    fsm->trace_id = 7;
+
+    /* 追踪关闭时不产生记录 */
+    flux_fsm_process_event(fsm, EVENT_START);
+    flux_fsm_process_event(fsm, EVENT_STOP);
+
+    int ok = flux_fsm_trace_start("test_trace", 64) == FLUX_FSM_OK && flux_fsm_trace_enabled();
+    flux_fsm_process_event(fsm, EVENT_START);
+    flux_fsm_process_event(fsm, EVENT_PAUSE);   /* 无匹配转移，不记录 */
+    flux_fsm_process_event(fsm, EVENT_STOP);
+    flux_fsm_trace_stop();
+    flux_fsm_process_event(fsm, EVENT_START);
+    printf("追踪开启测试: %s\n", ok ? "通过" : "失败");
+
+    FILE* out = tmpfile();
+    char text[1024] = {0};
+    ok = out && flux_fsm_trace_decode(files, 1, FLUX_FSM_TRACE_TEXT, out) == FLUX_FSM_OK;
+    if (ok) {
+        rewind(out);
+        size_t len = fread(text, 1, sizeof(text) - 1, out);
+        text[len] = '\0';
+    }
+    printf("Decoded Trace:\n%s", text);
+    printf("文本解码测试: %s\n",
+           ok && strstr(text, "machine=7 0 --0--> 1 OK")
+              && strstr(text, "machine=7 1 --3--> 0 OK")
+              && !strstr(text, "--1-->") ? "通过" : "失败");
+    if (out) {
+        fclose(out);
+    }
+
+    /* 回绕：容量 8，保留最近 7 条 */
+    flux_fsm_trace_start("test_trace", 8);
+    for (int i = 0; i < 20; i++) {
+        flux_fsm_process_event(fsm, i % 2 ? EVENT_START : EVENT_STOP);
+    }
+    flux_fsm_trace_stop();
+
+    out = tmpfile();
+    ok = out && flux_fsm_trace_decode(files, 1, FLUX_FSM_TRACE_JSON, out) == FLUX_FSM_OK;
+    int records = 0;
+    if (ok) {
+        rewind(out);
+        char line[256];
+        while (fgets(line, sizeof(line), out)) {
+            records += strstr(line, "\"machine\": 7") != NULL;
+        }
+        fclose(out);
+    }
+    printf("JSON 解码与回绕测试: %s\n", ok && records == 7 ? "通过" : "失败");
+    remove(path);
+
+    /* 格式不符的文件 */
+    const char* bogus[] = {"test_perf.c.missing"};
+    printf("无效文件测试: %s\n",
+           flux_fsm_trace_decode(bogus, 1, FLUX_FSM_TRACE_TEXT, stdout) == FLUX_FSM_ERROR
+           ? "通过" : "失败");
+
+    flux_fsm_destroy(fsm);
+}
+#endif
+
 int main(void) {
     /* 初始化随机数生成器 */
     srand((unsigned int)time(NULL));
@@ -111,11 +693,39 @@ int main(void) {
     printf("\n=== Testing Performance Statistics ===\n");
     test_perf_stats();
 
+    printf("\n=== Testing Latency Histogram ===\n");
+    test_perf_histogram();
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+    printf("\n=== Testing Transition Phases ===\n");
+    test_perf_phases();
+#endif
+
+    printf("\n=== Testing Metrics Export ===\n");
+    test_perf_export();
+
+    printf("\n=== Testing Cache Statistics ===\n");
+    test_perf_cache();
+
+#if defined(FLUX_FSM_HAVE_COUNTERS)
+    printf("\n=== Testing Core Counters ===\n");
+    test_perf_counters();
+#endif
+
     printf("\n=== Testing FSM Visualization ===\n");
     test_visualization();
+    test_visualization_heatmap();
 
     printf("\n=== Testing FSM Validation ===\n");
     test_validation();
 
+    printf("\n=== Testing Code Generation ===\n");
+    test_codegen();
+
+#if defined(FLUX_FSM_HAVE_TRACE)
+    printf("\n=== Testing Transition Trace ===\n");
+    test_trace();
+#endif
+
     return 0;
 }